@@ -46,14 +46,19 @@
 /******************************************************************************
 * INCLUDES
 */
+#include <string.h>
 #include "hal_int.h"
 #include "hal_rf.h"
+#include "hal_timer_32k.h"
 #include "basic_rf.h"
-#ifdef __ICCARM__
-#include "sys_ctrl.h"
-#else
-#include "hal_mcu.h"
+#include "basic_rf_nbr.h"
+#include "basic_rf_tpc.h"
+#ifdef SECURITY_CCM
+#include "basic_rf_sec.h"
 #endif
+#include "basic_rf_scan.h"
+#include "basic_rf_frame.h"
+#include "basic_rf_rxq.h"
 
 /******************************************************************************
 * CONSTANTS AND DEFINES
@@ -64,525 +69,2230 @@
 #define PKT_LEN_AUTH                        8
 #define PKT_LEN_ENCR                        24
 
-// Packet overhead ((frame control field, sequence number, PAN ID,
-// destination and source) + (footer))
+// Packet overhead with short addresses ((frame control field, sequence
+// number, PAN ID, destination and source) + (footer))
 // Note that the length byte itself is not included included in the packet length
 #define BASIC_RF_PACKET_OVERHEAD_SIZE       ((2 + 1 + 2 + 2 + 2) + (2))
-#define BASIC_RF_MAX_PAYLOAD_SIZE	        (127 - BASIC_RF_PACKET_OVERHEAD_SIZE - \
-    BASIC_RF_AUX_HDR_LENGTH - BASIC_RF_LEN_MIC)
 #define BASIC_RF_ACK_PACKET_SIZE	        5
 #define BASIC_RF_FOOTER_SIZE                2
 #define BASIC_RF_HDR_SIZE                   10
 
-// The time it takes for the acknowledgment packet to be received after the
-// data packet has been transmitted.
-#define BASIC_RF_ACK_WAIT                   800   // milliseconds
+// Header growth for each extended instead of short address
+#define BASIC_RF_EXT_ADDR_EXTRA             (BASIC_RF_EXT_ADDR_SIZE - 2)
+
+// The time to wait for the acknowledgment packet after the data packet has
+// been transmitted (IEEE 802.15.4 macAckWaitDuration): aUnitBackoffPeriod +
+// aTurnaroundTime + phySHRDuration + 6 * phySymbolsPerOctet = 54 symbols
+#define BASIC_RF_ACK_WAIT_SYMBOLS           (HAL_RF_BACKOFF_PERIOD + 12 + 10 + 6*2)
 
 // The length byte
 #define BASIC_RF_PLD_LEN_MASK               0x7F
 
 // Frame control field
-#define BASIC_RF_FCF_NOACK                  0x8841
-#define BASIC_RF_FCF_ACK                    0x8861
-#define BASIC_RF_FCF_ACK_BM                 0x0020
-#define BASIC_RF_FCF_BM                     (~BASIC_RF_FCF_ACK_BM)
+#define BASIC_RF_FCF_TYPE_BM                0x0007
+#define BASIC_RF_FCF_TYPE_DATA              0x0001
+#define BASIC_RF_FCF_TYPE_CMD               0x0003
 #define BASIC_RF_SEC_ENABLED_FCF_BM         0x0008
-
-// Frame control field LSB
-#define BASIC_RF_FCF_NOACK_L                LO_UINT16(BASIC_RF_FCF_NOACK)
-#define BASIC_RF_FCF_ACK_L                  LO_UINT16(BASIC_RF_FCF_ACK)
-#define BASIC_RF_FCF_ACK_BM_L               LO_UINT16(BASIC_RF_FCF_ACK_BM)
-#define BASIC_RF_FCF_BM_L                   LO_UINT16(BASIC_RF_FCF_BM)
-#define BASIC_RF_SEC_ENABLED_FCF_BM_L       LO_UINT16(BASIC_RF_SEC_ENABLED_FCF_BM)
-
-// Auxiliary Security header
+#define BASIC_RF_FCF_PENDING_BM             0x0010
+#define BASIC_RF_FCF_ACK_BM                 0x0020
+#define BASIC_RF_FCF_PANID_COMP_BM          0x0040
+#define BASIC_RF_FCF_DST_MODE_S             10
+#define BASIC_RF_FCF_SRC_MODE_S             14
+
+// Destination addressing mode in the high byte of the frame control field
+#define BASIC_RF_FCF_DST_SHORT_HI           HI_UINT16((uint16)BASIC_RF_ADDR_MODE_SHORT << \
+                                                      BASIC_RF_FCF_DST_MODE_S)
+#define BASIC_RF_FCF_DST_EXT_HI             HI_UINT16((uint16)BASIC_RF_ADDR_MODE_EXT << \
+                                                      BASIC_RF_FCF_DST_MODE_S)
+
+// Addressing modes
+#define BASIC_RF_ADDR_MODE_NONE             0
+#define BASIC_RF_ADDR_MODE_SHORT            2
+#define BASIC_RF_ADDR_MODE_EXT              3
+
+// MAC command frame identifiers
+#define BASIC_RF_CMD_DATA_REQUEST           0x04
+
+// Low power listening, in symbol periods. A channel check must be longer
+// than the gap between two strobed frames (ACK wait and CCA), and the
+// receiver must listen long enough to catch a whole frame after activity.
+#define BASIC_RF_LPL_CHECK_SYMBOLS          80
+#define BASIC_RF_LPL_LISTEN_SYMBOLS         800
+#define BASIC_RF_LPL_ACK_SYMBOLS            40
+
+// One 32 kHz period is 15625/8192 symbol periods
+#define BASIC_RF_TICKS_TO_SYMBOLS(ticks)    (((uint32)(ticks) * 15625) >> 13)
+
+// Time to wait for the frame after an acknowledgment with the frame pending
+// bit set (802.15.4 macMaxFrameTotalWaitTime), in symbols
+#define BASIC_RF_POLL_WAIT_SYMBOLS          1220
+
+// Auxiliary Security header: security control (security level, key
+// identifier mode 0) and frame counter
 #define BASIC_RF_AUX_HDR_LENGTH             5
-#define BASIC_RF_LEN_AUTH                   BASIC_RF_PACKET_OVERHEAD_SIZE + \
-    BASIC_RF_AUX_HDR_LENGTH - BASIC_RF_FOOTER_SIZE
-#define BASIC_RF_SECURITY_M                 2
 #define BASIC_RF_LEN_MIC                    8
 #ifdef SECURITY_CCM
 #undef BASIC_RF_HDR_SIZE
 #define BASIC_RF_HDR_SIZE                   15
+#define SECURITY_CONTROL                    BASIC_RF_SEC_LEVEL
+#if (BASIC_RF_SEC_LEVEL != BASIC_RF_SEC_LEVEL_MIC_64) && \
+    (BASIC_RF_SEC_LEVEL != BASIC_RF_SEC_LEVEL_ENC_MIC_64)
+#error "BASIC_RF_SEC_LEVEL must have an 8 byte MIC"
+#endif
+#endif
+
+// The frame codec marks extended addresses the same way
+#if BASIC_RF_ADDR_USE_EXT != BASIC_RF_FRAME_NO_SHORT_ADDR
+#error "BASIC_RF_ADDR_USE_EXT does not match the frame codec"
+#endif
+
+// Header with extended source and destination addresses
+#define BASIC_RF_MAX_HDR_SIZE               (BASIC_RF_HDR_SIZE + \
+                                             2 * BASIC_RF_EXT_ADDR_EXTRA)
+
+// BASIC_RF_MAX_PAYLOAD_SIZE is defined in basic_rf.h
+#if BASIC_RF_MAX_PAYLOAD_SIZE != (127 - BASIC_RF_PACKET_OVERHEAD_SIZE - \
+    BASIC_RF_AUX_HDR_LENGTH - BASIC_RF_LEN_MIC)
+#error "BASIC_RF_MAX_PAYLOAD_SIZE does not match the frame format"
+#endif
+
+#ifdef BASIC_RF_HDR_BENCHMARK
+// Benchmark headers per measurement and CPU cycles (32 MHz) per MAC timer
+// symbol
+#define HDR_BENCH_ROUNDS                    256
+#define HDR_BENCH_CYCLES_PER_SYMBOL         512
+#endif
+
+#ifdef BASIC_RF_TX_BENCHMARK
+// Benchmark packets per measurement and microseconds per MAC timer symbol
+#define TX_BENCH_PACKETS                    200
+#define TX_BENCH_US_PER_SYMBOL              16
 #endif
 
 // Footer
 #define BASIC_RF_CRC_OK_BM                  0x80
+#define BASIC_RF_CORR_BM                    0x7F
+
+// Asynchronous TX states
+#define TX_STATE_IDLE                       0
+#define TX_STATE_BACKOFF                    1   // CSMA-CA random backoff
+#define TX_STATE_TX                         2   // Waiting for TX done
+#define TX_STATE_WAIT_ACK                   3   // Waiting for acknowledgment
+
+// TX queue
+#define TX_QUEUE_NONE                       0xFF
+
+// TX queue entry flags
+#define TX_FLAG_CMD                         0x01    // MAC command frame
+#define TX_FLAG_PENDING                     0x02    // Set frame pending bit
+#define TX_FLAG_ONCE                        0x04    // One CCA, no backoff and
+                                                    // no retransmission
+
+// Indirect transmission
+#define INDIRECT_SLOT_FREE                  0xFFFF
+#define INDIRECT_SLOT_NONE                  0xFF
+#if (BASIC_RF_INDIRECT_CHILDREN < 1) || \
+    (BASIC_RF_INDIRECT_CHILDREN > HAL_RF_SRC_MATCH_SHORT_ENTRIES)
+#error "BASIC_RF_INDIRECT_CHILDREN must be in the range 1-24"
+#endif
+#if (BASIC_RF_TX_QUEUE_SIZE < 1) || (BASIC_RF_TX_QUEUE_SIZE > 254)
+#error "BASIC_RF_TX_QUEUE_SIZE must be in the range 1-254"
+#endif
 
 /******************************************************************************
 * TYPEDEFS
 */
-// The receive struct
+// Rx state. Received frames are queued in basic_rf_rxq.c.
 typedef struct
 {
-  uint8 seqNumber;
-  uint16 srcAddr;
-  uint16 srcPanId;
-  int8 length;
-  uint8* pPayload;
-  uint8 ackRequest;
-  int8 rssi;
-  volatile uint8 isReady;
-  uint8 status;
-} basicRfRxInfo_t;
+  int8 rssi;                // RSSI of the last received data frame, dBm
+  uint16 pollAddr;              // Parent polled by basicRfPoll()
+  volatile uint8 pollPending;   // Written by basicRfPoll() only
+  volatile uint8 pollReceived;  // Set by the RX ISR on a frame from pollAddr
+  uint8 pollMore;               // Frame pending bit of that frame
+  volatile uint8 rxCount;       // Data frames read by the RX ISR
+} basicRfRxState_t;
+
+// An entry in the transmit queue
+typedef struct
+{
+  uint16 destAddr;              // BASIC_RF_ADDR_USE_EXT for \e destExtAddr
+  uint16 groupAddr;             // Group of a broadcast packet
+  uint8 destExtAddr[BASIC_RF_EXT_ADDR_SIZE];
+  uint8 nSegs;
+  uint8 flags;                  // TX_FLAG_*
+  uint8 next;                   // Next entry in list, TX_QUEUE_NONE if last
+  uint32 timestamp;             // MAC timer when queued, indirect frames only
+  const basicRfTxSeg_t* pSegs;  // Payload segments, \e seg or caller memory
+  basicRfTxSeg_t seg;           // Segment describing \e payload
+  basicRfTxDoneCb_t pfTxDone;
+  uint8 payload[BASIC_RF_MAX_PAYLOAD_SIZE];
+} basicRfTxEntry_t;
+
+// Singly linked list of transmit queue entries
+typedef struct
+{
+  uint8 head;
+  uint8 tail;
+} basicRfTxList_t;
+
+// Frames held for a sleeping child until it polls. The table index is also
+// the child's entry in the radio's source address matching table.
+typedef struct
+{
+  uint16 addr;                  // Child short address, INDIRECT_SLOT_FREE
+  basicRfTxList_t list;
+} basicRfIndirectSlot_t;
 
 // Tx state
 typedef struct
 {
-  uint8 txSeqNumber;
+  uint8 txSeqNumber;            // Sequence number of the frame in the TX FIFO
   volatile uint8 ackReceived;
+  uint8 ackRequest;             // The frame in the TX FIFO requests an ACK
+  uint8 ackPending;             // Frame pending bit of the received ACK
   uint8 receiveOn;
   uint32 frameCounter;
+  volatile uint8 state;         // Asynchronous TX state, TX_STATE_*
+  uint8 current;                // Queue entry in the TX FIFO
+  uint8 retries;                // Retransmissions of the current frame
+  uint8 nb;                     // CSMA-CA number of backoffs
+  uint8 be;                     // CSMA-CA backoff exponent
+  volatile uint8 syncDone;      // Set when the basicRfSendPacket() frame is done
+  uint8 syncResult;             // Result of the basicRfSendPacket() frame
+  uint8 syncRetries;            // Retransmissions of the basicRfSendPacket() frame
+  uint8 syncPending;            // Frame pending bit of its ACK
+  uint32 strobeStart;           // MAC timer when the current frame was loaded
 } basicRfTxState_t;
 
-
-// Basic RF packet header (IEEE 802.15.4)
-#if defined __ICC430__
-#pragma pack(1)
-#endif
+// Low power listening and radio on-time accounting. Times are sleep timer
+// (32 kHz) values.
 typedef struct
 {
-  uint8   packetLength;
-  uint8   fcf0;           // Frame control field LSB
-  uint8   fcf1;           // Frame control field MSB
-  uint8   seqNumber;
-  uint16  panId;
-  uint16  destAddr;
-  uint16  srcAddr;
-#ifdef SECURITY_CCM
-  uint8   securityControl;
-  uint8  frameCounter[4];
-#endif
-} basicRfPktHdr_t;
-#if defined __ICC430__
-#pragma pack()
-#endif
+  uint8 radioOn;
+  uint32 onSince;               // When the radio was last turned on
+  uint32 onTicks;               // Radio on time before onSince
+  uint32 statsStart;            // When the statistics were last reset
+  uint32 lastCheck;             // Last channel check
+  uint32 channelChecks;
+  uint32 channelBusy;
+  uint32 txStrobes;
+} basicRfLplState_t;
+
+// LNA gain switching, indexed by HAL_RF_GAIN_*. Times are MAC timer values.
+typedef struct
+{
+  uint8 quietFrames;            // Frames in a row below the HGM threshold
+  uint32 lastStrong;            // Last frame at or above the HGM threshold
+  uint32 toLowGain;
+  uint32 toHighGain;
+  uint32 rxFrames[2];
+  uint32 rxErrors[2];
+  uint32 rxLost[2];
+} basicRfAgcState_t;
+
+
+// Header fields that only change with the configuration, serialised in
+// frame order by basicRfHdrRefresh(). Only the frame type, frame pending and
+// ACK request bits, the sequence number and the destination address are
+// filled in per frame.
+typedef struct
+{
+  uint8 fcf[2];                 // PAN ID compression, source mode, security
+  uint8 panId[2];
+  uint8 tail[BASIC_RF_EXT_ADDR_SIZE + 1];  // Source address, security control
+  uint8 tailLength;
+} basicRfHdrTemplate_t;
 
 
 /******************************************************************************
 * LOCAL VARIABLES
 */
-static basicRfRxInfo_t  rxi=      { 0xFF }; // Make sure sequence numbers are
-static basicRfTxState_t txState=  { 0x00 }; // initialised and distinct.
+static basicRfRxState_t rxState;
+static basicRfTxState_t txState;
+static basicRfLplState_t lplState;
+static basicRfAgcState_t agcState;
+static basicRfHdrTemplate_t hdrTemplate;
 
 static basicRfCfg_t* pConfig;
-static uint8 txMpdu[BASIC_RF_MAX_PAYLOAD_SIZE+BASIC_RF_PACKET_OVERHEAD_SIZE+1];
-static uint8 rxMpdu[128];
+#ifdef SECURITY_CCM
+// Frames are encrypted in place, so they must be staged in RAM
+static uint8 txMpdu[128];
+#endif
+static basicRfTxEntry_t txQueue[BASIC_RF_TX_QUEUE_SIZE];
+static basicRfTxList_t txPrioList[BASIC_RF_TX_PRIO_LEVELS];
+static basicRfTxList_t txFreeList;
+static uint8 rxDiscardMpdu[128];            // Used when the RX pool is empty
+static basicRfStats_t stats;
+static uint16 groupTable[BASIC_RF_GROUP_TABLE_SIZE];    // Free if broadcast
+static basicRfIndirectSlot_t indirectTable[BASIC_RF_INDIRECT_CHILDREN];
+#ifdef BASIC_RF_TX_BENCHMARK
+static volatile uint16 txBenchDone;         // Benchmark packets completed
+static uint16 txBenchFailed;                // Of which not sent
+#endif
 
 /******************************************************************************
 * GLOBAL VARIABLES
 */
 
 
+/******************************************************************************
+* FUNCTION PROTOTYPES
+*/
+static void basicRfCsmaBackoff(void);
+static void basicRfCsmaStart(void);
+static void basicRfTxStart(void);
+static void basicRfSyncTxDone(uint8 seqNumber, uint8 result, uint8 retries);
+
+
 /******************************************************************************
 * LOCAL FUNCTIONS
 */
 /**************************************************************************//**
-* @brief    Builds packet header according to IEEE 802.15.4 frame format
-*
-* @param    buffer          Pointer to buffer to write the header
-* @param    destAddr        Destination short address
-* @param    payloadLength   Length of higher layer payload
+* @brief    Turns on the receiver and starts counting radio on time. Must be
+*           called with interrupts disabled.
 *
-* @return   Returns  length of header
+* @return   None
 ******************************************************************************/
-static uint8 basicRfBuildHeader(uint8* buffer, uint16 destAddr, uint8 payloadLength)
+static void basicRfRadioOn(void)
 {
-  basicRfPktHdr_t *pHdr;
-  uint16 fcf;
-
-  pHdr= (basicRfPktHdr_t*)buffer;
-
-  // Populate packet header
-  pHdr->packetLength = payloadLength + BASIC_RF_PACKET_OVERHEAD_SIZE;
-  fcf= pConfig->ackRequest ? BASIC_RF_FCF_ACK : BASIC_RF_FCF_NOACK;
-  pHdr->fcf0 = LO_UINT16(fcf);
-  pHdr->fcf1 = HI_UINT16(fcf);
-  pHdr->seqNumber= txState.txSeqNumber;
-  pHdr->panId= pConfig->panId;
-  pHdr->destAddr= destAddr;
-  pHdr->srcAddr= pConfig->myAddr;
-
-#ifdef SECURITY_CCM
+  halRfReceiveOn();
+  if (!lplState.radioOn) {
+    lplState.radioOn = TRUE;
+    lplState.onSince = halTimer32kReadTimerValue();
+  }
+}
 
-  // Add security to FCF, length and security header
-  pHdr->fcf0 |= BASIC_RF_SEC_ENABLED_FCF_BM_L;
-  pHdr->packetLength += PKT_LEN_MIC;
-  pHdr->packetLength += BASIC_RF_AUX_HDR_LENGTH;
 
-  pHdr->securityControl= SECURITY_CONTROL;
-  pHdr->frameCounter[0]=   LO_UINT16(LO_UINT32(txState.frameCounter));
-  pHdr->frameCounter[1]=   HI_UINT16(LO_UINT32(txState.frameCounter));
-  pHdr->frameCounter[2]=   LO_UINT16(HI_UINT32(txState.frameCounter));
-  pHdr->frameCounter[3]=   HI_UINT16(HI_UINT32(txState.frameCounter));
+/**************************************************************************//**
+* @brief    Turns off the receiver and stops counting radio on time. Must be
+*           called with interrupts disabled.
+*
+* @return   None
+******************************************************************************/
+static void basicRfRadioOff(void)
+{
+  halRfReceiveOff();
+  if (lplState.radioOn) {
+    lplState.radioOn = FALSE;
+    lplState.onTicks += halTimer32kReadTimerValue() - lplState.onSince;
+  }
+}
 
-#endif
 
-  // Make sure bytefields are network byte order
-  UINT16_HTON(pHdr->panId);
-  UINT16_HTON(pHdr->destAddr);
-  UINT16_HTON(pHdr->srcAddr);
+/**************************************************************************//**
+* @brief    Checks if the frame in the TX FIFO should be repeated because
+*           receivers using low power listening may not have checked the
+*           channel yet. Frames are repeated for one wake interval and one
+*           channel check from when they were loaded.
+*
+* @return   uint8 - TRUE if the frame should be sent again
+******************************************************************************/
+static uint8 basicRfTxStrobing(void)
+{
+  uint32 window;
 
-  return BASIC_RF_HDR_SIZE;
+  if (pConfig->wakeInterval == 0) {
+    return FALSE;
+  }
+  window = BASIC_RF_TICKS_TO_SYMBOLS(pConfig->wakeInterval) +
+           BASIC_RF_LPL_CHECK_SYMBOLS;
+  return ((halRfMacTimerGet() - txState.strobeStart) & HAL_RF_MAC_TIMER_MASK) < window;
 }
 
 
 /**************************************************************************//**
-* @brief    Builds mpdu (MAC header + payload) according to IEEE 802.15.4
-*           frame format
+* @brief    Switches the LNA gain. The RSSI offset changes with the gain, so
+*           the neighbour RSSI averages taken in the other mode stay valid.
 *
-* @param    destAddr        Destination short address
-* @param    pPayload        Pointer to buffer with payload
-* @param    payloadLength   Length of payload buffer
+* @param    gain            HAL_RF_GAIN_*
 *
-* @return   Returns length of mpdu
+* @return   None
 ******************************************************************************/
-static uint8 basicRfBuildMpdu(uint16 destAddr, uint8* pPayload, uint8 payloadLength)
+static void basicRfAgcSwitch(uint8 gain)
 {
-  uint8 hdrLength, n;
-
-  hdrLength = basicRfBuildHeader(txMpdu, destAddr, payloadLength);
-
-  for(n=0;n<payloadLength;n++)
-  {
-    txMpdu[hdrLength+n] = pPayload[n];
+  halRfSetGain(gain);
+  agcState.quietFrames = 0;
+  agcState.lastStrong = halRfMacTimerGet();
+  if (gain == HAL_RF_GAIN_LOW) {
+    agcState.toLowGain++;
+  } else {
+    agcState.toHighGain++;
   }
-
-  return hdrLength + payloadLength; // total mpdu length
 }
 
 
 /**************************************************************************//**
-* @brief    Interrupt service routine for received frame from radio
-*           (either data or acknowlegdement)
+* @brief    Returns to high gain if no strong frame has been received for
+*           BASIC_RF_AGC_LGM_TIMEOUT, so that a weak sender that has nothing
+*           to send in between is not lost to low gain.
 *
-*           rxi         File scope variable info extracted from the last
-*                       incoming frame.
-*           txState     File scope variable that keeps tx state info
+* @param    now             MAC timer
 *
 * @return   None
 ******************************************************************************/
-static void basicRfRxFrmDoneIsr(void)
+static void basicRfAgcCheckTimeout(uint32 now)
 {
-  basicRfPktHdr_t *pHdr;
-  uint8 *pStatusWord;
-#ifdef SECURITY_CCM
-  uint8 authStatus=0;
-#endif
-
-  // Map header to packet buffer
-  pHdr= (basicRfPktHdr_t*)rxMpdu;
-
-  // Clear interrupt and disable new RX frame done interrupt
-  halRfDisableRxInterrupt();
-
-  // Enable all other interrupt sources (enables interrupt nesting)
-  halIntOn();
-
-  // Read payload length.
-  halRfReadRxBuf(&pHdr->packetLength,1);
-  pHdr->packetLength &= BASIC_RF_PLD_LEN_MASK; // Ignore MSB
-
-  // Is this an acknowledgment packet?
-  // Only ack packets may be 5 bytes in total.
-  if (pHdr->packetLength == BASIC_RF_ACK_PACKET_SIZE) {
-
-    // Read the packet
-    halRfReadRxBuf(&rxMpdu[1], pHdr->packetLength);
+  if (pConfig->lnaAgc && halRfGetGain() == HAL_RF_GAIN_LOW &&
+      ((now - agcState.lastStrong) & HAL_RF_MAC_TIMER_MASK) >= BASIC_RF_AGC_LGM_TIMEOUT) {
+    basicRfAgcSwitch(HAL_RF_GAIN_HIGH);
+  }
+}
 
-    // Make sure byte fields are changed from network to host byte order
-    UINT16_NTOH(pHdr->panId);
-    UINT16_NTOH(pHdr->destAddr);
-    UINT16_NTOH(pHdr->srcAddr);
-#ifdef SECURITY_CCM
-    UINT32_NTOH(pHdr->frameCounter);
-#endif
 
-    rxi.ackRequest = !!(pHdr->fcf0 & BASIC_RF_FCF_ACK_BM_L);
+/**************************************************************************//**
+* @brief    Updates the LNA gain from the RSSI of a received data frame and
+*           counts the frame for the current gain. Frames with CRC errors
+*           are used too, since a saturated LNA is a cause of them.
+*
+* @param    rssi            RSSI in dBm
+* @param    crcOk           TRUE if the CRC was OK
+* @param    lost            Frames missing before this one in the sender's
+*                           sequence
+* @param    now             MAC timer when the frame was received
+*
+* @return   None
+******************************************************************************/
+static void basicRfAgcUpdate(int8 rssi, uint8 crcOk, uint8 lost, uint32 now)
+{
+  uint8 gain;
 
-    // Read the status word and check for CRC OK
-    pStatusWord= rxMpdu + 4;
+  gain = halRfGetGain();
+  agcState.rxFrames[gain]++;
+  agcState.rxLost[gain] += lost;
+  if (!crcOk) {
+    agcState.rxErrors[gain]++;
+  }
 
-    // Indicate the successful ACK reception if CRC and sequence number OK
-    if ((pStatusWord[1] & BASIC_RF_CRC_OK_BM) && (pHdr->seqNumber == txState.txSeqNumber)) {
-      txState.ackReceived = TRUE;
+  if (gain == HAL_RF_GAIN_HIGH) {
+    if (rssi >= BASIC_RF_AGC_LGM_THRESHOLD) {
+      basicRfAgcSwitch(HAL_RF_GAIN_LOW);
     }
+  } else if (rssi >= BASIC_RF_AGC_HGM_THRESHOLD) {
+    agcState.quietFrames = 0;
+    agcState.lastStrong = now;
+  } else if (++agcState.quietFrames >= BASIC_RF_AGC_HGM_FRAMES) {
+    basicRfAgcSwitch(HAL_RF_GAIN_HIGH);
+  } else {
+    basicRfAgcCheckTimeout(now);
   }
-  else
-  {
-    // It is data
-
-    // It is assumed that the radio rejects packets with invalid length.
-    // Subtract the number of bytes in the frame overhead to get actual payload.
-
-    rxi.length = pHdr->packetLength - BASIC_RF_PACKET_OVERHEAD_SIZE;
-
-#ifdef SECURITY_CCM
-    rxi.length -= (BASIC_RF_AUX_HDR_LENGTH + BASIC_RF_LEN_MIC);
-    authStatus = halRfReadRxBufSecure(&rxMpdu[1], pHdr->packetLength, rxi.length,
-                                      BASIC_RF_LEN_AUTH, BASIC_RF_SECURITY_M);
-#else
-    halRfReadRxBuf(&rxMpdu[1], pHdr->packetLength);
-#endif
+}
 
-    // Make sure byte fields are changed from network to host byte order
-    UINT16_NTOH(pHdr->panId);
-    UINT16_NTOH(pHdr->destAddr);
-    UINT16_NTOH(pHdr->srcAddr);
-#ifdef SECURITY_CCM
-    UINT32_NTOH(pHdr->frameCounter);
-#endif
 
-    rxi.ackRequest = !!(pHdr->fcf0 & BASIC_RF_FCF_ACK_BM_L);
+/**************************************************************************//**
+* @brief    Writes a short or extended address to a header
+*
+* @param    p               Where to write the address
+* @param    addr            Short address, or BASIC_RF_ADDR_USE_EXT
+* @param    pExtAddr        Extended address, used if \e addr is
+*                           BASIC_RF_ADDR_USE_EXT
+*
+* @return   Returns pointer to the byte after the address
+******************************************************************************/
+static uint8* basicRfWriteAddr(uint8* p, uint16 addr, const uint8* pExtAddr)
+{
+  if (addr == BASIC_RF_ADDR_USE_EXT) {
+    memcpy(p, pExtAddr, BASIC_RF_EXT_ADDR_SIZE);
+    return p + BASIC_RF_EXT_ADDR_SIZE;
+  }
+  *p++ = LO_UINT16(addr);
+  *p++ = HI_UINT16(addr);
+  return p;
+}
 
-    // Read the source address
-    rxi.srcAddr= pHdr->srcAddr;
 
-    // Read the packet payload
-    rxi.pPayload = rxMpdu + BASIC_RF_HDR_SIZE;
+/**************************************************************************//**
+* @brief    Serialises the header fields that only depend on the configuration
+*           (PAN ID, source address and security) to the header template.
+*           Called by basicRfInit() and whenever the addresses change. The
+*           source address is short if available, extended otherwise. Source
+*           and destination are always in the same PAN, so the source PAN ID
+*           is compressed away.
+*
+* @return   None
+******************************************************************************/
+static void basicRfHdrRefresh(void)
+{
+  uint16 fcf;
+  uint8 *p;
 
-    // Read the FCS to get the RSSI and CRC
-    pStatusWord= rxi.pPayload+rxi.length;
+  fcf = BASIC_RF_FCF_PANID_COMP_BM;
+  fcf |= (uint16)((pConfig->myAddr == BASIC_RF_ADDR_USE_EXT) ?
+                  BASIC_RF_ADDR_MODE_EXT : BASIC_RF_ADDR_MODE_SHORT) << BASIC_RF_FCF_SRC_MODE_S;
 #ifdef SECURITY_CCM
-    pStatusWord+= BASIC_RF_LEN_MIC;
+  fcf |= BASIC_RF_SEC_ENABLED_FCF_BM;
 #endif
-    rxi.rssi = pStatusWord[0];
+  hdrTemplate.fcf[0] = LO_UINT16(fcf);
+  hdrTemplate.fcf[1] = HI_UINT16(fcf);
+  hdrTemplate.panId[0] = LO_UINT16(pConfig->panId);
+  hdrTemplate.panId[1] = HI_UINT16(pConfig->panId);
 
-    // Notify the application about the received data packet if the CRC is OK
-    // Throw packet if the previous packet had the same sequence number
-    if( (pStatusWord[1] & BASIC_RF_CRC_OK_BM) && (rxi.seqNumber != pHdr->seqNumber) )
-    {
-      // If security is used check also that authentication passed
+  p = basicRfWriteAddr(hdrTemplate.tail, pConfig->myAddr, pConfig->extAddr);
 #ifdef SECURITY_CCM
-      if( authStatus==SUCCESS )
-      {
-        if ( (pHdr->fcf0 & BASIC_RF_FCF_BM_L) ==
-            (BASIC_RF_FCF_NOACK_L | BASIC_RF_SEC_ENABLED_FCF_BM_L))
-        {
-          rxi.isReady = TRUE;
-        }
-      }
-#else
-      if ( ((pHdr->fcf0 & (BASIC_RF_FCF_BM_L)) == BASIC_RF_FCF_NOACK_L) )
-      {
-        rxi.isReady = TRUE;
-      }
-      else
-      {
-        rxi.isReady = FALSE;
-      }
+  *p++ = SECURITY_CONTROL;
 #endif
-    }
-    else
-    {
-      rxi.isReady = FALSE;
-    }
-    rxi.seqNumber = pHdr->seqNumber;
-  }
-
-  // Enable RX frame done interrupt again
-  halIntOff();
-  halRfEnableRxInterrupt();
+  hdrTemplate.tailLength = (uint8)(p - hdrTemplate.tail);
 }
 
 
-/******************************************************************************
-* GLOBAL FUNCTIONS
-*/
 /**************************************************************************//**
-* @brief    Initialise basic RF datastructures. Sets channel, short address and
-*           PAN id in the chip and configures interrupt on packet reception
+* @brief    Builds packet header according to IEEE 802.15.4 frame format from
+*           the header template. The destination address is short where
+*           available, extended otherwise.
 *
-* @param    pRfConfig   Pointer to BASIC_RF_CONFIG struct. This struct must be
-*                       allocated by higher layer.
-*           txState     File scope variable that keeps tx state info.
-*           rxi         File scope variable info extracted from the last
-*                       incoming frame.
+* @param    buffer          Pointer to buffer to write the header
+* @param    destAddr        Destination short address, or
+*                           BASIC_RF_ADDR_USE_EXT
+* @param    pDestExtAddr    Destination extended address, used if
+*                           \e destAddr is BASIC_RF_ADDR_USE_EXT
+* @param    payloadLength   Length of higher layer payload
+* @param    flags           TX_FLAG_*, selects a command frame and the frame
+*                           pending bit
 *
-* @return   None
+* @return   Returns  length of header
 ******************************************************************************/
-uint8 basicRfInit(basicRfCfg_t* pRfConfig)
+static uint8 basicRfBuildHeader(uint8* buffer, uint16 destAddr,
+                                const uint8* pDestExtAddr, uint8 payloadLength,
+                                uint8 flags)
 {
-  if (halRfInit()==FAILED)
-    return FAILED;
+  uint8 *p;
+  uint8 fcf;
+  uint8 hdrLength;
+
+  // Frame control bits that vary per frame, all in the low byte
+  fcf = (flags & TX_FLAG_CMD) ? BASIC_RF_FCF_TYPE_CMD : BASIC_RF_FCF_TYPE_DATA;
+  if (flags & TX_FLAG_PENDING) {
+    fcf |= BASIC_RF_FCF_PENDING_BM;
+  }
+  if (txState.ackRequest) {
+    fcf |= BASIC_RF_FCF_ACK_BM;
+  }
 
-  halIntOff();
+  // Populate packet header, all fields little endian
+  p = buffer + 1;
+  *p++ = hdrTemplate.fcf[0] | fcf;
+  if (destAddr == BASIC_RF_ADDR_USE_EXT) {
+    *p++ = hdrTemplate.fcf[1] | BASIC_RF_FCF_DST_EXT_HI;
+  } else {
+    *p++ = hdrTemplate.fcf[1] | BASIC_RF_FCF_DST_SHORT_HI;
+  }
+  *p++ = txState.txSeqNumber;
+  *p++ = hdrTemplate.panId[0];
+  *p++ = hdrTemplate.panId[1];
+  p = basicRfWriteAddr(p, destAddr, pDestExtAddr);
+  memcpy(p, hdrTemplate.tail, hdrTemplate.tailLength);
+  p += hdrTemplate.tailLength;
 
-  // Set the protocol configuration
-  pConfig = pRfConfig;
-  rxi.pPayload   = NULL;
+#ifdef SECURITY_CCM
 
-  txState.receiveOn = TRUE;
-  txState.frameCounter = 0;
+  // Add the frame counter of the security header
+  *p++ = LO_UINT16(LO_UINT32(txState.frameCounter));
+  *p++ = HI_UINT16(LO_UINT32(txState.frameCounter));
+  *p++ = LO_UINT16(HI_UINT32(txState.frameCounter));
+  *p++ = HI_UINT16(HI_UINT32(txState.frameCounter));
 
-  // Set channel
-  halRfSetChannel(pConfig->channel);
+#endif
 
-  // Write the short address and the PAN ID to the CC2520 RAM
-  halRfSetShortAddr(pConfig->myAddr);
-  halRfSetPanId(pConfig->panId);
+  hdrLength = (uint8)(p - buffer);
 
-  // if security is enabled, write key and nonce
+  // The length byte counts the rest of the header, payload, MIC and FCS
+  buffer[0] = hdrLength - 1 + payloadLength + BASIC_RF_FOOTER_SIZE;
 #ifdef SECURITY_CCM
-  basicRfSecurityInit(pConfig);
+  buffer[0] += BASIC_RF_LEN_MIC;
 #endif
 
-  // Set up receive interrupt (received data or acknowlegment)
-  halRfRxInterruptConfig(basicRfRxFrmDoneIsr);
-
-  halIntOn();
-
-  return SUCCESS;
+  return hdrLength;
 }
 
 
 /**************************************************************************//**
-* @brief    Send packet
+* @brief    Returns the total length of a list of payload segments
 *
-* @param    destAddr    Destination short address
-* @param    pPayload    Pointer to payload buffer. This buffer must be
-*                       allocated by higher layer.
-* @param    length      Length of payload
-*           txState     File scope variable that keeps tx state info
-*           mpdu        File scope variable. Buffer for the frame to send
+* @param    pSegs           Payload segments
+* @param    nSegs           Number of segments
 *
-* @return   Returns SUCCESS or FAILED
+* @return   Total length, saturated at 0xFFFF
 ******************************************************************************/
-uint8 basicRfSendPacket(uint16 destAddr, uint8* pPayload, uint8 length)
+static uint16 basicRfSegLength(const basicRfTxSeg_t* pSegs, uint8 nSegs)
 {
-  uint8 mpduLength;
-  uint8 status;
+  uint16 length = 0;
 
-  // Turn on receiver if its not on
-  if(!txState.receiveOn) {
-    halRfReceiveOn();
+  while (nSegs--) {
+    length += pSegs->length;
+    if (length > 0xFF00) {
+      return 0xFFFF;
+    }
+    pSegs++;
   }
+  return length;
+}
 
-  // Check packet length
-  length = MIN(length, BASIC_RF_MAX_PAYLOAD_SIZE);
-
-  // Wait until the transceiver is idle
-  halRfWaitTransceiverReady();
-
-  // Turn off RX frame done interrupt to avoid interference on the SPI interface
-  halRfDisableRxInterrupt();
-
-  mpduLength = basicRfBuildMpdu(destAddr, pPayload, length);
 
+/**************************************************************************//**
+* @brief    Builds the frame and writes it to the TX FIFO. The header is
+*           generated on the stack and each payload segment is streamed to
+*           the FIFO straight from its buffer. With SECURITY_CCM the frame is
+*           gathered in \e txMpdu first since it is secured in place.
+*           Broadcast frames never request an ACK and carry the group
+*           address in front of the payload. Command frames always request
+*           an ACK, and their command identifier is authenticated but not
+*           encrypted so that the radio can recognise data requests.
+*
+* @param    destAddr        Destination short address, or
+*                           BASIC_RF_ADDR_USE_EXT
+* @param    pDestExtAddr    Destination extended address, used if
+*                           \e destAddr is BASIC_RF_ADDR_USE_EXT
+* @param    groupAddr       Group address, used if \e destAddr is
+*                           BASIC_RF_BROADCAST_ADDR
+* @param    pSegs           Payload segments
+* @param    nSegs           Number of segments
+* @param    flags           TX_FLAG_*
+*
+* @return   None
+******************************************************************************/
+static void basicRfWriteTxFrame(uint16 destAddr, const uint8* pDestExtAddr,
+                                uint16 groupAddr, const basicRfTxSeg_t* pSegs,
+                                uint8 nSegs, uint8 flags)
+{
+  uint8 length;
+  uint8 group[BASIC_RF_GROUP_HDR_SIZE];
+  uint8 groupLength = 0;
 #ifdef SECURITY_CCM
-  halRfWriteTxBufSecure(txMpdu, mpduLength, length, BASIC_RF_LEN_AUTH, BASIC_RF_SECURITY_M);
-  txState.frameCounter++;     // Increment frame counter field
+  uint8 mpduLength;
+  uint8 hdrLength;
+  uint8 clearLength;
+  uint8 nonce[BASIC_RF_SEC_NONCE_SIZE];
 #else
-  halRfWriteTxBuf(txMpdu, mpduLength);
+  uint8 hdr[BASIC_RF_MAX_HDR_SIZE];
 #endif
 
-  // Turn on RX frame done interrupt for ACK reception
-  halRfEnableRxInterrupt();
+  // Each new frame gets a new sequence number. Retransmissions reuse it.
+  txState.txSeqNumber++;
 
-  // Send frame with CCA. return FAILED if not successful
-  if(halRfTransmit() != SUCCESS) {
-    status = FAILED;
+  if (destAddr == BASIC_RF_BROADCAST_ADDR) {
+    group[0] = LO_UINT16(groupAddr);
+    group[1] = HI_UINT16(groupAddr);
+    groupLength = BASIC_RF_GROUP_HDR_SIZE;
+    txState.ackRequest = FALSE;
+  } else {
+    txState.ackRequest = (flags & TX_FLAG_CMD) ? TRUE : pConfig->ackRequest;
   }
+  txState.ackPending = FALSE;
 
-  // Wait for the acknowledge to be received, if any
-  if (pConfig->ackRequest) {
-    txState.ackReceived = FALSE;
-
-    // We'll enter RX automatically, so just wait until we can be sure that the ack reception should have finished
-#ifdef __ICCARM__
-
-    // The timeout consists of a 12-symbol turnaround time, the ack packet duration, and a small margin
-    // TODO: Improve solution!
-    SysCtrlDelay((uint32)((SysCtrlClockGet() / 1000000) * BASIC_RF_ACK_WAIT));
-#else
-    halMcuWaitUs(BASIC_RF_ACK_WAIT);
-#endif
+  // Only links with ACK feedback get less than the default TX power
+  if (pConfig->txPowerControl) {
+    halRfApplyTxPower((txState.ackRequest && destAddr != BASIC_RF_ADDR_USE_EXT) ?
+                      basicRfNbrTxPower(destAddr) : halRfGetTxPower());
+  }
 
-    // If an acknowledgment has been received (by RxFrmDoneIsr), the ackReceived flag should be set
-    status = txState.ackReceived ? SUCCESS : FAILED;
+  // The TX and RX FIFOs are accessed independently on the CC2538, so RX
+  // interrupts may stay enabled while the TX FIFO is written.
+  length = (uint8)basicRfSegLength(pSegs, nSegs) + groupLength;
 
-  } else {
-    status = SUCCESS;
+#ifdef SECURITY_CCM
+  hdrLength = basicRfBuildHeader(txMpdu, destAddr, pDestExtAddr, length, flags);
+  mpduLength = hdrLength;
+  memcpy(&txMpdu[mpduLength], group, groupLength);
+  mpduLength += groupLength;
+  while (nSegs--) {
+    memcpy(&txMpdu[mpduLength], pSegs->pData, pSegs->length);
+    mpduLength += pSegs->length;
+    pSegs++;
   }
 
-  // Turn off the receiver if it should not continue to be enabled
-  if (!txState.receiveOn) {
-    halRfReceiveOff();
+  // Add the MIC and encrypt. Retransmissions reuse the frame counter.
+  basicRfSecBuildNonce(nonce, NULL, pConfig->panId, pConfig->myAddr,
+                       txState.frameCounter, BASIC_RF_SEC_LEVEL);
+  clearLength = (flags & TX_FLAG_CMD) ? 1 : 0;
+  basicRfSecProtect(&txMpdu[1], hdrLength - 1 + clearLength,
+                    length - clearLength, nonce, BASIC_RF_SEC_LEVEL);
+  halRfWriteTxBuf(txMpdu, mpduLength + BASIC_RF_LEN_MIC);
+  txState.frameCounter++;
+#else
+  halRfWriteTxBuf(hdr, basicRfBuildHeader(hdr, destAddr, pDestExtAddr, length,
+                                          flags));
+  if (groupLength) {
+    halRfAppendTxBuf(group, groupLength);
   }
-
-  if(status == SUCCESS) {
-    txState.txSeqNumber++;
+  while (nSegs--) {
+    halRfAppendTxBuf(pSegs->pData, pSegs->length);
+    pSegs++;
   }
-
-#ifdef SECURITY_CCM
-  halRfIncNonceTx();          // Increment nonce value
 #endif
-
-  return status;
 }
 
 
 /**************************************************************************//**
-* @brief    Check if a new packet is ready to be read by next higher layer
+* @brief    Appends a TX queue entry to a list. Must be called with interrupts
+*           disabled.
 *
-* @param    none
+* @param    pList           List to append to
+* @param    index           TX queue entry
 *
-* @return   uint8 - TRUE if a packet is ready to be read by higher layer
+* @return   None
 ******************************************************************************/
-uint8 basicRfPacketIsReady(void)
+static void basicRfTxListPush(basicRfTxList_t* pList, uint8 index)
 {
-  return rxi.isReady;
+  txQueue[index].next = TX_QUEUE_NONE;
+  if (pList->head == TX_QUEUE_NONE) {
+    pList->head = index;
+  } else {
+    txQueue[pList->tail].next = index;
+  }
+  pList->tail = index;
 }
 
 
 /**************************************************************************//**
-* @brief    Copies the payload of the last incoming packet into a buffer
+* @brief    Removes the first TX queue entry from a list. Must be called with
+*           interrupts disabled.
 *
-* @param    pRxData     Pointer to data buffer to fill. This buffer must be
-*                       allocated by higher layer.
-* @param    len         Number of bytes to read in to buffer
-* @param    pRssi       Pointer to variable holding packet RSSI. NULL if RSSI
-*                       is not to be stored.
-*           rxi         File scope variable holding the information of the last
-*                       incoming packet
+* @param    pList           List to remove from
 *
-* @return   uint8 - Number of bytes actually copied into buffer
+* @return   TX queue entry, or TX_QUEUE_NONE if the list is empty
 ******************************************************************************/
-uint8 basicRfReceive(uint8* pRxData, uint8 len, int16* pRssi)
+static uint8 basicRfTxListPop(basicRfTxList_t* pList)
 {
-  uint8 chunkSize, i;
-
-  halIntOff();
+  uint8 index = pList->head;
 
-  // Critical region start
-  // TODO: Copy data using DMA?
-  chunkSize = MIN(rxi.length, len);
-  for(i = 0; i < chunkSize; i++) {
-    *pRxData++ = rxi.pPayload[i];
+  if (index != TX_QUEUE_NONE) {
+    pList->head = txQueue[index].next;
   }
-
-  if(pRssi != NULL) {
-    *pRssi = rxi.rssi - halRfGetRssiOffset();
-  }
-  rxi.isReady = FALSE;
-
-  // Critical region end
-  halIntOn();
-
-  return chunkSize;
+  return index;
 }
 
 
 /**************************************************************************//**
-* @brief    Function copies the payload of the last incoming packet into a
-*           buffer.
+* @brief    Loads the next queued frame, highest priority first, into the TX
+*           FIFO and starts CSMA-CA. Does nothing if the queue is empty. Must
+*           be called with interrupts disabled and no frame in flight.
 *
-* @return   int8 - RSSI value
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
 ******************************************************************************/
-int8 basicRfGetRssi(void)
+static void basicRfTxNext(void)
 {
-  return rxi.rssi - halRfGetRssiOffset();
-}
+  basicRfTxEntry_t *pEntry;
+  uint8 prio;
+  uint8 index = TX_QUEUE_NONE;
+
+  for (prio = 0; prio < BASIC_RF_TX_PRIO_LEVELS && index == TX_QUEUE_NONE; prio++) {
+    index = basicRfTxListPop(&txPrioList[prio]);
+  }
+  if (index == TX_QUEUE_NONE) {
+    return;
+  }
+  pEntry = &txQueue[index];
+
+  basicRfAgcCheckTimeout(halRfMacTimerGet());
+
+  // Turn on receiver if its not on
+  if (!txState.receiveOn) {
+    basicRfRadioOn();
+  }
+
+  basicRfWriteTxFrame(pEntry->destAddr, pEntry->destExtAddr, pEntry->groupAddr,
+                      pEntry->pSegs, pEntry->nSegs, pEntry->flags);
+  txState.current = index;
+  txState.retries = 0;
+  txState.strobeStart = halRfMacTimerGet();
+  if (pEntry->flags & TX_FLAG_ONCE) {
+    // A busy channel ends the transmission at the first CCA
+    txState.nb = HAL_RF_MAC_MAX_CSMA_BACKOFFS;
+    txState.be = HAL_RF_MAC_MIN_BE;
+    basicRfTxStart();
+  } else {
+    basicRfCsmaStart();
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Ends the asynchronous transmission and reports the result to the
+*           TX done callback. Does nothing unless the transmission is in state
+*           \e fromState, so that competing completions (e.g. ACK reception
+*           and ACK timeout) only report once.
+*
+* @param    fromState       Expected TX state, TX_STATE_*
+* @param    result          BASIC_RF_TX_* result
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxComplete(uint8 fromState, uint8 result)
+{
+  basicRfTxDoneCb_t pfTxDone;
+  uint8 seqNumber;
+  uint8 retries;
+  uint16 destAddr;
+  uint16 key;
+
+  key = halIntLock();
+  if (txState.state != fromState) {
+    halIntUnlock(key);
+    return;
+  }
+  halRfMacTimerIntDisable();
+  seqNumber = txState.txSeqNumber;
+  retries = txState.retries;
+  destAddr = txQueue[txState.current].destAddr;
+
+  // Frames to an extended address have no neighbour table entry
+  switch (result) {
+  case BASIC_RF_TX_SENT:
+    stats.txPackets++;
+    break;
+  case BASIC_RF_TX_ACKED:
+    stats.txPackets++;
+    if (destAddr != BASIC_RF_ADDR_USE_EXT) {
+      basicRfNbrTxUpdate(destAddr, retries + 1, TRUE);
+    }
+    break;
+  case BASIC_RF_TX_NO_ACK:
+    stats.txNoAck++;
+    if (destAddr != BASIC_RF_ADDR_USE_EXT) {
+      basicRfNbrTxUpdate(destAddr, retries + 1, FALSE);
+    }
+    break;
+  case BASIC_RF_TX_ABORTED:
+    break;
+  default:
+    stats.txChannelBusy++;
+    break;
+  }
+  pfTxDone = txQueue[txState.current].pfTxDone;
+  if (pfTxDone == basicRfSyncTxDone) {
+    txState.syncPending = txState.ackPending;
+  }
+  basicRfTxListPush(&txFreeList, txState.current);
+  txState.current = TX_QUEUE_NONE;
+  txState.state = TX_STATE_IDLE;
+
+  // Load the next frame right away to keep the inter-frame gap short
+  basicRfTxNext();
+
+  // ACKs sent by this node use the default TX power
+  if (txState.state == TX_STATE_IDLE && pConfig->txPowerControl) {
+    halRfApplyTxPower(halRfGetTxPower());
+  }
+
+  // Turn off the receiver if it should not continue to be enabled
+  if (txState.state == TX_STATE_IDLE && !txState.receiveOn) {
+    basicRfRadioOff();
+  }
+  halIntUnlock(key);
+
+  if (pfTxDone != NULL) {
+    pfTxDone(seqNumber, result, retries);
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    TX done callback for basicRfSendPacket()
+*
+* @param    seqNumber       Sequence number of the packet
+* @param    result          BASIC_RF_TX_* result
+* @param    retries         Number of retransmissions
+*
+* @return   None
+******************************************************************************/
+static void basicRfSyncTxDone(uint8 seqNumber, uint8 result, uint8 retries)
+{
+  (void)seqNumber;
+
+  txState.syncResult = result;
+  txState.syncRetries = retries;
+  txState.syncDone = TRUE;
+}
+
+
+/**************************************************************************//**
+* @brief    Takes an entry from the TX queue free list
+*
+* @return   TX queue entry, or TX_QUEUE_NONE if the queue is full
+******************************************************************************/
+static uint8 basicRfTxAlloc(void)
+{
+  uint8 index;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfTxListPop(&txFreeList);
+  halIntUnlock(key);
+
+  return index;
+}
+
+
+/**************************************************************************//**
+* @brief    Puts a filled in TX queue entry on its priority list and starts
+*           transmission if no frame is in flight
+*
+* @param    index           TX queue entry
+* @param    priority        BASIC_RF_TX_PRIO_*
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxEnqueue(uint8 index, uint8 priority)
+{
+  uint16 key;
+
+  if (priority >= BASIC_RF_TX_PRIO_LEVELS) {
+    priority = BASIC_RF_TX_PRIO_BULK;
+  }
+
+  key = halIntLock();
+  basicRfTxListPush(&txPrioList[priority], index);
+  if (txState.state == TX_STATE_IDLE) {
+    basicRfTxNext();
+  }
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the largest payload that can be sent to an address
+*
+* @param    destAddr        Destination short address, or
+*                           BASIC_RF_ADDR_USE_EXT
+*
+* @return   uint8 - Maximum payload length
+******************************************************************************/
+static uint8 basicRfMaxPayload(uint16 destAddr)
+{
+  uint8 maxLength = BASIC_RF_MAX_PAYLOAD_SIZE;
+
+  if (destAddr == BASIC_RF_BROADCAST_ADDR) {
+    maxLength -= BASIC_RF_GROUP_HDR_SIZE;
+  } else if (destAddr == BASIC_RF_ADDR_USE_EXT) {
+    maxLength -= BASIC_RF_EXT_ADDR_EXTRA;
+  }
+  if (pConfig->myAddr == BASIC_RF_ADDR_USE_EXT) {
+    maxLength -= BASIC_RF_EXT_ADDR_EXTRA;
+  }
+  return maxLength;
+}
+
+
+/**************************************************************************//**
+* @brief    Takes an entry from the TX queue free list and copies a packet to
+*           it. Payloads longer than the maximum are truncated.
+*
+* @param    destAddr        Destination short address, or
+*                           BASIC_RF_ADDR_USE_EXT
+* @param    pDestExtAddr    Destination extended address, used if
+*                           \e destAddr is BASIC_RF_ADDR_USE_EXT
+* @param    groupAddr       Group address of a broadcast packet
+* @param    pPayload        Pointer to payload buffer
+* @param    length          Length of payload
+* @param    pfTxDone        TX done callback, may be NULL
+*
+* @return   TX queue entry, or TX_QUEUE_NONE if the queue is full
+******************************************************************************/
+static uint8 basicRfTxFill(uint16 destAddr, const uint8* pDestExtAddr,
+                           uint16 groupAddr, uint8* pPayload, uint8 length,
+                           basicRfTxDoneCb_t pfTxDone)
+{
+  basicRfTxEntry_t *pEntry;
+  uint8 index;
+
+  if (destAddr == BASIC_RF_ADDR_USE_EXT && pDestExtAddr == NULL) {
+    return TX_QUEUE_NONE;
+  }
+
+  index = basicRfTxAlloc();
+  if (index == TX_QUEUE_NONE) {
+    return TX_QUEUE_NONE;
+  }
+
+  // The entry is owned by the caller until it is put on a priority list
+  pEntry = &txQueue[index];
+  pEntry->destAddr = destAddr;
+  pEntry->groupAddr = groupAddr;
+  if (destAddr == BASIC_RF_ADDR_USE_EXT) {
+    memcpy(pEntry->destExtAddr, pDestExtAddr, BASIC_RF_EXT_ADDR_SIZE);
+  }
+  pEntry->seg.pData = pEntry->payload;
+  pEntry->seg.length = MIN(length, basicRfMaxPayload(destAddr));
+  pEntry->pSegs = &pEntry->seg;
+  pEntry->nSegs = 1;
+  pEntry->flags = 0;
+  pEntry->pfTxDone = pfTxDone;
+  memcpy(pEntry->payload, pPayload, pEntry->seg.length);
+
+  return index;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies a packet to the TX queue and starts transmission if no
+*           frame is in flight. Payloads longer than the maximum are
+*           truncated.
+*
+* @param    destAddr        Destination short address, or
+*                           BASIC_RF_ADDR_USE_EXT
+* @param    pDestExtAddr    Destination extended address, used if
+*                           \e destAddr is BASIC_RF_ADDR_USE_EXT
+* @param    groupAddr       Group address of a broadcast packet
+* @param    pPayload        Pointer to payload buffer
+* @param    length          Length of payload
+* @param    priority        BASIC_RF_TX_PRIO_*
+* @param    pfTxDone        TX done callback, may be NULL
+*
+* @return   SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+static uint8 basicRfTxQueuePacket(uint16 destAddr, const uint8* pDestExtAddr,
+                                  uint16 groupAddr, uint8* pPayload,
+                                  uint8 length, uint8 priority,
+                                  basicRfTxDoneCb_t pfTxDone)
+{
+  uint8 index;
+
+  index = basicRfTxFill(destAddr, pDestExtAddr, groupAddr, pPayload, length,
+                        pfTxDone);
+  if (index == TX_QUEUE_NONE) {
+    return FAILED;
+  }
+
+  basicRfTxEnqueue(index, priority);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the indirect table slot of a child
+*
+* @param    childAddr       Child short address, or INDIRECT_SLOT_FREE to
+*                           find a free slot
+*
+* @return   Slot, or INDIRECT_SLOT_NONE if not found
+******************************************************************************/
+static uint8 basicRfIndirectFind(uint16 childAddr)
+{
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_INDIRECT_CHILDREN; i++) {
+    if (indirectTable[i].addr == childAddr) {
+      return i;
+    }
+  }
+  return INDIRECT_SLOT_NONE;
+}
+
+
+/**************************************************************************//**
+* @brief    Moves the expired frames of an indirect table slot to a list and
+*           frees the slot if no frames are left. Frames are held in the
+*           order they were queued, so only the head needs to be checked.
+*           Must be called with interrupts disabled.
+*
+* @param    slot            Indirect table slot in use
+* @param    pExpired        List to append expired frames to
+*
+* @return   None
+******************************************************************************/
+static void basicRfIndirectCollect(uint8 slot, basicRfTxList_t* pExpired)
+{
+  basicRfIndirectSlot_t *pSlot = &indirectTable[slot];
+  uint32 now = halRfMacTimerGet();
+  uint8 index;
+
+  while ((index = pSlot->list.head) != TX_QUEUE_NONE &&
+         ((now - txQueue[index].timestamp) & HAL_RF_MAC_TIMER_MASK) >=
+         BASIC_RF_INDIRECT_TIMEOUT) {
+    basicRfTxListPop(&pSlot->list);
+    basicRfTxListPush(pExpired, index);
+    stats.txIndirectExpired++;
+  }
+
+  // The radio stops setting the frame pending bit for the child
+  if (pSlot->list.head == TX_QUEUE_NONE) {
+    halRfSrcMatchClearShort(slot);
+    pSlot->addr = INDIRECT_SLOT_FREE;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Frees the expired frames collected by basicRfIndirectCollect()
+*           and reports BASIC_RF_TX_EXPIRED to their TX done callbacks
+*
+* @param    pExpired        List of expired frames
+*
+* @return   None
+******************************************************************************/
+static void basicRfIndirectNotify(basicRfTxList_t* pExpired)
+{
+  basicRfTxDoneCb_t pfTxDone;
+  uint8 index;
+  uint16 key;
+
+  while ((index = basicRfTxListPop(pExpired)) != TX_QUEUE_NONE) {
+    pfTxDone = txQueue[index].pfTxDone;
+    key = halIntLock();
+    basicRfTxListPush(&txFreeList, index);
+    halIntUnlock(key);
+    if (pfTxDone != NULL) {
+      pfTxDone(0, BASIC_RF_TX_EXPIRED, 0);
+    }
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Releases the next frame held for a child that has sent a data
+*           request. The frame is sent with control priority and with the
+*           frame pending bit set if more frames are held. Called from the
+*           RX ISR.
+*
+* @param    childAddr       Short address of the child
+*
+* @return   None
+******************************************************************************/
+static void basicRfIndirectRelease(uint16 childAddr)
+{
+  basicRfTxList_t expired;
+  uint8 slot;
+  uint8 index = TX_QUEUE_NONE;
+  uint16 key;
+
+  expired.head = TX_QUEUE_NONE;
+
+  key = halIntLock();
+  slot = basicRfIndirectFind(childAddr);
+  if (slot != INDIRECT_SLOT_NONE) {
+    index = basicRfTxListPop(&indirectTable[slot].list);
+  }
+  if (index != TX_QUEUE_NONE) {
+    basicRfIndirectCollect(slot, &expired);
+    if (indirectTable[slot].list.head != TX_QUEUE_NONE) {
+      txQueue[index].flags |= TX_FLAG_PENDING;
+    }
+    basicRfTxListPush(&txPrioList[BASIC_RF_TX_PRIO_CONTROL], index);
+    if (txState.state == TX_STATE_IDLE) {
+      basicRfTxNext();
+    }
+  }
+  halIntUnlock(key);
+
+  basicRfIndirectNotify(&expired);
+}
+
+
+/**************************************************************************//**
+* @brief    Waits for the basicRfSyncTxDone() callback and maps the result to
+*           the basicRfSendPacket() return value
+*
+* @return   SUCCESS, FAILED or BASIC_RF_CHANNEL_ACCESS_FAILURE
+******************************************************************************/
+static uint8 basicRfSyncWait(void)
+{
+  uint16 key;
+
+  // Sleep until the TX done, ACK reception or ACK timeout interrupt. The
+  // flag is checked with interrupts off, so the interrupt can not come
+  // between the check and the wait.
+  key = halIntLock();
+  while (!txState.syncDone) {
+    halIntWait();
+    halIntUnlock(key);
+    key = halIntLock();
+  }
+  halIntUnlock(key);
+
+  switch (txState.syncResult) {
+  case BASIC_RF_TX_SENT:
+  case BASIC_RF_TX_ACKED:
+    return SUCCESS;
+  case BASIC_RF_TX_CHANNEL_BUSY:
+    return BASIC_RF_CHANNEL_ACCESS_FAILURE;
+  default:
+    return FAILED;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Performs clear channel assessment and starts the transmission of
+*           the frame in the TX FIFO if the channel is clear. If the channel
+*           is busy a new backoff is started, until macMaxCSMABackoffs is
+*           exceeded. Must be called with interrupts disabled.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxStart(void)
+{
+  txState.state = TX_STATE_TX;
+  txState.ackReceived = FALSE;
+  halRfEnableTxInterrupt();
+
+  if (halRfTransmitCca() == SUCCESS) {
+    return;
+  }
+
+  // Channel busy
+  halRfDisableTxInterrupt();
+  if (++txState.nb > HAL_RF_MAC_MAX_CSMA_BACKOFFS) {
+    basicRfTxComplete(TX_STATE_TX, BASIC_RF_TX_CHANNEL_BUSY);
+  } else {
+    txState.be = MIN(txState.be + 1, HAL_RF_MAC_MAX_BE);
+    basicRfCsmaBackoff();
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Waits a random number of backoff periods, [0, 2^BE - 1], before
+*           the next clear channel assessment. Must be called with interrupts
+*           disabled.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfCsmaBackoff(void)
+{
+  uint8 backoffs;
+
+  backoffs = halRfGetRandomByte() & ((1 << txState.be) - 1);
+
+  txState.state = TX_STATE_BACKOFF;
+  if (backoffs == 0) {
+    basicRfTxStart();
+  } else {
+    halRfMacTimerSetCompare((halRfMacTimerGet() + backoffs*HAL_RF_BACKOFF_PERIOD) &
+                            HAL_RF_MAC_TIMER_MASK);
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Starts unslotted CSMA-CA for the frame in the TX FIFO. Must be
+*           called with interrupts disabled.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfCsmaStart(void)
+{
+  txState.nb = 0;
+  txState.be = HAL_RF_MAC_MIN_BE;
+  basicRfCsmaBackoff();
+}
+
+
+/**************************************************************************//**
+* @brief    Schedules a retransmission of the frame still in the TX FIFO. The
+*           channel is accessed with a new CSMA-CA procedure. The sequence
+*           number is kept, so the receiver can detect duplicates. Must be
+*           called with interrupts disabled.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxRetry(void)
+{
+  txState.retries++;
+  stats.txRetries++;
+  basicRfCsmaStart();
+}
+
+
+/**************************************************************************//**
+* @brief    Interrupt service routine for TX done. Starts waiting for the
+*           acknowledgment if one was requested. The ACK timeout is counted
+*           from the end of the transmitted frame, and is ended early by the
+*           RX ISR when the ACK arrives. With low power listening, frames
+*           without ACK are repeated for the whole strobe window.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxDoneIsr(void)
+{
+  halRfDisableTxInterrupt();
+
+  if (txState.state != TX_STATE_TX) {
+    return;
+  }
+
+  if (txState.ackRequest) {
+    txState.state = TX_STATE_WAIT_ACK;
+    halRfMacTimerSetCompare((halRfMacTimerGet() + BASIC_RF_ACK_WAIT_SYMBOLS) &
+                            HAL_RF_MAC_TIMER_MASK);
+  } else if (basicRfTxStrobing()) {
+    lplState.txStrobes++;
+    basicRfTxStart();
+  } else {
+    basicRfTxComplete(TX_STATE_TX, BASIC_RF_TX_SENT);
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Interrupt service routine for the MAC timer. Handles CSMA-CA
+*           backoff and acknowledgment timeout. With low power listening an
+*           unacknowledged frame is sent again right away until the strobe
+*           window has passed, before the normal retransmissions.
+*
+*           txState         File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfTimerIsr(void)
+{
+  switch (txState.state) {
+  case TX_STATE_BACKOFF:
+    basicRfTxStart();
+    break;
+  case TX_STATE_WAIT_ACK:
+    if (txState.ackReceived) {
+      basicRfTxComplete(TX_STATE_WAIT_ACK, BASIC_RF_TX_ACKED);
+    } else if (basicRfTxStrobing()) {
+      lplState.txStrobes++;
+      basicRfTxStart();
+    } else if (txState.retries < pConfig->maxFrameRetries &&
+               !(txQueue[txState.current].flags & TX_FLAG_ONCE)) {
+      basicRfTxRetry();
+    } else {
+      basicRfTxComplete(TX_STATE_WAIT_ACK, BASIC_RF_TX_NO_ACK);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Checks if this node is a member of a multicast group. All nodes
+*           are members of BASIC_RF_BROADCAST_ADDR.
+*
+* @param    groupAddr       Group address
+*
+* @return   uint8 - TRUE if member
+******************************************************************************/
+static uint8 basicRfIsGroupMember(uint16 groupAddr)
+{
+  uint8 i;
+
+  if (groupAddr == BASIC_RF_BROADCAST_ADDR) {
+    return TRUE;
+  }
+  for (i = 0; i < BASIC_RF_GROUP_TABLE_SIZE; i++) {
+    if (groupTable[i] == groupAddr) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+
+/**************************************************************************//**
+* @brief    Reads one frame from the RX FIFO (either data or acknowlegdement).
+*           Data frames are put in the RX queue if there is room for them.
+*
+*           rxState     File scope variable that keeps rx state info
+*           txState     File scope variable that keeps tx state info
+*
+* @return   None
+******************************************************************************/
+static void basicRfRxFrame(void)
+{
+  basicRfFrame_t hdr;
+  basicRfRxSlot_t *pSlot;
+  basicRfRxFrame_t *pFrame;
+  uint8 *pMpdu;
+  uint8 *pStatusWord;
+  uint8 packetLength;
+  uint8 hdrLength;
+  uint16 groupAddr;
+  uint32 now;
+  int8 length;
+  int8 rssi;
+  uint8 lost;
+  uint8 isValid;
+#ifdef SECURITY_CCM
+  uint8 clearLength;
+  uint8 nonce[BASIC_RF_SEC_NONCE_SIZE];
+#endif
+
+  // Read into the next free slot in the RX pool. The slot is only taken off
+  // the free ring when the frame is published. If all slots are lent out
+  // the frame must still be read out of the RX FIFO (it may be an
+  // acknowledgment).
+  pSlot = basicRfRxqNext();
+  if (pSlot != NULL) {
+    pMpdu = pSlot->mpdu;
+    pFrame = &pSlot->frame;
+  } else {
+    pMpdu = rxDiscardMpdu;
+    pFrame = NULL;
+  }
+
+  // Read payload length.
+  halRfReadRxBuf(&pMpdu[0],1);
+  pMpdu[0] &= BASIC_RF_PLD_LEN_MASK; // Ignore MSB
+  packetLength = pMpdu[0];
+
+  // Is this an acknowledgment packet?
+  // Only ack packets may be 5 bytes in total.
+  if (packetLength == BASIC_RF_ACK_PACKET_SIZE) {
+
+    // Read the packet
+    halRfReadRxBuf(&pMpdu[1], packetLength);
+
+    // Read the status word in place of the FCS and check for CRC OK
+    pStatusWord = pMpdu + 1 + packetLength - BASIC_RF_FOOTER_SIZE;
+
+    // Indicate the successful ACK reception if CRC and sequence number OK
+    if ((pStatusWord[1] & BASIC_RF_CRC_OK_BM) &&
+        basicRfFrameParse(&pMpdu[1], packetLength - BASIC_RF_FOOTER_SIZE,
+                          &hdr) == SUCCESS &&
+        BASIC_RF_FRAME_GET_TYPE(hdr.fcf) == BASIC_RF_FRAME_TYPE_ACK &&
+        hdr.seqNumber == txState.txSeqNumber) {
+      txState.ackReceived = TRUE;
+      txState.ackPending = (hdr.fcf & BASIC_RF_FCF_PENDING_BM) ? TRUE : FALSE;
+
+      // Complete an asynchronous transmission without waiting for timeout
+      basicRfTxComplete(TX_STATE_WAIT_ACK, BASIC_RF_TX_ACKED);
+    }
+  }
+  else
+  {
+    // It is data
+
+    now = halRfMacTimerGet();
+    rxState.rxCount++;
+    lost = 0;
+    isValid = FALSE;
+
+    halRfReadRxBuf(&pMpdu[1], packetLength);
+
+    // Read the FCS to get the RSSI and CRC
+    pStatusWord= pMpdu + 1 + packetLength - BASIC_RF_FOOTER_SIZE;
+    rssi = (int8)pStatusWord[0] - halRfGetRssiOffset();
+    rxState.rssi = rssi;
+
+    // Only data and command frames with source and destination addresses
+    // are accepted. It is assumed that the radio rejects packets with
+    // invalid length.
+    hdrLength = 0;
+    length = -1;
+    if (packetLength >= BASIC_RF_FOOTER_SIZE &&
+        basicRfFrameParse(&pMpdu[1], packetLength - BASIC_RF_FOOTER_SIZE,
+                          &hdr) == SUCCESS &&
+        (BASIC_RF_FRAME_GET_TYPE(hdr.fcf) == BASIC_RF_FRAME_TYPE_DATA ||
+         BASIC_RF_FRAME_GET_TYPE(hdr.fcf) == BASIC_RF_FRAME_TYPE_CMD) &&
+        BASIC_RF_FRAME_GET_DST_MODE(hdr.fcf) != BASIC_RF_FRAME_ADDR_NONE &&
+        BASIC_RF_FRAME_GET_SRC_MODE(hdr.fcf) != BASIC_RF_FRAME_ADDR_NONE) {
+      hdrLength = 1 + hdr.hdrLength;
+      length = hdr.payloadLength;
+    }
+#ifdef SECURITY_CCM
+    length -= BASIC_RF_LEN_MIC;
+#endif
+
+    // Notify the application about the received data packet if the CRC is OK
+    if( (pStatusWord[1] & BASIC_RF_CRC_OK_BM) && hdrLength != 0 && length >= 0 )
+    {
+      // If security is used check also that authentication passed.
+      // Replays can only be detected for senders in the neighbour table,
+      // so senders using their extended address are not accepted. The
+      // command identifier of command frames is not encrypted.
+#ifdef SECURITY_CCM
+      clearLength =
+        ((hdr.fcf & BASIC_RF_FCF_TYPE_BM) == BASIC_RF_FCF_TYPE_CMD) ? 1 : 0;
+      if( (hdr.fcf & BASIC_RF_SEC_ENABLED_FCF_BM) &&
+          hdr.secControl == SECURITY_CONTROL &&
+          hdr.srcAddr != BASIC_RF_ADDR_USE_EXT && length >= clearLength )
+      {
+        basicRfSecBuildNonce(nonce, NULL, hdr.srcPanId, hdr.srcAddr,
+                             hdr.frameCounter, BASIC_RF_SEC_LEVEL);
+        if( basicRfSecUnprotect(&pMpdu[1], hdrLength - 1 + clearLength,
+                                length - clearLength, nonce,
+                                BASIC_RF_SEC_LEVEL) == SUCCESS )
+        {
+          isValid = TRUE;
+        }
+      }
+      if( !isValid )
+      {
+        stats.rxSecFailures++;
+      }
+#else
+      if ( !(hdr.fcf & BASIC_RF_SEC_ENABLED_FCF_BM) )
+      {
+        isValid = TRUE;
+      }
+#endif
+
+      // Replays are dropped before they reach the neighbour statistics. A
+      // retransmission repeats the frame counter and is dropped here too.
+#ifdef SECURITY_CCM
+      if (isValid && basicRfNbrReplayCheck(hdr.srcAddr, hdr.frameCounter)) {
+        isValid = FALSE;
+        stats.rxReplays++;
+      }
+#endif
+
+      // Throw packet if the previous packet from the same sender had the
+      // same sequence number. Senders using their extended address are not
+      // in the neighbour table.
+      if (isValid && hdr.srcAddr != BASIC_RF_ADDR_USE_EXT &&
+          basicRfNbrRxUpdate(hdr.srcAddr, hdr.seqNumber, rssi,
+                             pStatusWord[1] & BASIC_RF_CORR_BM, now, &lost)) {
+        isValid = FALSE;
+        stats.rxDuplicates++;
+      }
+    }
+
+    // Command frames are handled here and never delivered. A data request
+    // releases the next frame held for the sender.
+    if (isValid && (hdr.fcf & BASIC_RF_FCF_TYPE_BM) == BASIC_RF_FCF_TYPE_CMD) {
+      isValid = FALSE;
+      if (length >= 1 && pMpdu[hdrLength] == BASIC_RF_CMD_DATA_REQUEST &&
+          hdr.srcAddr != BASIC_RF_ADDR_USE_EXT) {
+        basicRfIndirectRelease(hdr.srcAddr);
+      }
+    }
+
+    // Broadcast packets start with the group address. Drop packets for
+    // groups this node is not a member of. hdr is only set if the frame
+    // parsed.
+    if (isValid) {
+      groupAddr = hdr.dstAddr;
+      if (hdr.dstAddr == BASIC_RF_BROADCAST_ADDR) {
+        if (length < BASIC_RF_GROUP_HDR_SIZE) {
+          isValid = FALSE;
+        } else {
+          groupAddr = BUILD_UINT16(pMpdu[hdrLength], pMpdu[hdrLength + 1]);
+          hdrLength += BASIC_RF_GROUP_HDR_SIZE;
+          length -= BASIC_RF_GROUP_HDR_SIZE;
+          if (!basicRfIsGroupMember(groupAddr)) {
+            isValid = FALSE;
+            stats.rxGroupFiltered++;
+          }
+        }
+      }
+    }
+
+    if (isValid) {
+      // A frame from the parent polled by basicRfPoll() ends the wait
+      if (rxState.pollPending && hdr.srcAddr == rxState.pollAddr) {
+        rxState.pollMore = (hdr.fcf & BASIC_RF_FCF_PENDING_BM) ? TRUE : FALSE;
+        rxState.pollReceived = TRUE;
+      }
+
+      if (pFrame != NULL) {
+        pFrame->pPayload = pMpdu + hdrLength;
+        pFrame->length = length;
+        pFrame->seqNumber = hdr.seqNumber;
+        pFrame->dstAddr = groupAddr;
+        pFrame->srcAddr = hdr.srcAddr;
+        if (hdr.srcAddr == BASIC_RF_ADDR_USE_EXT) {
+          memcpy(pFrame->srcExtAddr, hdr.pSrcExtAddr, BASIC_RF_EXT_ADDR_SIZE);
+        }
+        pFrame->srcPanId = hdr.srcPanId;
+        pFrame->rssi = rssi;
+        pFrame->lqi = pStatusWord[1] & BASIC_RF_CORR_BM;
+        pFrame->timestamp = now;
+        pFrame->framePending = (hdr.fcf & BASIC_RF_FCF_PENDING_BM) ? TRUE : FALSE;
+
+        // Move the slot from the free ring to the ready ring
+        basicRfRxqPublish();
+        stats.rxPackets++;
+      } else {
+        stats.rxQueueOverflow++;
+      }
+    }
+
+    if (pConfig->lnaAgc) {
+      basicRfAgcUpdate(rssi, (pStatusWord[1] & BASIC_RF_CRC_OK_BM) ? TRUE : FALSE,
+                       lost, now);
+    }
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Interrupt service routine for received frame from radio. Reads
+*           all complete frames from the RX FIFO, since more than one frame
+*           may have been received before the interrupt was served.
+*
+* @return   None
+******************************************************************************/
+static void basicRfRxFrmDoneIsr(void)
+{
+  // Clear interrupt and disable new RX frame done interrupt
+  halRfDisableRxInterrupt();
+
+  // Enable all other interrupt sources (enables interrupt nesting)
+  halIntOn();
+
+  while (halRfRxFrameReady()) {
+    basicRfRxFrame();
+  }
+
+  // The radio stops receiving when the RX FIFO overflows. Flush it and
+  // resume reception.
+  if (halRfRxFifoOverflow()) {
+    stats.rxFifoOverflow++;
+    halRfReceiveOn();
+  }
+
+  // Enable RX frame done interrupt again
+  halIntOff();
+  halRfEnableRxInterrupt();
+}
+
+
+/**************************************************************************//**
+* @brief    Checks the channel for a low power listening sender. The receiver
+*           is turned on for BASIC_RF_LPL_CHECK_SYMBOLS and, if the channel
+*           is busy, kept on until a frame is received or
+*           BASIC_RF_LPL_LISTEN_SYMBOLS have passed.
+*
+* @return   None
+******************************************************************************/
+static void basicRfLplCheck(void)
+{
+  uint32 start;
+  uint8 rxCount;
+  uint8 busy = FALSE;
+  uint16 key;
+
+  key = halIntLock();
+  basicRfRadioOn();
+  halIntUnlock(key);
+  lplState.channelChecks++;
+
+  start = halRfMacTimerGet();
+  while (!busy && ((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK) <
+         BASIC_RF_LPL_CHECK_SYMBOLS) {
+    busy = !halRfChannelClear();
+  }
+
+  if (busy) {
+    lplState.channelBusy++;
+    rxCount = rxState.rxCount;
+    start = halRfMacTimerGet();
+    while (rxState.rxCount == rxCount &&
+           ((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK) <
+           BASIC_RF_LPL_LISTEN_SYMBOLS);
+
+    // Give the radio time to send the acknowledgment
+    if (rxState.rxCount != rxCount) {
+      start = halRfMacTimerGet();
+      while (((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK) <
+             BASIC_RF_LPL_ACK_SYMBOLS);
+      halRfWaitTransceiverReady();
+    }
+  }
+
+  key = halIntLock();
+  if (txState.state == TX_STATE_IDLE && !txState.receiveOn) {
+    basicRfRadioOff();
+  }
+  halIntUnlock(key);
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Initialise basic RF datastructures. Sets channel, short address and
+*           PAN id in the chip and configures interrupt on packet reception
+*
+* @param    pRfConfig   Pointer to BASIC_RF_CONFIG struct. This struct must be
+*                       allocated by higher layer.
+*           txState     File scope variable that keeps tx state info.
+*           rxState     File scope variable that keeps rx state info.
+*
+* @return   None
+******************************************************************************/
+uint8 basicRfInit(basicRfCfg_t* pRfConfig)
+{
+  uint8 i;
+
+  // A node without a short address must have an extended address
+  if (pRfConfig->myAddr == BASIC_RF_ADDR_USE_EXT && pRfConfig->extAddr == NULL)
+    return FAILED;
+#ifdef SECURITY_CCM
+  // Receivers keep replay state by short address
+  if (pRfConfig->myAddr == BASIC_RF_ADDR_USE_EXT)
+    return FAILED;
+#endif
+
+  if (halRfInit()==FAILED)
+    return FAILED;
+
+  // If security is enabled, load the key and the nonce prefix
+#ifdef SECURITY_CCM
+  if (basicRfSecInit(pRfConfig->securityKey, pRfConfig->securityNonce)==FAILED)
+    return FAILED;
+#endif
+
+  halIntOff();
+
+  // Set the protocol configuration
+  pConfig = pRfConfig;
+  basicRfRxqInit();
+  rxState.pollPending = FALSE;
+
+  // With low power listening the receiver is only on for channel checks
+  txState.receiveOn = (pConfig->wakeInterval == 0);
+  txState.frameCounter = 0;
+  txState.state = TX_STATE_IDLE;
+  txState.current = TX_QUEUE_NONE;
+
+  // All TX queue entries start out on the free list
+  txPrioList[BASIC_RF_TX_PRIO_CONTROL].head = TX_QUEUE_NONE;
+  txPrioList[BASIC_RF_TX_PRIO_BULK].head = TX_QUEUE_NONE;
+  txFreeList.head = TX_QUEUE_NONE;
+  for (i = 0; i < BASIC_RF_TX_QUEUE_SIZE; i++) {
+    basicRfTxListPush(&txFreeList, i);
+  }
+
+  // No frames are held for children. halRfInit() has cleared the source
+  // address matching table.
+  for (i = 0; i < BASIC_RF_INDIRECT_CHILDREN; i++) {
+    indirectTable[i].addr = INDIRECT_SLOT_FREE;
+    indirectTable[i].list.head = TX_QUEUE_NONE;
+  }
+
+  memset(&lplState, 0, sizeof(lplState));
+  lplState.statsStart = halTimer32kReadTimerValue();
+  lplState.lastCheck = lplState.statsStart;
+
+  // Start in high gain, the gain is lowered on the first strong frame
+  memset(&agcState, 0, sizeof(agcState));
+  if (pConfig->lnaAgc) {
+    halRfSetGain(HAL_RF_GAIN_HIGH);
+  }
+
+  basicRfHdrRefresh();
+  basicRfNbrInit();
+  basicRfTpcInit(NULL, 0);
+  for (i = 0; i < BASIC_RF_GROUP_TABLE_SIZE; i++) {
+    groupTable[i] = BASIC_RF_BROADCAST_ADDR;
+  }
+
+  // Set channel, the quietest one if so configured
+  if (pConfig->channel == BASIC_RF_CHANNEL_AUTO) {
+    pConfig->channel = basicRfScanRun();
+  }
+  halRfSetChannel(pConfig->channel);
+
+  // Write the short address and the PAN ID to the CC2520 RAM
+  halRfSetShortAddr(pConfig->myAddr);
+  halRfSetPanId(pConfig->panId);
+  if (pConfig->extAddr != NULL) {
+    halRfSetExtAddr(pConfig->extAddr);
+  }
+
+  // Set up receive interrupt (received data or acknowlegment)
+  halRfRxInterruptConfig(basicRfRxFrmDoneIsr);
+
+  // Set up TX done and timer interrupts for asynchronous transmission
+  halRfTxInterruptConfig(basicRfTxDoneIsr);
+  halRfMacTimerIntConnect(basicRfTimerIsr);
+
+  halIntOn();
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet. Blocks until the packet is sent and, if requested,
+*           acknowledged or the acknowledgment wait duration has expired.
+*           The packet is queued with control priority, so it may have to
+*           wait for the packet currently in flight.
+*           Must not be called from interrupt context.
+*
+* @param    destAddr    Destination short address
+* @param    pPayload    Pointer to payload buffer. This buffer must be
+*                       allocated by higher layer.
+* @param    length      Length of payload
+*           txState     File scope variable that keeps tx state info
+*
+* @return   Returns SUCCESS, FAILED if not acknowledged or the TX queue is
+*           full, or BASIC_RF_CHANNEL_ACCESS_FAILURE if CSMA-CA failed
+******************************************************************************/
+uint8 basicRfSendPacket(uint16 destAddr, uint8* pPayload, uint8 length)
+{
+  txState.syncDone = FALSE;
+  if(basicRfSendPacketAsync(destAddr, pPayload, length,
+                            BASIC_RF_TX_PRIO_CONTROL,
+                            basicRfSyncTxDone) != SUCCESS) {
+    return FAILED;
+  }
+
+  return basicRfSyncWait();
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet made up of several payload segments, e.g. an
+*           application header and a block of samples. The segments are
+*           streamed from caller memory directly to the TX FIFO without an
+*           intermediate copy. Blocks like basicRfSendPacket(). The segment
+*           list and the buffers it points to must not change until the
+*           function returns.
+*           Must not be called from interrupt context.
+*
+* @param    destAddr    Destination short address
+* @param    pSegs       Array of payload segments, sent in order
+* @param    nSegs       Number of segments
+*           txState     File scope variable that keeps tx state info
+*
+* @return   Returns SUCCESS, FAILED if the payload is too long, the TX queue
+*           is full or the packet is not acknowledged, or
+*           BASIC_RF_CHANNEL_ACCESS_FAILURE if CSMA-CA failed
+******************************************************************************/
+uint8 basicRfSendPacketV(uint16 destAddr, const basicRfTxSeg_t* pSegs,
+                         uint8 nSegs)
+{
+  basicRfTxEntry_t *pEntry;
+  uint8 index;
+
+  if(destAddr == BASIC_RF_ADDR_USE_EXT ||
+     basicRfSegLength(pSegs, nSegs) > basicRfMaxPayload(destAddr)) {
+    return FAILED;
+  }
+
+  index = basicRfTxAlloc();
+  if(index == TX_QUEUE_NONE) {
+    return FAILED;
+  }
+
+  // The entry refers to the caller's segments, its payload buffer is unused
+  pEntry = &txQueue[index];
+  pEntry->destAddr = destAddr;
+  pEntry->groupAddr = BASIC_RF_BROADCAST_ADDR;
+  pEntry->pSegs = pSegs;
+  pEntry->nSegs = nSegs;
+  pEntry->flags = 0;
+  pEntry->pfTxDone = basicRfSyncTxDone;
+
+  txState.syncDone = FALSE;
+  basicRfTxEnqueue(index, BASIC_RF_TX_PRIO_CONTROL);
+
+  return basicRfSyncWait();
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet without blocking. The packet is copied to the TX
+*           queue and the function returns immediately. Queued packets are
+*           sent back-to-back, all control priority packets before any bulk
+*           priority packet and in FIFO order within a priority class. The
+*           result is reported to \e pfTxDone from interrupt context once the
+*           packet has been sent and, if requested, acknowledged or timed out.
+*
+* @param    destAddr    Destination short address
+* @param    pPayload    Pointer to payload buffer. The payload is copied, so
+*                       the buffer may be reused when the function returns.
+* @param    length      Length of payload
+* @param    priority    BASIC_RF_TX_PRIO_CONTROL or BASIC_RF_TX_PRIO_BULK
+* @param    pfTxDone    TX done callback, NULL if no notification is needed
+*           txState     File scope variable that keeps tx state info
+*
+* @return   Returns SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+uint8 basicRfSendPacketAsync(uint16 destAddr, uint8* pPayload, uint8 length,
+                             uint8 priority, basicRfTxDoneCb_t pfTxDone)
+{
+  return basicRfTxQueuePacket(destAddr, NULL, BASIC_RF_BROADCAST_ADDR,
+                              pPayload, length, priority, pfTxDone);
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet without blocking, with a single attempt. The channel
+*           is assessed once, without random backoff, and the packet is not
+*           retransmitted if it is not acknowledged. Meant for schedules that
+*           give a packet a fixed time window, such as basic_rf_tsch.c.
+*           Otherwise works like basicRfSendPacketAsync() with control
+*           priority.
+*
+* @param    destAddr    Destination short address
+* @param    pPayload    Pointer to payload buffer, copied
+* @param    length      Length of payload
+* @param    pfTxDone    TX done callback, NULL if no notification is needed
+*
+* @return   Returns SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+uint8 basicRfSendPacketOnce(uint16 destAddr, uint8* pPayload, uint8 length,
+                            basicRfTxDoneCb_t pfTxDone)
+{
+  uint8 index;
+
+  index = basicRfTxFill(destAddr, NULL, BASIC_RF_BROADCAST_ADDR, pPayload,
+                        length, pfTxDone);
+  if (index == TX_QUEUE_NONE) {
+    return FAILED;
+  }
+  txQueue[index].flags = TX_FLAG_ONCE;
+  basicRfTxEnqueue(index, BASIC_RF_TX_PRIO_CONTROL);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet to a multicast group without blocking. The packet is
+*           broadcast, is never acknowledged and is only delivered by nodes
+*           that have joined the group with basicRfJoinGroup(). Otherwise
+*           works like basicRfSendPacketAsync().
+*
+* @param    groupAddr   Group address. BASIC_RF_BROADCAST_ADDR sends to all
+*                       nodes.
+* @param    pPayload    Pointer to payload buffer, copied
+* @param    length      Length of payload, at most
+*                       BASIC_RF_MAX_BCAST_PAYLOAD_SIZE
+* @param    priority    BASIC_RF_TX_PRIO_CONTROL or BASIC_RF_TX_PRIO_BULK
+* @param    pfTxDone    TX done callback, NULL if no notification is needed
+*
+* @return   Returns SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+uint8 basicRfSendMulticast(uint16 groupAddr, uint8* pPayload, uint8 length,
+                           uint8 priority, basicRfTxDoneCb_t pfTxDone)
+{
+  return basicRfTxQueuePacket(BASIC_RF_BROADCAST_ADDR, NULL, groupAddr,
+                              pPayload, length, priority, pfTxDone);
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet to an extended (64-bit) address without blocking,
+*           e.g. to a node that has no short address yet. Otherwise works
+*           like basicRfSendPacketAsync().
+*
+* @param    pDestExtAddr    Destination extended address, least significant
+*                           byte first. Copied.
+* @param    pPayload        Pointer to payload buffer, copied
+* @param    length          Length of payload
+* @param    priority        BASIC_RF_TX_PRIO_CONTROL or BASIC_RF_TX_PRIO_BULK
+* @param    pfTxDone        TX done callback, NULL if no notification is
+*                           needed
+*
+* @return   Returns SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+uint8 basicRfSendPacketExt(const uint8* pDestExtAddr, uint8* pPayload,
+                           uint8 length, uint8 priority,
+                           basicRfTxDoneCb_t pfTxDone)
+{
+  return basicRfTxQueuePacket(BASIC_RF_ADDR_USE_EXT, pDestExtAddr,
+                              BASIC_RF_BROADCAST_ADDR, pPayload, length,
+                              priority, pfTxDone);
+}
+
+
+/**************************************************************************//**
+* @brief    Send packet to a sleeping child (coordinator). The packet is held
+*           until the child polls with basicRfPoll(), then sent with control
+*           priority. Up to BASIC_RF_INDIRECT_CHILDREN children can have
+*           packets held at a time. While packets are held for a child the
+*           radio sets the frame pending bit in the acknowledgment of its
+*           data requests. Packets not polled within
+*           BASIC_RF_INDIRECT_TIMEOUT are dropped and reported as
+*           BASIC_RF_TX_EXPIRED, with sequence number 0. Expiry is checked
+*           when packets are queued and when the child polls.
+*           Held packets occupy TX queue entries, so BASIC_RF_TX_QUEUE_SIZE
+*           must cover them.
+*
+* @param    destAddr    Short address of the child
+* @param    pPayload    Pointer to payload buffer, copied
+* @param    length      Length of payload
+* @param    pfTxDone    TX done callback, NULL if no notification is needed
+*
+* @return   Returns SUCCESS, or FAILED if the TX queue or the indirect table
+*           is full
+******************************************************************************/
+uint8 basicRfSendIndirect(uint16 destAddr, uint8* pPayload, uint8 length,
+                          basicRfTxDoneCb_t pfTxDone)
+{
+  basicRfTxList_t expired;
+  uint8 index;
+  uint8 slot;
+  uint8 i;
+  uint16 key;
+
+  if(destAddr == BASIC_RF_ADDR_USE_EXT || destAddr == BASIC_RF_BROADCAST_ADDR) {
+    return FAILED;
+  }
+
+  index = basicRfTxFill(destAddr, NULL, BASIC_RF_BROADCAST_ADDR, pPayload,
+                        length, pfTxDone);
+  if(index == TX_QUEUE_NONE) {
+    return FAILED;
+  }
+  txQueue[index].timestamp = halRfMacTimerGet();
+
+  expired.head = TX_QUEUE_NONE;
+
+  key = halIntLock();
+  for(i = 0; i < BASIC_RF_INDIRECT_CHILDREN; i++) {
+    if(indirectTable[i].addr != INDIRECT_SLOT_FREE) {
+      basicRfIndirectCollect(i, &expired);
+    }
+  }
+
+  slot = basicRfIndirectFind(destAddr);
+  if(slot == INDIRECT_SLOT_NONE) {
+    slot = basicRfIndirectFind(INDIRECT_SLOT_FREE);
+    if(slot == INDIRECT_SLOT_NONE) {
+      basicRfTxListPush(&txFreeList, index);
+      halIntUnlock(key);
+      basicRfIndirectNotify(&expired);
+      return FAILED;
+    }
+    indirectTable[slot].addr = destAddr;
+    indirectTable[slot].list.head = TX_QUEUE_NONE;
+    halRfSrcMatchSetShort(slot, pConfig->panId, destAddr);
+    halRfSrcMatchSetPending(slot, TRUE);
+  }
+  basicRfTxListPush(&indirectTable[slot].list, index);
+  halIntUnlock(key);
+
+  basicRfIndirectNotify(&expired);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Polls the parent for a held packet (sleepy end device). Sends a
+*           data request and, if the acknowledgment has the frame pending
+*           bit set, keeps the receiver on until the packet arrives. The
+*           packet is put in the RX queue and read as usual. The receiver is
+*           left as it was, so an end device can keep it off between polls
+*           with basicRfReceiveOff().
+*           Must not be called from interrupt context.
+*
+* @param    parentAddr  Short address of the parent
+* @param    pMore       Set to TRUE if the parent holds more packets. May be
+*                       NULL.
+*
+* @return   Returns SUCCESS if a packet was received, BASIC_RF_POLL_NO_DATA
+*           if the parent holds no packets, BASIC_RF_CHANNEL_ACCESS_FAILURE
+*           if CSMA-CA failed, or FAILED if the data request was not
+*           acknowledged or the packet did not arrive
+******************************************************************************/
+uint8 basicRfPoll(uint16 parentAddr, uint8* pMore)
+{
+  uint8 cmd = BASIC_RF_CMD_DATA_REQUEST;
+  uint8 receiveOn;
+  uint8 index;
+  uint8 result;
+  uint32 start;
+
+  if(pMore != NULL) {
+    *pMore = FALSE;
+  }
+
+  // The parent looks up held packets by short address
+  if(pConfig->myAddr == BASIC_RF_ADDR_USE_EXT ||
+     parentAddr == BASIC_RF_ADDR_USE_EXT ||
+     parentAddr == BASIC_RF_BROADCAST_ADDR) {
+    return FAILED;
+  }
+
+  index = basicRfTxFill(parentAddr, NULL, BASIC_RF_BROADCAST_ADDR, &cmd, 1,
+                        basicRfSyncTxDone);
+  if(index == TX_QUEUE_NONE) {
+    return FAILED;
+  }
+  txQueue[index].flags = TX_FLAG_CMD;
+
+  // Keep the receiver on after the acknowledgment
+  receiveOn = txState.receiveOn;
+  basicRfReceiveOn();
+
+  rxState.pollAddr = parentAddr;
+  rxState.pollReceived = FALSE;
+  rxState.pollPending = TRUE;
+
+  txState.syncDone = FALSE;
+  basicRfTxEnqueue(index, BASIC_RF_TX_PRIO_CONTROL);
+  result = basicRfSyncWait();
+
+  if(result == SUCCESS) {
+    if(!txState.syncPending) {
+      result = BASIC_RF_POLL_NO_DATA;
+    } else {
+      start = halRfMacTimerGet();
+      while(!rxState.pollReceived &&
+            ((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK) <
+            BASIC_RF_POLL_WAIT_SYMBOLS);
+      if(!rxState.pollReceived) {
+        result = FAILED;
+      } else if(pMore != NULL) {
+        *pMore = rxState.pollMore;
+      }
+    }
+  }
+  rxState.pollPending = FALSE;
+
+  if(!receiveOn) {
+    basicRfReceiveOff();
+  }
+
+  return result;
+}
+
+
+/**************************************************************************//**
+* @brief    Adds a group to the multicast group table, so that packets sent
+*           to it with basicRfSendMulticast() are received
+*
+* @param    groupAddr   Group address
+*
+* @return   uint8 - SUCCESS, or FAILED if the table is full
+******************************************************************************/
+uint8 basicRfJoinGroup(uint16 groupAddr)
+{
+  uint8 i;
+
+  if(basicRfIsGroupMember(groupAddr)) {
+    return SUCCESS;
+  }
+  for(i = 0; i < BASIC_RF_GROUP_TABLE_SIZE; i++) {
+    if(groupTable[i] == BASIC_RF_BROADCAST_ADDR) {
+      groupTable[i] = groupAddr;
+      return SUCCESS;
+    }
+  }
+  return FAILED;
+}
+
+
+/**************************************************************************//**
+* @brief    Removes a group from the multicast group table
+*
+* @param    groupAddr   Group address
+*
+* @return   None
+******************************************************************************/
+void basicRfLeaveGroup(uint16 groupAddr)
+{
+  uint8 i;
+
+  for(i = 0; i < BASIC_RF_GROUP_TABLE_SIZE; i++) {
+    if(groupTable[i] == groupAddr) {
+      groupTable[i] = BASIC_RF_BROADCAST_ADDR;
+    }
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the number of retransmissions of the last packet sent
+*           with basicRfSendPacket(), e.g. to measure delivery latency
+*
+* @return   uint8 - Number of retransmissions
+******************************************************************************/
+uint8 basicRfGetTxRetries(void)
+{
+  return txState.syncRetries;
+}
+
+
+/**************************************************************************//**
+* @brief    Check if an asynchronous transmission is in progress. The TX
+*           queue is empty when this returns FALSE.
+*
+* @return   uint8 - TRUE if a packet is in flight
+******************************************************************************/
+uint8 basicRfTxIsBusy(void)
+{
+  return (txState.state != TX_STATE_IDLE);
+}
+
+
+/**************************************************************************//**
+* @brief    Ends the asynchronous transmission in progress, if any, and
+*           reports BASIC_RF_TX_ABORTED to its TX done callback. A frame
+*           being sent is cut off. The next queued packet, if any, is
+*           started.
+*
+* @return   None
+******************************************************************************/
+void basicRfTxAbort(void)
+{
+  uint16 key;
+
+  key = halIntLock();
+  if (txState.state != TX_STATE_IDLE) {
+    // Turning the radio off ends a transmission in progress
+    halRfDisableTxInterrupt();
+    basicRfRadioOff();
+    if (txState.receiveOn) {
+      basicRfRadioOn();
+    }
+    basicRfTxComplete(txState.state, BASIC_RF_TX_ABORTED);
+  }
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the payload of the oldest packet in the RX queue into a
+*           buffer and removes the packet from the queue. Use
+*           basicRfRxBorrow() to avoid the copy.
+*
+* @param    pRxData     Pointer to data buffer to fill. This buffer must be
+*                       allocated by higher layer.
+* @param    len         Number of bytes to read in to buffer
+* @param    pRssi       Pointer to variable holding packet RSSI. NULL if RSSI
+*                       is not to be stored.
+*           rxState     File scope variable that keeps rx state info
+*
+* @return   uint8 - Number of bytes actually copied into buffer
+******************************************************************************/
+uint8 basicRfReceive(uint8* pRxData, uint8 len, int16* pRssi)
+{
+  basicRfRxFrame_t *pFrame;
+  uint8 chunkSize;
+
+  pFrame = basicRfRxBorrow();
+  if(pFrame == NULL) {
+    return 0;
+  }
+
+  chunkSize = MIN(pFrame->length, len);
+  memcpy(pRxData, pFrame->pPayload, chunkSize);
+
+  if(pRssi != NULL) {
+    *pRssi = pFrame->rssi;
+  }
+
+  basicRfRxRelease(pFrame);
+
+  return chunkSize;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the RSSI of the last received data packet.
+*
+* @return   int8 - RSSI value
+******************************************************************************/
+int8 basicRfGetRssi(void)
+{
+  return rxState.rssi;
+}
 
 /**************************************************************************//**
 * @brief    Turns on receiver on radio
@@ -593,8 +2303,12 @@ int8 basicRfGetRssi(void)
 ******************************************************************************/
 void basicRfReceiveOn(void)
 {
+  uint16 key;
+
+  key = halIntLock();
   txState.receiveOn = TRUE;
-  halRfReceiveOn();
+  basicRfRadioOn();
+  halIntUnlock(key);
 }
 
 
@@ -607,9 +2321,388 @@ void basicRfReceiveOn(void)
 ******************************************************************************/
 void basicRfReceiveOff(void)
 {
+  uint16 key;
+
+  key = halIntLock();
   txState.receiveOn = FALSE;
-  halRfReceiveOff();
+  basicRfRadioOff();
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Changes the radio channel. A receiver that is on is restarted on
+*           the new channel. Must not be called while a packet is being
+*           sent.
+*
+* @param    channel     Channel, 11-26
+*
+* @return   None
+******************************************************************************/
+void basicRfSetChannel(uint8 channel)
+{
+  uint16 key;
+
+  key = halIntLock();
+  pConfig->channel = channel;
+  halRfSetChannel(channel);
+  if (lplState.radioOn) {
+    halRfReceiveOn();
+  }
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Changes the PAN ID and the short address. The radio's address
+*           filter and the header template are updated. Must not be called
+*           while a packet is being sent.
+*
+* @param    panId       PAN ID
+* @param    myAddr      Short address, or BASIC_RF_ADDR_USE_EXT to use the
+*                       extended address
+*
+* @return   uint8 - SUCCESS, or FAILED if the node would have no address
+******************************************************************************/
+uint8 basicRfSetAddress(uint16 panId, uint16 myAddr)
+{
+  uint16 key;
+
+  if (myAddr == BASIC_RF_ADDR_USE_EXT && pConfig->extAddr == NULL) {
+    return FAILED;
+  }
+#ifdef SECURITY_CCM
+  if (myAddr == BASIC_RF_ADDR_USE_EXT) {
+    return FAILED;
+  }
+#endif
+
+  key = halIntLock();
+  pConfig->panId = panId;
+  pConfig->myAddr = myAddr;
+  halRfSetShortAddr(myAddr);
+  halRfSetPanId(panId);
+  basicRfHdrRefresh();
+  halIntUnlock(key);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the radio channel
+*
+* @return   uint8 - Channel, 11-26, or BASIC_RF_CHANNEL_AUTO during
+*           basicRfInit()
+******************************************************************************/
+uint8 basicRfGetChannel(void)
+{
+  return pConfig->channel;
+}
+
+
+/**************************************************************************//**
+* @brief    Low power listening idle handler. Call from the main loop
+*           whenever the application has nothing to do. If the next channel
+*           check is due the channel is checked, otherwise the MCU is put in
+*           PM2 with the radio off until it is due. Other interrupts end the
+*           sleep early, and the function then returns without a check.
+*           Does nothing unless wakeInterval is set in basicRfCfg_t, the
+*           receiver is off (basicRfReceiveOff()) and no packet is being
+*           sent.
+*
+*           All nodes of a network must use the same wake interval, since
+*           senders repeat each packet for one interval (until it is
+*           acknowledged) so that the receiver's channel check finds it.
+*
+* @return   TRUE if a packet is ready, see basicRfPacketIsReady()
+******************************************************************************/
+uint8 basicRfLplSleep(void)
+{
+  uint32 elapsed;
+  uint16 key;
+
+  if (pConfig->wakeInterval == 0 || txState.receiveOn || basicRfTxIsBusy()) {
+    return basicRfPacketIsReady();
+  }
+
+  elapsed = halTimer32kReadTimerValue() - lplState.lastCheck;
+  if (elapsed < pConfig->wakeInterval) {
+    // The MAC timer stops in PM2. Catch it up with the sleep time before
+    // any interrupt handler reads it.
+    key = halIntLock();
+    halRfMacTimerSleep();
+    halTimer32kMcuSleepTicks((uint16)(pConfig->wakeInterval - elapsed));
+    halRfMacTimerWake();
+    halIntUnlock(key);
+    elapsed = halTimer32kReadTimerValue() - lplState.lastCheck;
+    if (elapsed < pConfig->wakeInterval) {
+      return basicRfPacketIsReady();
+    }
+  }
+
+  lplState.lastCheck = halTimer32kReadTimerValue();
+  basicRfLplCheck();
+
+  return basicRfPacketIsReady();
+}
+
+
+/**************************************************************************//**
+* @brief    Reports the LNA gain switches and the packet error rate in each
+*           gain mode since the statistics were reset. A frame counts as an
+*           error if it had a CRC error, or if it was missing from a
+*           neighbour's sequence numbers (missed by the receiver, e.g.
+*           because the LNA was saturated or too insensitive).
+*
+* @param    pReport     Pointer to struct to fill. This struct must be
+*                       allocated by higher layer.
+*
+* @return   None
+******************************************************************************/
+void basicRfGetAgcReport(basicRfAgcReport_t* pReport)
+{
+  uint32 total;
+  uint32 errors;
+  uint16 key;
+  uint8 i;
+
+  key = halIntLock();
+  pReport->gain = halRfGetGain();
+  pReport->toLowGain = agcState.toLowGain;
+  pReport->toHighGain = agcState.toHighGain;
+  memcpy(pReport->rxFrames, agcState.rxFrames, sizeof(pReport->rxFrames));
+  memcpy(pReport->rxErrors, agcState.rxErrors, sizeof(pReport->rxErrors));
+  memcpy(pReport->rxLost, agcState.rxLost, sizeof(pReport->rxLost));
+  halIntUnlock(key);
+
+  for (i = 0; i < 2; i++) {
+    total = pReport->rxFrames[i] + pReport->rxLost[i];
+    errors = pReport->rxErrors[i] + pReport->rxLost[i];
+
+    // Scale down so that the multiplication does not overflow
+    while (total > 0x3FFFF) {
+      total >>= 1;
+      errors >>= 1;
+    }
+    pReport->per[i] = (total != 0) ? (uint16)((errors * 10000) / total) : 0;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Reports the radio on time since the statistics were reset and
+*           the resulting average radio current, to compare low power
+*           listening with an always-on receiver. The MCU's active current is
+*           not included.
+*
+* @param    pReport     Pointer to struct to fill. This struct must be
+*                       allocated by higher layer.
+*
+* @return   None
+******************************************************************************/
+void basicRfGetRadioReport(basicRfRadioReport_t* pReport)
+{
+  uint32 now;
+  uint32 elapsed;
+  uint32 onTicks;
+  uint16 key;
+
+  key = halIntLock();
+  now = halTimer32kReadTimerValue();
+  onTicks = lplState.onTicks;
+  if (lplState.radioOn) {
+    onTicks += now - lplState.onSince;
+  }
+  elapsed = now - lplState.statsStart;
+  pReport->channelChecks = lplState.channelChecks;
+  pReport->channelBusy = lplState.channelBusy;
+  pReport->txStrobes = lplState.txStrobes;
+  halIntUnlock(key);
+
+  pReport->elapsedTicks = elapsed;
+  pReport->radioOnTicks = onTicks;
+
+  // Scale down so that the multiplication does not overflow
+  while (elapsed > 0x3FFFF) {
+    elapsed >>= 1;
+    onTicks >>= 1;
+  }
+  pReport->dutyCycle = (elapsed != 0) ? (uint16)((onTicks * 10000) / elapsed) : 0;
+  pReport->avgCurrent = ((uint32)pReport->dutyCycle * BASIC_RF_RADIO_ON_CURRENT +
+                         (uint32)(10000 - pReport->dutyCycle) * BASIC_RF_SLEEP_CURRENT) /
+                        10000;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the statistics counters
+*
+* @param    pStats      Pointer to struct to fill. This struct must be
+*                       allocated by higher layer.
+*
+* @return   None
+******************************************************************************/
+void basicRfGetStats(basicRfStats_t* pStats)
+{
+  uint16 key;
+
+  key = halIntLock();
+  *pStats = stats;
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Clears the statistics counters
+*
+* @return   None
+******************************************************************************/
+void basicRfResetStats(void)
+{
+  uint16 key;
+
+  key = halIntLock();
+  memset(&stats, 0, sizeof(stats));
+  lplState.statsStart = halTimer32kReadTimerValue();
+  lplState.onSince = lplState.statsStart;
+  lplState.onTicks = 0;
+  lplState.channelChecks = 0;
+  lplState.channelBusy = 0;
+  lplState.txStrobes = 0;
+  memset(agcState.rxFrames, 0, sizeof(agcState.rxFrames));
+  memset(agcState.rxErrors, 0, sizeof(agcState.rxErrors));
+  memset(agcState.rxLost, 0, sizeof(agcState.rxLost));
+  agcState.toLowGain = 0;
+  agcState.toHighGain = 0;
+  halIntUnlock(key);
+}
+
+
+#ifdef BASIC_RF_HDR_BENCHMARK
+/**************************************************************************//**
+* @brief    Measures the CPU cycles spent on the header of a transmitted
+*           frame: building it from the header template, and refreshing the
+*           template, which is the work that would otherwise be repeated for
+*           every frame. Each figure is averaged over HDR_BENCH_ROUNDS headers
+*           with a short destination address and includes the loop overhead.
+*           Must be called after basicRfInit() and with interrupts disabled.
+*
+* @param    pResult     Pointer to struct to fill
+*
+* @return   None
+******************************************************************************/
+void basicRfHdrBenchmark(basicRfHdrBench_t* pResult)
+{
+  uint8 hdr[BASIC_RF_MAX_HDR_SIZE];
+  uint32 start;
+  uint32 elapsed;
+  uint16 round;
+
+  start = halRfMacTimerGet();
+  for (round = 0; round < HDR_BENCH_ROUNDS; round++) {
+    basicRfBuildHeader(hdr, (uint16)round, NULL, BASIC_RF_MAX_PAYLOAD_SIZE, 0);
+  }
+  elapsed = (halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK;
+  pResult->buildCycles = (uint16)((elapsed * HDR_BENCH_CYCLES_PER_SYMBOL) / HDR_BENCH_ROUNDS);
+
+  start = halRfMacTimerGet();
+  for (round = 0; round < HDR_BENCH_ROUNDS; round++) {
+    basicRfHdrRefresh();
+  }
+  elapsed = (halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK;
+  pResult->refreshCycles = (uint16)((elapsed * HDR_BENCH_CYCLES_PER_SYMBOL) / HDR_BENCH_ROUNDS);
+}
+#endif
+
+
+#ifdef BASIC_RF_TX_BENCHMARK
+/**************************************************************************//**
+* @brief    TX done callback of the benchmark packets
+*
+* @param    seqNumber       Sequence number of the packet
+* @param    result          BASIC_RF_TX_* result
+* @param    retries         Number of retransmissions
+*
+* @return   None
+******************************************************************************/
+static void basicRfTxBenchDone(uint8 seqNumber, uint8 result, uint8 retries)
+{
+  (void)seqNumber;
+  (void)retries;
+
+  if (result != BASIC_RF_TX_SENT) {
+    txBenchFailed++;
+  }
+  txBenchDone++;
+}
+
+
+/**************************************************************************//**
+* @brief    Measures the sustained packet rate through the TX queue. Sends
+*           TX_BENCH_PACKETS broadcast packets while keeping at most
+*           \e depth of them queued, the one on the air included. The
+*           application is modelled as a main loop that is busy for
+*           \e appPeriod symbols between visits and tops up the queue on
+*           each visit. With a depth of 1 every packet waits for the next
+*           visit, as with the old single TX buffer. With a deeper queue the
+*           next packet is loaded from the TX done interrupt. Must be called
+*           after basicRfInit() with no other packets queued.
+*
+* @param    depth           Packets queued at most, 1-BASIC_RF_TX_QUEUE_SIZE
+* @param    payloadLength   Payload length, at most BASIC_RF_MAX_PAYLOAD_SIZE
+* @param    appPeriod       Time between main loop visits, symbols
+* @param    pResult         Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS, or FAILED if a parameter is out of range
+******************************************************************************/
+uint8 basicRfTxBenchmark(uint8 depth, uint8 payloadLength, uint16 appPeriod,
+                         basicRfTxBench_t* pResult)
+{
+  uint8 payload[BASIC_RF_MAX_PAYLOAD_SIZE];
+  uint32 start;
+  uint32 lastVisit;
+  uint32 now;
+  uint32 elapsed;
+  uint16 queued;
+
+  if (depth == 0 || depth > BASIC_RF_TX_QUEUE_SIZE ||
+      payloadLength > BASIC_RF_MAX_PAYLOAD_SIZE) {
+    return FAILED;
+  }
+  memset(payload, 0x55, payloadLength);
+
+  txBenchDone = 0;
+  txBenchFailed = 0;
+  queued = 0;
+  start = halRfMacTimerGet();
+  lastVisit = start;
+
+  while (txBenchDone < TX_BENCH_PACKETS) {
+    now = halRfMacTimerGet();
+    if (((now - lastVisit) & HAL_RF_MAC_TIMER_MASK) < appPeriod) {
+      continue;
+    }
+    lastVisit = now;
+
+    while (queued < TX_BENCH_PACKETS && queued - txBenchDone < depth) {
+      if (basicRfSendPacketAsync(BASIC_RF_BROADCAST_ADDR, payload,
+                                 payloadLength, BASIC_RF_TX_PRIO_BULK,
+                                 basicRfTxBenchDone) != SUCCESS) {
+        break;
+      }
+      queued++;
+    }
+  }
+  elapsed = (halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK;
+
+  pResult->usPerPacket = (elapsed * TX_BENCH_US_PER_SYMBOL) / TX_BENCH_PACKETS;
+  pResult->packetsPerSec = (uint16)(1000000UL / pResult->usPerPacket);
+  pResult->failed = txBenchFailed;
+
+  return SUCCESS;
 }
+#endif
 
 
 /**************************************************************************//**
@@ -13,9 +13,34 @@
 //!             - Association, scanning nor beacons are not implemented
 //!             - No defined coordinator/device roles (peer-to-peer, all nodes
 //!               are equal)
-//!             - Waits for the channel to become ready, but does not check CCA
-//!               twice (802.15.4 CSMA-CA)
-//!             - Does not retransmit packets
+//!             - Accesses the channel with 802.15.4 unslotted CSMA-CA
+//!             - Retransmits unacknowledged packets up to maxFrameRetries
+//!               times (802.15.4 macMaxFrameRetries) after a random backoff
+//!             - Drops duplicate packets per sender and keeps link-quality
+//!               statistics per neighbour, see basic_rf_nbr.h
+//!             - Optional CCM* security with a network key and per-sender
+//!               replay protection (build with SECURITY_CCM), see
+//!               basic_rf_sec.h
+//!             - Indirect transmission to sleeping end devices, which poll
+//!               their parent with 802.15.4 data requests
+//!             - Optional low power listening: receivers check the channel
+//!               periodically and senders repeat packets until they are
+//!               acknowledged
+//!             - Optional time-slotted channel hopping, see basic_rf_tsch.h
+//!             - Energy detect channel scan and automatic channel selection
+//!               (channel = BASIC_RF_CHANNEL_AUTO), see basic_rf_scan.h
+//!             - Optional aggregation of small messages into one packet, see
+//!               basic_rf_agg.h
+//!             - Optional per-destination TX power control
+//!               (txPowerControl), see basic_rf_tpc.h
+//!             - Optional automatic LNA gain switching on CC2591/CC2592
+//!               modules (lnaAgc), see basicRfGetAgcReport()
+//!             - Received frames are parsed by a table-driven IEEE 802.15.4
+//!               frame codec that also runs on a host PC, see
+//!               basic_rf_frame.h
+//!             - Promiscuous sniffer mode that streams every received frame
+//!               to a host for conversion to a .pcap file, see
+//!               basic_rf_sniffer.h
 //!
 //!             INSTRUCTIONS:
 //!             Startup:
@@ -25,11 +50,67 @@
 //!             Transmission:
 //!             1. Create a buffer with the payload to send
 //!             2. Call basicRfSendPacket()
+//!             or, without blocking until the packet is sent/acknowledged:
+//!             2. Call basicRfSendPacketAsync(). The packet is put in a TX
+//!                queue of BASIC_RF_TX_QUEUE_SIZE packets and the result is
+//!                reported to the supplied callback from interrupt context.
+//!                Queued packets are sent back-to-back, control priority
+//!                packets before bulk priority packets.
+//!             Packets sent to BASIC_RF_BROADCAST_ADDR are received by all
+//!             nodes and never acknowledged.
+//!             or, to send one packet to a group of nodes:
+//!             2. Call basicRfSendMulticast(). Receiving nodes must have
+//!                called basicRfJoinGroup().
+//!             or, to a node known only by its 64-bit extended address:
+//!             2. Call basicRfSendPacketExt()
+//!             or, for a payload spread over several buffers:
+//!             2. Call basicRfSendPacketV() with a list of segments. They are
+//!                written to the radio without being copied first.
+//!             or, to a sleeping end device:
+//!             2. Call basicRfSendIndirect(). The packet is held until the
+//!                end device polls for it.
+//!             Define BASIC_RF_TX_BENCHMARK to include basicRfTxBenchmark(),
+//!             which measures the packet rate for a given queue depth.
+//!             tools/basic_rf/tx_bench.c runs it on a host PC against a
+//!             model of the radio.
 //!
 //!             Reception:
 //!             1. Check if a packet is ready to be received by highger layer
 //!                with basicRfPacketIsReady()
 //!             2. Call basicRfReceive() to receive the packet by higher layer
+//!             or, without copying the packet:
+//!             2. Call basicRfRxBorrow() to get a pointer to the packet and
+//!                basicRfRxRelease() when done with it
+//!             Received packets are buffered in a queue of
+//!             BASIC_RF_RX_QUEUE_SIZE packets and are delivered in the order
+//!             they were received. Packets arriving while the queue is full
+//!             are dropped and counted (see basicRfGetStats()). The queue is
+//!             in basic_rf_rxq.c, whose host build simulates how many
+//!             back-to-back packets survive a given drain latency.
+//!
+//!             Sleepy end devices:
+//!             1. Call basicRfReceiveOff() to keep the receiver off
+//!             2. Call basicRfPoll() periodically to fetch packets held by
+//!                the parent, and again while it reports more packets
+//!             The receiver is only on while a packet is sent or a poll is
+//!             answered, typically well below 1% of the time.
+//!
+//!             Low power listening (all nodes):
+//!             1. Set wakeInterval in basicRfCfg_t before basicRfInit()
+//!             2. Call basicRfLplSleep() from the main loop when idle. It
+//!                checks the channel every wakeInterval and keeps the MCU in
+//!                PM2 and the radio off in between.
+//!             Packets are repeated for up to one wake interval, so
+//!             throughput drops and latency grows with the interval. Use
+//!             basicRfGetRadioReport() to see the radio on time and the
+//!             estimated average current.
+//!
+//!             Address changes:
+//!             Call basicRfSetAddress() rather than changing panId or myAddr
+//!             in basicRfCfg_t. The configuration dependent part of the
+//!             frame header is built once and only refreshed then. Define
+//!             BASIC_RF_HDR_BENCHMARK to include basicRfHdrBenchmark(),
+//!             which measures the header build cost.
 //!
 //!             FRAME FORMATS:
 //!             Data packets (without security):
@@ -37,6 +118,26 @@
 //!             [Sequence number (1)][PAN ID (2)][Dest. address (2)][Source address (2)]
 //!             [Payload (Length - 2+1+2+2+2)][Frame check sequence (2)]
 //!
+//!             Broadcast and multicast packets (destination address 0xFFFF):
+//!             [...][Source address (2)][Group address (2)][Payload]
+//!             [Frame check sequence (2)]
+//!             The group address is 0xFFFF for plain broadcast packets.
+//!
+//!             Either address may be an 8 byte extended address instead, as
+//!             flagged by the addressing modes in the frame control field.
+//!             The source PAN ID is always compressed when sending. Received
+//!             packets with a source PAN ID are accepted.
+//!
+//!             Secured packets (SECURITY_CCM):
+//!             [...][Source address (2)][Security control (1)]
+//!             [Frame counter (4)][Payload][MIC (8)][Frame check sequence (2)]
+//!
+//!             Data request command packets (sent by basicRfPoll()):
+//!             [...][Source address (2)][Command identifier = 0x04 (1)]
+//!             [Frame check sequence (2)]
+//!             With SECURITY_CCM the command identifier is authenticated but
+//!             not encrypted.
+//!
 //!             Acknowledgment packets:
 //!             [Preambles (4)][SFD (1)][Length = 5 (1)][Frame control field (2)]
 //!             [Sequence number (1)][Frame check sequence (2)]
@@ -85,6 +186,111 @@
 #include "hal_defs.h"
 
 
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Largest payload of a single packet: 127 bytes minus the frame overhead
+// (11), the auxiliary security header (5) and the MIC (8). Use
+// basic_rf_frag.h for larger payloads.
+#define BASIC_RF_MAX_PAYLOAD_SIZE           103
+
+// Length of an IEEE 802.15.4 extended address
+#define BASIC_RF_EXT_ADDR_SIZE              8
+
+// Short address value meaning "no short address, use the extended address".
+// Used for myAddr and for the source address of received packets.
+#define BASIC_RF_ADDR_USE_EXT               0xFFFE
+
+// basicRfCfg_t channel value: pick the quietest channel at basicRfInit()
+// with an energy detect scan, see basic_rf_scan.h
+#define BASIC_RF_CHANNEL_AUTO               0
+
+// Broadcast short address. Packets sent to it are never acknowledged.
+#define BASIC_RF_BROADCAST_ADDR             0xFFFF
+
+// Broadcast packets carry the group address in front of the payload
+#define BASIC_RF_GROUP_HDR_SIZE             2
+#define BASIC_RF_MAX_BCAST_PAYLOAD_SIZE     (BASIC_RF_MAX_PAYLOAD_SIZE - \
+                                             BASIC_RF_GROUP_HDR_SIZE)
+
+// Number of multicast groups a node can be a member of
+#ifndef BASIC_RF_GROUP_TABLE_SIZE
+#define BASIC_RF_GROUP_TABLE_SIZE           4
+#endif
+
+// Number of received packets that can be buffered until they are read by
+// basicRfReceive() or released after basicRfRxBorrow(). Must be a power of 2
+// and not larger than 128.
+#ifndef BASIC_RF_RX_QUEUE_SIZE
+#define BASIC_RF_RX_QUEUE_SIZE              4
+#endif
+
+// Number of packets that can be queued for transmission, including the one
+// being transmitted. Must not be larger than 254.
+#ifndef BASIC_RF_TX_QUEUE_SIZE
+#define BASIC_RF_TX_QUEUE_SIZE              4
+#endif
+
+// TX priority classes
+#define BASIC_RF_TX_PRIO_CONTROL            0   // Control, latency critical
+#define BASIC_RF_TX_PRIO_BULK               1   // Bulk data
+#define BASIC_RF_TX_PRIO_LEVELS             2
+
+// Number of sleeping children that can have packets held by
+// basicRfSendIndirect() at a time, at most 24
+#ifndef BASIC_RF_INDIRECT_CHILDREN
+#define BASIC_RF_INDIRECT_CHILDREN          8
+#endif
+
+// Time a packet is held for a sleeping child, in symbols (7.68 s)
+#ifndef BASIC_RF_INDIRECT_TIMEOUT
+#define BASIC_RF_INDIRECT_TIMEOUT           480000UL
+#endif
+
+// Automatic LNA gain switching (lnaAgc). The LNA goes to low gain on a
+// frame at or above the LGM threshold, and back to high gain after
+// BASIC_RF_AGC_HGM_FRAMES frames in a row below the HGM threshold, or when
+// no frame has been at or above the HGM threshold for the LGM timeout.
+// The gap between the thresholds keeps the gain from toggling on signals
+// near the switch point. Levels in dBm as reported after the switch.
+#ifndef BASIC_RF_AGC_LGM_THRESHOLD
+#define BASIC_RF_AGC_LGM_THRESHOLD          (-35)
+#endif
+#ifndef BASIC_RF_AGC_HGM_THRESHOLD
+#define BASIC_RF_AGC_HGM_THRESHOLD          (-50)
+#endif
+#ifndef BASIC_RF_AGC_HGM_FRAMES
+#define BASIC_RF_AGC_HGM_FRAMES             8
+#endif
+// In symbols (5 s)
+#ifndef BASIC_RF_AGC_LGM_TIMEOUT
+#define BASIC_RF_AGC_LGM_TIMEOUT            312500UL
+#endif
+
+// basicRfSendPacket() return value in addition to SUCCESS and FAILED
+#define BASIC_RF_CHANNEL_ACCESS_FAILURE     2
+
+// Currents used by basicRfGetRadioReport(), in uA: radio on (CC2538 RX)
+// and MCU in PM2
+#ifndef BASIC_RF_RADIO_ON_CURRENT
+#define BASIC_RF_RADIO_ON_CURRENT           20000
+#endif
+#ifndef BASIC_RF_SLEEP_CURRENT
+#define BASIC_RF_SLEEP_CURRENT              2
+#endif
+
+// basicRfPoll() return value: the parent holds no packets
+#define BASIC_RF_POLL_NO_DATA               3
+
+// TX results reported to the TX done callback
+#define BASIC_RF_TX_SENT                    0   // Sent, no ACK requested
+#define BASIC_RF_TX_ACKED                   1   // Sent and acknowledged
+#define BASIC_RF_TX_NO_ACK                  2   // Sent, but not acknowledged
+#define BASIC_RF_TX_CHANNEL_BUSY            3   // Could not access the channel
+#define BASIC_RF_TX_EXPIRED                 4   // Indirect, child did not poll
+#define BASIC_RF_TX_ABORTED                 5   // Ended by basicRfTxAbort()
+
+
 /******************************************************************************
 * TYPEDEFS
 */
@@ -94,23 +300,147 @@ typedef struct {
     uint16 panId;
     uint8 channel;
     uint8 ackRequest;
+    uint8 maxFrameRetries;      // Retransmissions if no ACK, 0 to disable
+    uint8* extAddr;             // Extended address, LSB first, or NULL
+    uint16 wakeInterval;        // Low power listening channel check interval
+                                // in 32 kHz periods, 0 for always-on RX
+    uint8 txPowerControl;       // TRUE: lowest sufficient TX power per
+                                // destination, see basic_rf_tpc.h
+    uint8 lnaAgc;               // TRUE: automatic LNA gain switching, with
+                                // CC2591/CC2592 modules only
     #ifdef SECURITY_CCM
-    uint8* securityKey;
-    uint8* securityNonce;
+    uint8* securityKey;         // Network key, 16 bytes
+    uint8* securityNonce;       // Network nonce prefix, 4 bytes
     #endif
 } basicRfCfg_t;
 
+// TX done callback. Called from interrupt context with the sequence number
+// of the packet, one of the BASIC_RF_TX_* results and the number of
+// retransmissions that were needed.
+typedef void (*basicRfTxDoneCb_t)(uint8 seqNumber, uint8 result, uint8 retries);
+
+// Received packet, lent to the application by basicRfRxBorrow()
+typedef struct {
+    uint8* pPayload;            // Payload, valid until the packet is released
+    uint8 length;               // Payload length
+    uint8 seqNumber;
+    uint16 dstAddr;             // This node, BASIC_RF_BROADCAST_ADDR or group
+    uint16 srcAddr;             // BASIC_RF_ADDR_USE_EXT: see srcExtAddr
+    uint16 srcPanId;
+    int8 rssi;                  // RSSI in dBm
+    uint8 lqi;                  // Correlation value, 0-127
+    uint32 timestamp;           // MAC timer (symbols) when the packet was read
+    uint8 framePending;         // Sender holds more packets for this node
+    uint8 srcExtAddr[BASIC_RF_EXT_ADDR_SIZE];
+} basicRfRxFrame_t;
+
+// Payload segment for basicRfSendPacketV()
+typedef struct {
+    uint8* pData;
+    uint8 length;
+} basicRfTxSeg_t;
+
+// Statistics counters
+typedef struct {
+    uint32 rxPackets;           // Packets put in the RX queue
+    uint32 rxQueueOverflow;     // Packets dropped because the RX queue was full
+    uint32 rxFifoOverflow;      // Radio RX FIFO overflows
+    uint32 rxDuplicates;        // Duplicate packets suppressed
+    uint32 rxGroupFiltered;     // Packets for groups this node is not in
+    uint32 rxSecFailures;       // Packets failing the security check
+    uint32 rxReplays;           // Secured packets with an old frame counter
+    uint32 txPackets;           // Packets sent (acknowledged if requested)
+    uint32 txRetries;           // Retransmissions
+    uint32 txNoAck;             // Packets not acknowledged after all retries
+    uint32 txChannelBusy;       // Packets not sent due to busy channel
+    uint32 txIndirectExpired;   // Held packets the child did not poll for
+} basicRfStats_t;
+
+// Radio on-time report, see basicRfGetRadioReport(). Reset together with
+// the statistics counters.
+typedef struct {
+    uint32 elapsedTicks;        // 32 kHz periods since the last reset
+    uint32 radioOnTicks;        // Periods with the radio on
+    uint16 dutyCycle;           // Radio on time in 0.01 %
+    uint32 avgCurrent;          // Estimated average radio current in uA
+    uint32 channelChecks;       // Low power listening channel checks
+    uint32 channelBusy;         // Checks that found the channel busy
+    uint32 txStrobes;           // Repeated frames sent for LPL receivers
+} basicRfRadioReport_t;
+
+// Header build cost in CPU cycles, see basicRfHdrBenchmark()
+typedef struct {
+    uint16 buildCycles;         // Header of one frame, from the template
+    uint16 refreshCycles;       // Header template, after a config change
+} basicRfHdrBench_t;
+
+// TX queue throughput, see basicRfTxBenchmark()
+typedef struct {
+    uint16 packetsPerSec;       // Sustained packets per second
+    uint32 usPerPacket;         // Average time per packet, us
+    uint16 failed;              // Packets not sent, e.g. channel busy
+} basicRfTxBench_t;
+
+// LNA gain switching report, see basicRfGetAgcReport(). The per mode
+// counters are indexed by HAL_RF_GAIN_LOW and HAL_RF_GAIN_HIGH. Reset
+// together with the statistics counters.
+typedef struct {
+    uint8 gain;                 // Current gain, HAL_RF_GAIN_*
+    uint32 toLowGain;           // Switches from high to low gain
+    uint32 toHighGain;          // Switches from low to high gain
+    uint32 rxFrames[2];         // Data frames received, CRC OK or not
+    uint32 rxErrors[2];         // Data frames with CRC errors
+    uint32 rxLost[2];           // Frames missing from neighbour sequences
+    uint16 per[2];              // Packet error rate in 0.01 %
+} basicRfAgcReport_t;
+
 
 /******************************************************************************
 * GLOBAL FUNCTIONS
 */
 uint8 basicRfInit(basicRfCfg_t* pRfConfig);
 uint8 basicRfSendPacket(uint16 destAddr, uint8* pPayload, uint8 length);
+uint8 basicRfSendPacketAsync(uint16 destAddr, uint8* pPayload, uint8 length,
+                             uint8 priority, basicRfTxDoneCb_t pfTxDone);
+uint8 basicRfSendPacketExt(const uint8* pDestExtAddr, uint8* pPayload,
+                           uint8 length, uint8 priority,
+                           basicRfTxDoneCb_t pfTxDone);
+uint8 basicRfSendPacketV(uint16 destAddr, const basicRfTxSeg_t* pSegs,
+                         uint8 nSegs);
+uint8 basicRfSendPacketOnce(uint16 destAddr, uint8* pPayload, uint8 length,
+                            basicRfTxDoneCb_t pfTxDone);
+uint8 basicRfSendMulticast(uint16 groupAddr, uint8* pPayload, uint8 length,
+                           uint8 priority, basicRfTxDoneCb_t pfTxDone);
+uint8 basicRfSendIndirect(uint16 destAddr, uint8* pPayload, uint8 length,
+                          basicRfTxDoneCb_t pfTxDone);
+uint8 basicRfPoll(uint16 parentAddr, uint8* pMore);
+uint8 basicRfJoinGroup(uint16 groupAddr);
+void basicRfLeaveGroup(uint16 groupAddr);
+uint8 basicRfTxIsBusy(void);
+void basicRfTxAbort(void);
+uint8 basicRfGetTxRetries(void);
 uint8 basicRfPacketIsReady(void);
 int8   basicRfGetRssi(void);
 uint8 basicRfReceive(uint8* pRxData, uint8 len, int16* pRssi);
+basicRfRxFrame_t* basicRfRxBorrow(void);
+void basicRfRxRelease(basicRfRxFrame_t* pFrame);
 void basicRfReceiveOn(void);
 void basicRfReceiveOff(void);
+void basicRfSetChannel(uint8 channel);
+uint8 basicRfGetChannel(void);
+uint8 basicRfSetAddress(uint16 panId, uint16 myAddr);
+uint8 basicRfLplSleep(void);
+void basicRfGetRadioReport(basicRfRadioReport_t* pReport);
+void basicRfGetAgcReport(basicRfAgcReport_t* pReport);
+void basicRfGetStats(basicRfStats_t* pStats);
+void basicRfResetStats(void);
+#ifdef BASIC_RF_HDR_BENCHMARK
+void basicRfHdrBenchmark(basicRfHdrBench_t* pResult);
+#endif
+#ifdef BASIC_RF_TX_BENCHMARK
+uint8 basicRfTxBenchmark(uint8 depth, uint8 payloadLength, uint16 appPeriod,
+                         basicRfTxBench_t* pResult);
+#endif
 
 
 #endif // #ifdef __BASIC_RF_H__
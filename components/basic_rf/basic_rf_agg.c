@@ -0,0 +1,350 @@
+//*****************************************************************************
+//! @file       basic_rf_agg.c
+//! @brief      Basic RF small message aggregation.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_rf.h"
+#include "basic_rf.h"
+#include "basic_rf_agg.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define AGG_DISPATCH                        0xD0
+
+// Dispatch byte and length prefix
+#define AGG_HDR_SIZE                        1
+#define AGG_PREFIX_SIZE                     1
+
+#if BASIC_RF_AGG_FLUSH_SIZE > BASIC_RF_AGG_FRAME_SIZE
+#error "BASIC_RF_AGG_FLUSH_SIZE must not exceed BASIC_RF_AGG_FRAME_SIZE"
+#endif
+
+// Time elapsed on the MAC timer since a time stamp
+#define AGG_ELAPSED(now, then)              (((now) - (then)) & HAL_RF_MAC_TIMER_MASK)
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Messages collected for one destination
+typedef struct
+{
+  uint8 length;                 // Bytes used, 0 if the buffer is free
+  uint16 destAddr;
+  uint32 start;                 // Time the first message was queued
+  uint8 data[BASIC_RF_AGG_FRAME_SIZE];
+} basicRfAggBuf_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static basicRfAggBuf_t aggBuf[BASIC_RF_AGG_DESTS];
+static basicRfAggStats_t aggStats;
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Queues the messages of a buffer as one packet and frees the
+*           buffer. The buffer is kept if the TX queue is full.
+*
+* @param    pBuf        Buffer to send
+*
+* @return   uint8 - SUCCESS, or FAILED if the TX queue is full
+******************************************************************************/
+static uint8 basicRfAggSendBuf(basicRfAggBuf_t* pBuf)
+{
+  if (basicRfSendPacketAsync(pBuf->destAddr, pBuf->data, pBuf->length,
+                             BASIC_RF_TX_PRIO_BULK, NULL) != SUCCESS) {
+    return FAILED;
+  }
+  aggStats.txPackets++;
+  pBuf->length = 0;
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Finds the buffer to queue a message for a destination in. A new
+*           buffer is taken if there is none for the destination yet, and
+*           if all are in use the one with the oldest message is sent first.
+*
+* @param    destAddr    Destination short address
+*
+* @return   basicRfAggBuf_t* - The buffer, or NULL if none could be freed
+******************************************************************************/
+static basicRfAggBuf_t* basicRfAggGetBuf(uint16 destAddr)
+{
+  basicRfAggBuf_t* pFree = NULL;
+  basicRfAggBuf_t* pOldest = NULL;
+  uint32 now = halRfMacTimerGet();
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_AGG_DESTS; i++) {
+    if (aggBuf[i].length == 0) {
+      if (pFree == NULL) {
+        pFree = &aggBuf[i];
+      }
+    } else if (aggBuf[i].destAddr == destAddr) {
+      return &aggBuf[i];
+    } else if (pOldest == NULL ||
+               AGG_ELAPSED(now, aggBuf[i].start) > AGG_ELAPSED(now, pOldest->start)) {
+      pOldest = &aggBuf[i];
+    }
+  }
+
+  if (pFree == NULL) {
+    if (basicRfAggSendBuf(pOldest) != SUCCESS) {
+      return NULL;
+    }
+    pFree = pOldest;
+  }
+
+  pFree->destAddr = destAddr;
+  pFree->start = now;
+  pFree->data[0] = AGG_DISPATCH;
+  pFree->length = AGG_HDR_SIZE;
+
+  return pFree;
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Initialises the aggregation layer
+*
+* @return   None
+******************************************************************************/
+void basicRfAggInit(void)
+{
+  memset(aggBuf, 0, sizeof(aggBuf));
+  memset(&aggStats, 0, sizeof(aggStats));
+}
+
+
+/**************************************************************************//**
+* @brief    Queues a message. It is sent together with the other messages
+*           for the same destination when the buffer is full or the deadline
+*           has passed. The message is copied.
+*
+* @param    destAddr    Destination short address or BASIC_RF_BROADCAST_ADDR
+* @param    pMsg        Message
+* @param    length      Message length, 1 to BASIC_RF_AGG_MAX_MSG_SIZE
+*
+* @return   uint8 - SUCCESS, or FAILED if the length is invalid or the
+*           buffers can not be sent because the TX queue is full
+******************************************************************************/
+uint8 basicRfAggSend(uint16 destAddr, uint8* pMsg, uint8 length)
+{
+  basicRfAggBuf_t* pBuf;
+
+  if (length == 0 || length > BASIC_RF_AGG_MAX_MSG_SIZE ||
+      destAddr == BASIC_RF_ADDR_USE_EXT) {
+    return FAILED;
+  }
+
+  pBuf = basicRfAggGetBuf(destAddr);
+  if (pBuf == NULL) {
+    return FAILED;
+  }
+
+  // Send what has been collected if the message does not fit
+  if (pBuf->length + AGG_PREFIX_SIZE + length > BASIC_RF_AGG_FRAME_SIZE) {
+    if (basicRfAggSendBuf(pBuf) != SUCCESS) {
+      return FAILED;
+    }
+    aggStats.txFlushSize++;
+    pBuf = basicRfAggGetBuf(destAddr);
+  }
+
+  pBuf->data[pBuf->length] = length;
+  memcpy(&pBuf->data[pBuf->length + AGG_PREFIX_SIZE], pMsg, length);
+  pBuf->length += AGG_PREFIX_SIZE + length;
+  aggStats.txMessages++;
+
+  // If the TX queue is full the buffer is sent by basicRfAggPoll()
+  if (pBuf->length >= BASIC_RF_AGG_FLUSH_SIZE &&
+      basicRfAggSendBuf(pBuf) == SUCCESS) {
+    aggStats.txFlushSize++;
+  }
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Sends all collected messages now, e.g. before sleeping
+*
+* @return   uint8 - SUCCESS, or FAILED if the TX queue is full. Buffers that
+*           could not be sent are kept.
+******************************************************************************/
+uint8 basicRfAggFlush(void)
+{
+  uint8 status = SUCCESS;
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_AGG_DESTS; i++) {
+    if (aggBuf[i].length != 0 && basicRfAggSendBuf(&aggBuf[i]) != SUCCESS) {
+      status = FAILED;
+    }
+  }
+  return status;
+}
+
+
+/**************************************************************************//**
+* @brief    Sends the buffers whose first message has waited
+*           BASIC_RF_AGG_DEADLINE. Call regularly from the main loop.
+*
+* @return   None
+******************************************************************************/
+void basicRfAggPoll(void)
+{
+  uint32 now = halRfMacTimerGet();
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_AGG_DESTS; i++) {
+    if (aggBuf[i].length != 0 &&
+        AGG_ELAPSED(now, aggBuf[i].start) >= BASIC_RF_AGG_DEADLINE &&
+        basicRfAggSendBuf(&aggBuf[i]) == SUCCESS) {
+      aggStats.txFlushDeadline++;
+    }
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Checks whether a received packet is an aggregated packet. If so,
+*           get its messages with basicRfAggNext(). A malformed packet is
+*           counted and yields no messages. The packet is not released.
+*
+* @param    pFrame      Packet from basicRfRxBorrow()
+*
+* @return   uint8 - TRUE if the packet is an aggregated packet
+******************************************************************************/
+uint8 basicRfAggInput(basicRfRxFrame_t* pFrame)
+{
+  uint8 offset;
+
+  if (pFrame->length < AGG_HDR_SIZE || pFrame->pPayload[0] != AGG_DISPATCH) {
+    return FALSE;
+  }
+  pFrame->pPayload += AGG_HDR_SIZE;
+  pFrame->length -= AGG_HDR_SIZE;
+
+  // All length prefixes must add up to the packet length
+  for (offset = 0; offset < pFrame->length;
+       offset += AGG_PREFIX_SIZE + pFrame->pPayload[offset]) {
+    if (pFrame->pPayload[offset] == 0 ||
+        pFrame->pPayload[offset] > pFrame->length - offset - AGG_PREFIX_SIZE) {
+      aggStats.rxMalformed++;
+      pFrame->length = 0;
+      return TRUE;
+    }
+  }
+  aggStats.rxPackets++;
+
+  return TRUE;
+}
+
+
+/**************************************************************************//**
+* @brief    Gets the next message of an aggregated packet accepted by
+*           basicRfAggInput(). The message stays in the packet, so it is
+*           valid until the packet is released.
+*
+* @param    pFrame      Packet from basicRfRxBorrow()
+* @param    ppMsg       Set to the message
+*
+* @return   uint8 - Message length, 0 when there are no more messages
+******************************************************************************/
+uint8 basicRfAggNext(basicRfRxFrame_t* pFrame, uint8** ppMsg)
+{
+  uint8 length;
+
+  if (pFrame->length == 0) {
+    return 0;
+  }
+
+  length = pFrame->pPayload[0];
+  *ppMsg = pFrame->pPayload + AGG_PREFIX_SIZE;
+  pFrame->pPayload += AGG_PREFIX_SIZE + length;
+  pFrame->length -= AGG_PREFIX_SIZE + length;
+  aggStats.rxMessages++;
+
+  return length;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the statistics counters, with the aggregation ratio
+*
+* @param    pStats      Pointer to struct to fill
+*
+* @return   None
+******************************************************************************/
+void basicRfAggGetStats(basicRfAggStats_t* pStats)
+{
+  *pStats = aggStats;
+  pStats->txRatio = aggStats.txPackets ?
+    (uint16)((aggStats.txMessages * 100) / aggStats.txPackets) : 0;
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
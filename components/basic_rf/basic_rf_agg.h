@@ -0,0 +1,132 @@
+//*****************************************************************************
+//! @file       basic_rf_agg.h
+//! @brief      Basic RF small message aggregation.
+//!
+//!             Packs short application messages for the same destination
+//!             into one Basic RF packet, so that a run of small readings
+//!             pays the preamble, SFD, MAC header, FCS and acknowledgment
+//!             only once. Messages are collected in up to
+//!             BASIC_RF_AGG_DESTS buffers, one per destination, and a buffer
+//!             is sent when it holds BASIC_RF_AGG_FLUSH_SIZE bytes, when the
+//!             next message does not fit, or when its first message has
+//!             waited BASIC_RF_AGG_DEADLINE. The receiver splits the packet
+//!             back into the messages.
+//!
+//!             Aggregated packets are ordinary Basic RF packets sent with
+//!             bulk priority whose first payload byte is 0xD0, so application
+//!             packets must not start with this byte.
+//!
+//!             INSTRUCTIONS:
+//!             1. Call basicRfAggInit() after basicRfInit().
+//!             2. Queue messages with basicRfAggSend().
+//!             3. Call basicRfAggPoll() regularly from the main loop. It
+//!                sends buffers whose deadline has passed.
+//!             4. Pass every packet from basicRfRxBorrow() to
+//!                basicRfAggInput(). For aggregated packets it returns TRUE;
+//!                then get the messages one by one with basicRfAggNext()
+//!                before releasing the packet.
+//!
+//!             PACKET FORMAT:
+//!             [0xD0][Length (1)][Message]...[Length (1)][Message]
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_AGG_H__
+#define __BASIC_RF_AGG_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "basic_rf.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Number of destinations messages can be collected for at the same time
+#ifndef BASIC_RF_AGG_DESTS
+#define BASIC_RF_AGG_DESTS                  2
+#endif
+
+// Largest aggregated packet payload. The default fits broadcasts; nodes
+// using an extended address must lower it by BASIC_RF_EXT_ADDR_SIZE - 2.
+#ifndef BASIC_RF_AGG_FRAME_SIZE
+#define BASIC_RF_AGG_FRAME_SIZE             BASIC_RF_MAX_BCAST_PAYLOAD_SIZE
+#endif
+
+// A buffer is sent as soon as it holds this many bytes
+#ifndef BASIC_RF_AGG_FLUSH_SIZE
+#define BASIC_RF_AGG_FLUSH_SIZE             80
+#endif
+
+// Longest time a message waits for others, in symbols (3125 symbols = 50 ms)
+#ifndef BASIC_RF_AGG_DEADLINE
+#define BASIC_RF_AGG_DEADLINE               3125UL
+#endif
+
+// Longest message
+#define BASIC_RF_AGG_MAX_MSG_SIZE           (BASIC_RF_AGG_FRAME_SIZE - 2)
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Statistics counters
+typedef struct {
+    uint32 txMessages;          // Messages queued
+    uint32 txPackets;           // Aggregated packets queued for transmission
+    uint32 txFlushSize;         // Packets sent because they were full
+    uint32 txFlushDeadline;     // Packets sent because of the deadline
+    uint16 txRatio;             // Messages per packet, in 1/100
+    uint32 rxPackets;           // Aggregated packets received
+    uint32 rxMessages;          // Messages delivered
+    uint32 rxMalformed;         // Packets with a bad length prefix
+} basicRfAggStats_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+void basicRfAggInit(void);
+uint8 basicRfAggSend(uint16 destAddr, uint8* pMsg, uint8 length);
+uint8 basicRfAggFlush(void);
+void basicRfAggPoll(void);
+uint8 basicRfAggInput(basicRfRxFrame_t* pFrame);
+uint8 basicRfAggNext(basicRfRxFrame_t* pFrame, uint8** ppMsg);
+void basicRfAggGetStats(basicRfAggStats_t* pStats);
+
+
+#endif // #ifdef __BASIC_RF_AGG_H__
@@ -0,0 +1,632 @@
+//*****************************************************************************
+//! @file       basic_rf_frag.c
+//! @brief      Basic RF fragmentation and reassembly.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_int.h"
+#include "hal_rf.h"
+#include "basic_rf.h"
+#include "basic_rf_frag.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// First payload byte
+#define FRAG_DISPATCH_MASK                  0xF0
+#define FRAG_DISPATCH                       0xC0
+#define FRAG_TYPE_DATA                      0xC0
+#define FRAG_TYPE_DATA_ACKREQ               0xC1    // Receiver must send SACK
+#define FRAG_TYPE_SACK                      0xC8
+
+#define FRAG_BITMAP_SIZE                    (BASIC_RF_FRAG_MAX_COUNT / 8)
+#define FRAG_SACK_SIZE(count)               (3 + ((count) + 7) / 8)
+
+// Sender states
+#define FRAG_TX_IDLE                        0
+#define FRAG_TX_SENDING                     1   // Queueing missing fragments
+#define FRAG_TX_WAIT_SACK                   2   // Waiting for the SACK
+#define FRAG_TX_DONE                        3
+#define FRAG_TX_FAILED                      4
+
+// Reassembly buffer states
+#define FRAG_RX_FREE                        0
+#define FRAG_RX_ASSEMBLING                  1
+#define FRAG_RX_COMPLETE                    2   // Waiting to be read
+#define FRAG_RX_READ                        3   // Read, kept to answer SACK
+                                                // requests until it times
+                                                // out, may be reused
+
+#if BASIC_RF_FRAG_MAX_DATAGRAM > (BASIC_RF_FRAG_MAX_COUNT * BASIC_RF_FRAG_DATA_SIZE)
+#error "BASIC_RF_FRAG_MAX_DATAGRAM needs more than BASIC_RF_FRAG_MAX_COUNT fragments"
+#endif
+
+// Time elapsed on the MAC timer since a time stamp
+#define FRAG_ELAPSED(now, then)             (((now) - (then)) & HAL_RF_MAC_TIMER_MASK)
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Sender state
+typedef struct
+{
+  volatile uint8 state;         // FRAG_TX_*
+  uint8 tag;                    // Datagram tag, incremented per datagram
+  uint8 count;                  // Number of fragments
+  uint8 next;                   // Next fragment to consider in this round
+  uint8 last;                   // Last missing fragment, requests the SACK
+  uint8 rounds;                 // Rounds of transmissions started
+  volatile uint8 sackWait;      // SACK timer is running
+  uint16 destAddr;
+  uint16 length;
+  uint8* pData;
+  volatile uint32 sackStart;    // Time the SACK request was sent
+  uint8 acked[FRAG_BITMAP_SIZE];
+} basicRfFragTx_t;
+
+// Reassembly buffer
+typedef struct
+{
+  uint8 state;                  // FRAG_RX_*
+  uint8 tag;
+  uint8 count;
+  uint8 order;                  // Completion order, oldest is read first
+  uint16 srcAddr;
+  uint16 length;
+  uint32 lastRx;                // Time the last fragment or, once read,
+                                // SACK request was received
+  uint8 received[FRAG_BITMAP_SIZE];
+  uint8 data[BASIC_RF_FRAG_MAX_DATAGRAM];
+} basicRfFragRx_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static basicRfFragTx_t fragTx;
+static basicRfFragRx_t fragRx[BASIC_RF_FRAG_POOL_SIZE];
+static uint8 fragRxOrder;
+static basicRfFragStats_t fragStats;
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Returns the number of fragments needed for a datagram
+*
+* @param    length      Datagram length
+*
+* @return   uint8 - Number of fragments
+******************************************************************************/
+static uint8 basicRfFragCount(uint16 length)
+{
+  return (uint8)((length + BASIC_RF_FRAG_DATA_SIZE - 1) / BASIC_RF_FRAG_DATA_SIZE);
+}
+
+
+/**************************************************************************//**
+* @brief    Checks if all of the first \e count bits in a bitmap are set
+*
+* @param    pBitmap     Bitmap
+* @param    count       Number of bits
+*
+* @return   uint8 - TRUE if all bits are set
+******************************************************************************/
+static uint8 basicRfFragAllSet(const uint8* pBitmap, uint8 count)
+{
+  uint8 i;
+
+  for (i = 0; i < count; i++) {
+    if (!(pBitmap[i >> 3] & BV(i & 7))) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+/**************************************************************************//**
+* @brief    TX done callback for the fragment that requests the SACK. Starts
+*           the SACK timer once the fragment has actually been sent.
+*
+* @param    seqNumber       Sequence number of the packet
+* @param    result          BASIC_RF_TX_* result
+* @param    retries         Number of retransmissions
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragSackReqDone(uint8 seqNumber, uint8 result, uint8 retries)
+{
+  (void)seqNumber;
+  (void)result;
+  (void)retries;
+
+  fragTx.sackStart = halRfMacTimerGet();
+  fragTx.sackWait = TRUE;
+}
+
+
+/**************************************************************************//**
+* @brief    Starts a round of transmissions of the fragments that have not
+*           been acknowledged, or fails the transfer if there have been
+*           BASIC_RF_FRAG_MAX_ROUNDS rounds
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragStartRound(void)
+{
+  uint8 i;
+
+  if (fragTx.rounds >= BASIC_RF_FRAG_MAX_ROUNDS) {
+    fragTx.state = FRAG_TX_FAILED;
+    fragStats.txFailed++;
+    return;
+  }
+  fragTx.rounds++;
+
+  for (i = 0; i < fragTx.count; i++) {
+    if (!(fragTx.acked[i >> 3] & BV(i & 7))) {
+      fragTx.last = i;
+    }
+  }
+  fragTx.next = 0;
+  fragTx.sackWait = FALSE;
+  fragTx.state = FRAG_TX_SENDING;
+}
+
+
+/**************************************************************************//**
+* @brief    Queues as many missing fragments of the current round as the
+*           Basic RF TX queue accepts
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragSendFragments(void)
+{
+  uint8 buf[BASIC_RF_MAX_PAYLOAD_SIZE];
+  uint16 offset;
+  uint8 length;
+  uint8 i;
+
+  while (fragTx.next <= fragTx.last) {
+    i = fragTx.next;
+    if (fragTx.acked[i >> 3] & BV(i & 7)) {
+      fragTx.next++;
+      continue;
+    }
+
+    offset = (uint16)i * BASIC_RF_FRAG_DATA_SIZE;
+    length = (uint8)MIN(fragTx.length - offset, BASIC_RF_FRAG_DATA_SIZE);
+    buf[0] = (i == fragTx.last) ? FRAG_TYPE_DATA_ACKREQ : FRAG_TYPE_DATA;
+    buf[1] = fragTx.tag;
+    buf[2] = i;
+    buf[3] = fragTx.count;
+    buf[4] = LO_UINT16(fragTx.length);
+    buf[5] = HI_UINT16(fragTx.length);
+    memcpy(&buf[BASIC_RF_FRAG_HDR_SIZE], &fragTx.pData[offset], length);
+
+    if (basicRfSendPacketAsync(fragTx.destAddr, buf,
+                               BASIC_RF_FRAG_HDR_SIZE + length,
+                               BASIC_RF_TX_PRIO_BULK,
+                               (i == fragTx.last) ? basicRfFragSackReqDone : NULL)
+        != SUCCESS) {
+      // TX queue full, continue on the next poll
+      return;
+    }
+    fragStats.txFragments++;
+    if (fragTx.rounds > 1) {
+      fragStats.txResent++;
+    }
+    fragTx.next++;
+  }
+
+  fragTx.state = FRAG_TX_WAIT_SACK;
+}
+
+
+/**************************************************************************//**
+* @brief    Handles a SACK from the receiver of the current transfer
+*
+* @param    pFrame      Received SACK
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragSackInput(const basicRfRxFrame_t* pFrame)
+{
+  const uint8 *pPayload = pFrame->pPayload;
+  uint8 i;
+
+  if ((fragTx.state != FRAG_TX_SENDING && fragTx.state != FRAG_TX_WAIT_SACK) ||
+      pFrame->srcAddr != fragTx.destAddr || pPayload[1] != fragTx.tag ||
+      pPayload[2] != fragTx.count ||
+      pFrame->length < FRAG_SACK_SIZE(fragTx.count)) {
+    return;
+  }
+
+  for (i = 0; i < (fragTx.count + 7) / 8; i++) {
+    fragTx.acked[i] |= pPayload[3 + i];
+  }
+
+  if (basicRfFragAllSet(fragTx.acked, fragTx.count)) {
+    fragTx.state = FRAG_TX_DONE;
+    fragStats.txDatagrams++;
+  } else if (fragTx.state == FRAG_TX_WAIT_SACK) {
+    basicRfFragStartRound();
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Sends a SACK for a reassembly buffer
+*
+* @param    pRx         Reassembly buffer
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragSendSack(const basicRfFragRx_t* pRx)
+{
+  uint8 buf[FRAG_SACK_SIZE(BASIC_RF_FRAG_MAX_COUNT)];
+
+  buf[0] = FRAG_TYPE_SACK;
+  buf[1] = pRx->tag;
+  buf[2] = pRx->count;
+  memcpy(&buf[3], pRx->received, (pRx->count + 7) / 8);
+
+  // The sender will ask again if this is lost
+  basicRfSendPacketAsync(pRx->srcAddr, buf, FRAG_SACK_SIZE(pRx->count),
+                         BASIC_RF_TX_PRIO_CONTROL, NULL);
+}
+
+
+/**************************************************************************//**
+* @brief    Finds the reassembly buffer of a datagram, or a buffer to use for
+*           it. Free buffers are preferred over buffers that have been read,
+*           and of those the one read first is reused. Buffers that have
+*           been read and timed out are freed here, so that a new datagram
+*           with the same tag is not taken for the old one. basicRfFragPoll()
+*           frees the buffers that time out as well.
+*
+* @param    srcAddr     Source short address
+* @param    tag         Datagram tag
+* @param    now         Time the fragment was received
+*
+* @return   basicRfFragRx_t* - Reassembly buffer, NULL if none is available
+******************************************************************************/
+static basicRfFragRx_t* basicRfFragRxFind(uint16 srcAddr, uint8 tag, uint32 now)
+{
+  basicRfFragRx_t *pFree = NULL;
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_FRAG_POOL_SIZE; i++) {
+    basicRfFragRx_t *pRx = &fragRx[i];
+
+    if (pRx->state == FRAG_RX_READ &&
+        FRAG_ELAPSED(now, pRx->lastRx) > BASIC_RF_FRAG_READ_TIMEOUT) {
+      pRx->state = FRAG_RX_FREE;
+    }
+    if (pRx->state != FRAG_RX_FREE && pRx->srcAddr == srcAddr && pRx->tag == tag) {
+      return pRx;
+    }
+    if (pRx->state == FRAG_RX_FREE) {
+      if (pFree == NULL || pFree->state != FRAG_RX_FREE) {
+        pFree = pRx;
+      }
+    } else if (pRx->state == FRAG_RX_READ &&
+               (pFree == NULL || (pFree->state == FRAG_RX_READ &&
+                                  (int8)(pRx->order - pFree->order) < 0))) {
+      pFree = pRx;
+    }
+  }
+  return pFree;
+}
+
+
+/**************************************************************************//**
+* @brief    Handles a data fragment
+*
+* @param    pFrame      Received fragment
+*
+* @return   None
+******************************************************************************/
+static void basicRfFragDataInput(const basicRfRxFrame_t* pFrame)
+{
+  const uint8 *pPayload = pFrame->pPayload;
+  basicRfFragRx_t *pRx;
+  uint8 index, count;
+  uint16 length, offset;
+  uint8 dataLength;
+
+  if (pFrame->length <= BASIC_RF_FRAG_HDR_SIZE) {
+    return;
+  }
+  index = pPayload[2];
+  count = pPayload[3];
+  length = BUILD_UINT16(pPayload[4], pPayload[5]);
+  dataLength = pFrame->length - BASIC_RF_FRAG_HDR_SIZE;
+  offset = (uint16)index * BASIC_RF_FRAG_DATA_SIZE;
+
+  // Drop fragments that do not fit the fragment layout
+  if (length == 0 || length > BASIC_RF_FRAG_MAX_DATAGRAM ||
+      count != basicRfFragCount(length) || index >= count ||
+      dataLength != MIN(length - offset, BASIC_RF_FRAG_DATA_SIZE)) {
+    return;
+  }
+
+  pRx = basicRfFragRxFind(pFrame->srcAddr, pPayload[1], pFrame->timestamp);
+  if (pRx == NULL) {
+    fragStats.rxNoBuffer++;
+    return;
+  }
+
+  if (pRx->state == FRAG_RX_FREE || pRx->srcAddr != pFrame->srcAddr ||
+      pRx->tag != pPayload[1]) {
+    // Start reassembly of a new datagram
+    pRx->state = FRAG_RX_ASSEMBLING;
+    pRx->srcAddr = pFrame->srcAddr;
+    pRx->tag = pPayload[1];
+    pRx->count = count;
+    pRx->length = length;
+    memset(pRx->received, 0, sizeof(pRx->received));
+  } else if (pRx->count != count || pRx->length != length) {
+    return;
+  }
+
+  if (pRx->state == FRAG_RX_ASSEMBLING) {
+    memcpy(&pRx->data[offset], &pPayload[BASIC_RF_FRAG_HDR_SIZE], dataLength);
+    pRx->received[index >> 3] |= BV(index & 7);
+    pRx->lastRx = pFrame->timestamp;
+
+    if (basicRfFragAllSet(pRx->received, count)) {
+      pRx->state = FRAG_RX_COMPLETE;
+      pRx->order = fragRxOrder++;
+      fragStats.rxDatagrams++;
+    }
+  } else if (pRx->state == FRAG_RX_READ) {
+    pRx->lastRx = pFrame->timestamp;
+  }
+
+  if (pPayload[0] == FRAG_TYPE_DATA_ACKREQ) {
+    basicRfFragSendSack(pRx);
+  }
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Initialises the fragmentation layer
+*
+* @return   None
+******************************************************************************/
+void basicRfFragInit(void)
+{
+  memset(&fragTx, 0, sizeof(fragTx));
+  memset(fragRx, 0, sizeof(fragRx));
+  memset(&fragStats, 0, sizeof(fragStats));
+  fragRxOrder = 0;
+}
+
+
+/**************************************************************************//**
+* @brief    Starts sending a datagram. The datagram is sent by
+*           basicRfFragPoll() and must not change until
+*           basicRfFragSendStatus() no longer returns BASIC_RF_FRAG_BUSY.
+*
+* @param    destAddr    Destination short address
+* @param    pData       Datagram
+* @param    length      Datagram length, 1 to BASIC_RF_FRAG_MAX_DATAGRAM
+*
+* @return   uint8 - SUCCESS, or FAILED if a transfer is in progress or the
+*           length is invalid
+******************************************************************************/
+uint8 basicRfFragSend(uint16 destAddr, uint8* pData, uint16 length)
+{
+  if (fragTx.state == FRAG_TX_SENDING || fragTx.state == FRAG_TX_WAIT_SACK ||
+      length == 0 || length > BASIC_RF_FRAG_MAX_DATAGRAM) {
+    return FAILED;
+  }
+
+  fragTx.tag++;
+  fragTx.destAddr = destAddr;
+  fragTx.pData = pData;
+  fragTx.length = length;
+  fragTx.count = basicRfFragCount(length);
+  fragTx.rounds = 0;
+  memset(fragTx.acked, 0, sizeof(fragTx.acked));
+  basicRfFragStartRound();
+  basicRfFragSendFragments();
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the status of the last transfer started with
+*           basicRfFragSend()
+*
+* @return   uint8 - BASIC_RF_FRAG_IDLE, BASIC_RF_FRAG_BUSY, BASIC_RF_FRAG_DONE
+*           or BASIC_RF_FRAG_FAILED
+******************************************************************************/
+uint8 basicRfFragSendStatus(void)
+{
+  switch (fragTx.state) {
+  case FRAG_TX_SENDING:
+  case FRAG_TX_WAIT_SACK:
+    return BASIC_RF_FRAG_BUSY;
+  case FRAG_TX_DONE:
+    return BASIC_RF_FRAG_DONE;
+  case FRAG_TX_FAILED:
+    return BASIC_RF_FRAG_FAILED;
+  default:
+    return BASIC_RF_FRAG_IDLE;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Handles a received packet if it belongs to the fragmentation
+*           layer. The packet is not released.
+*
+* @param    pFrame      Packet from basicRfRxBorrow()
+*
+* @return   uint8 - TRUE if the packet was a fragment or SACK
+******************************************************************************/
+uint8 basicRfFragInput(basicRfRxFrame_t* pFrame)
+{
+  if (pFrame->length < 3 ||
+      (pFrame->pPayload[0] & FRAG_DISPATCH_MASK) != FRAG_DISPATCH) {
+    return FALSE;
+  }
+
+  switch (pFrame->pPayload[0]) {
+  case FRAG_TYPE_DATA:
+  case FRAG_TYPE_DATA_ACKREQ:
+    basicRfFragDataInput(pFrame);
+    break;
+  case FRAG_TYPE_SACK:
+    basicRfFragSackInput(pFrame);
+    break;
+  default:
+    break;
+  }
+  return TRUE;
+}
+
+
+/**************************************************************************//**
+* @brief    Queues fragments for transmission and handles the SACK and
+*           reassembly timeouts. Call regularly from the main loop.
+*
+* @return   None
+******************************************************************************/
+void basicRfFragPoll(void)
+{
+  uint32 now = halRfMacTimerGet();
+  uint8 i;
+
+  if (fragTx.state == FRAG_TX_SENDING) {
+    basicRfFragSendFragments();
+  } else if (fragTx.state == FRAG_TX_WAIT_SACK && fragTx.sackWait &&
+             FRAG_ELAPSED(now, fragTx.sackStart) > BASIC_RF_FRAG_SACK_TIMEOUT) {
+    basicRfFragStartRound();
+  }
+
+  for (i = 0; i < BASIC_RF_FRAG_POOL_SIZE; i++) {
+    if (fragRx[i].state == FRAG_RX_ASSEMBLING &&
+        FRAG_ELAPSED(now, fragRx[i].lastRx) > BASIC_RF_FRAG_REASSEMBLY_TIMEOUT) {
+      fragRx[i].state = FRAG_RX_FREE;
+      fragStats.rxTimeouts++;
+    } else if (fragRx[i].state == FRAG_RX_READ &&
+               FRAG_ELAPSED(now, fragRx[i].lastRx) > BASIC_RF_FRAG_READ_TIMEOUT) {
+      fragRx[i].state = FRAG_RX_FREE;
+    }
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the oldest reassembled datagram into a buffer and frees
+*           its reassembly buffer
+*
+* @param    pBuf        Buffer to fill
+* @param    len         Size of the buffer
+* @param    pSrcAddr    Pointer to variable for the source address. NULL if
+*                       not needed.
+*
+* @return   uint16 - Number of bytes copied, 0 if no datagram is ready
+******************************************************************************/
+uint16 basicRfFragReceive(uint8* pBuf, uint16 len, uint16* pSrcAddr)
+{
+  basicRfFragRx_t *pOldest = NULL;
+  uint8 i;
+
+  for (i = 0; i < BASIC_RF_FRAG_POOL_SIZE; i++) {
+    if (fragRx[i].state == FRAG_RX_COMPLETE &&
+        (pOldest == NULL || (int8)(fragRx[i].order - pOldest->order) < 0)) {
+      pOldest = &fragRx[i];
+    }
+  }
+  if (pOldest == NULL) {
+    return 0;
+  }
+
+  len = MIN(len, pOldest->length);
+  memcpy(pBuf, pOldest->data, len);
+  if (pSrcAddr != NULL) {
+    *pSrcAddr = pOldest->srcAddr;
+  }
+
+  // Keep tag and bitmap to answer a repeated SACK request for a while
+  pOldest->state = FRAG_RX_READ;
+  pOldest->lastRx = halRfMacTimerGet();
+
+  return len;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the statistics counters
+*
+* @param    pStats      Pointer to struct to fill
+*
+* @return   None
+******************************************************************************/
+void basicRfFragGetStats(basicRfFragStats_t* pStats)
+{
+  *pStats = fragStats;
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
@@ -0,0 +1,160 @@
+//*****************************************************************************
+//! @file       basic_rf_frag.h
+//! @brief      Basic RF fragmentation and reassembly.
+//!
+//!             Sends datagrams of up to BASIC_RF_FRAG_MAX_DATAGRAM bytes over
+//!             Basic RF by splitting them into numbered fragments. The
+//!             receiver reassembles the fragments in a pool of
+//!             BASIC_RF_FRAG_POOL_SIZE buffers and, when asked by the sender,
+//!             returns a selective acknowledgment (SACK) with a bitmap of the
+//!             fragments it has. The sender then resends only the missing
+//!             fragments.
+//!
+//!             Fragment frames are ordinary Basic RF packets whose first
+//!             payload byte is in the range 0xC0-0xCF, so application packets
+//!             must not start with such a byte.
+//!
+//!             INSTRUCTIONS:
+//!             1. Call basicRfFragInit() after basicRfInit().
+//!             2. Pass every packet from basicRfRxBorrow() to
+//!                basicRfFragInput() before handling it. Packets for which
+//!                it returns TRUE belong to this layer.
+//!             3. Call basicRfFragPoll() regularly from the main loop. It
+//!                sends queued fragments and handles timeouts.
+//!             Transmission:
+//!             - Start a transfer with basicRfFragSend(). Only one transfer
+//!               can be in progress; check basicRfFragSendStatus().
+//!             Reception:
+//!             - Get complete datagrams with basicRfFragReceive().
+//!
+//!             DATA FRAGMENT FORMAT:
+//!             [Dispatch (1)][Tag (1)][Index (1)][Count (1)]
+//!             [Datagram length (2)][Data (up to BASIC_RF_FRAG_DATA_SIZE)]
+//!
+//!             SACK FORMAT:
+//!             [Dispatch (1)][Tag (1)][Count (1)][Bitmap ((Count + 7) / 8)]
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_FRAG_H__
+#define __BASIC_RF_FRAG_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "basic_rf.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Largest datagram
+#ifndef BASIC_RF_FRAG_MAX_DATAGRAM
+#define BASIC_RF_FRAG_MAX_DATAGRAM          1024
+#endif
+
+// Number of datagrams that can be reassembled or waiting to be read at the
+// same time
+#ifndef BASIC_RF_FRAG_POOL_SIZE
+#define BASIC_RF_FRAG_POOL_SIZE             2
+#endif
+
+// Time to wait for a SACK before the missing fragments are resent, in
+// symbols (15625 symbols = 250 ms)
+#ifndef BASIC_RF_FRAG_SACK_TIMEOUT
+#define BASIC_RF_FRAG_SACK_TIMEOUT          15625UL
+#endif
+
+// Number of rounds of (re)transmissions before a transfer fails
+#ifndef BASIC_RF_FRAG_MAX_ROUNDS
+#define BASIC_RF_FRAG_MAX_ROUNDS            4
+#endif
+
+// A partly reassembled datagram is dropped if no fragment of it is received
+// within this time, in symbols (312500 symbols = 5 s)
+#ifndef BASIC_RF_FRAG_REASSEMBLY_TIMEOUT
+#define BASIC_RF_FRAG_REASSEMBLY_TIMEOUT    312500UL
+#endif
+
+// A datagram that has been read is remembered to answer repeated SACK
+// requests until no request for it is received within this time, in
+// symbols. Must cover the SACK requests of all rounds of the sender.
+#ifndef BASIC_RF_FRAG_READ_TIMEOUT
+#define BASIC_RF_FRAG_READ_TIMEOUT          (BASIC_RF_FRAG_SACK_TIMEOUT * \
+                                             BASIC_RF_FRAG_MAX_ROUNDS)
+#endif
+
+// Fragment header and data sizes
+#define BASIC_RF_FRAG_HDR_SIZE              6
+#define BASIC_RF_FRAG_DATA_SIZE             (BASIC_RF_MAX_PAYLOAD_SIZE - \
+                                             BASIC_RF_FRAG_HDR_SIZE)
+#define BASIC_RF_FRAG_MAX_COUNT             64
+
+// basicRfFragSendStatus() values
+#define BASIC_RF_FRAG_IDLE                  0   // No transfer started
+#define BASIC_RF_FRAG_BUSY                  1   // Transfer in progress
+#define BASIC_RF_FRAG_DONE                  2   // All fragments acknowledged
+#define BASIC_RF_FRAG_FAILED                3   // Gave up after max rounds
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Statistics counters
+typedef struct {
+    uint32 txDatagrams;         // Datagrams sent and acknowledged
+    uint32 txFailed;            // Datagrams given up
+    uint32 txFragments;         // Fragments sent, including resent fragments
+    uint32 txResent;            // Fragments resent
+    uint32 rxDatagrams;         // Datagrams reassembled
+    uint32 rxTimeouts;          // Partly reassembled datagrams dropped
+    uint32 rxNoBuffer;          // Datagrams dropped because the pool was full
+} basicRfFragStats_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+void basicRfFragInit(void);
+uint8 basicRfFragSend(uint16 destAddr, uint8* pData, uint16 length);
+uint8 basicRfFragSendStatus(void);
+uint8 basicRfFragInput(basicRfRxFrame_t* pFrame);
+void basicRfFragPoll(void);
+uint16 basicRfFragReceive(uint8* pBuf, uint16 len, uint16* pSrcAddr);
+void basicRfFragGetStats(basicRfFragStats_t* pStats);
+
+
+#endif // #ifdef __BASIC_RF_FRAG_H__
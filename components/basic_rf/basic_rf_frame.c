@@ -0,0 +1,667 @@
+//*****************************************************************************
+//! @file       basic_rf_frame.c
+//! @brief      IEEE 802.15.4 frame codec.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#ifdef BASIC_RF_FRAME_HOST
+#include <time.h>
+#endif
+#include "hal_defs.h"
+#include "basic_rf_frame.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// FCF and sequence number
+#define FRAME_MIN_HDR_SIZE                  3
+
+// Layout table index: PAN ID compression in bit 0, destination addressing
+// mode in bits 1-2 and source addressing mode in bits 3-4
+#define FRAME_LAYOUT_INDEX(fcf)             ((uint8)((((fcf) >> 6) & 0x01) | \
+                                                     (((fcf) >> 9) & 0x06) | \
+                                                     (((fcf) >> 11) & 0x18)))
+
+// Address presence of a layout table index: destination address in bit 0,
+// source address in bit 1. Both are present if the upper bit of their
+// addressing mode is set.
+#define FRAME_ADDR_PRESENCE(index)          ((uint8)((((index) >> 2) & 0x01) | \
+                                                     (((index) >> 3) & 0x02)))
+
+// Layout table entries
+#define FRAME_FIELD_NONE                    0xFF
+#define FRAME_LAYOUT_INVALID                0xFF
+
+#define FRAME_ADDR_LEN(mode)                ((mode) == BASIC_RF_FRAME_ADDR_EXT ? \
+                                             BASIC_RF_FRAME_EXT_ADDR_SIZE : \
+                                             ((mode) == BASIC_RF_FRAME_ADDR_SHORT ? 2 : 0))
+#define FRAME_DST_PAN_LEN(dm)               ((dm) >= BASIC_RF_FRAME_ADDR_SHORT ? 2 : 0)
+#define FRAME_SRC_PAN_LEN(dm, sm, pc)       (((sm) >= BASIC_RF_FRAME_ADDR_SHORT && \
+                                              !((pc) && (dm) >= BASIC_RF_FRAME_ADDR_SHORT)) ? 2 : 0)
+#define FRAME_SRC_OFFSET(dm)                (FRAME_DST_PAN_LEN(dm) + FRAME_ADDR_LEN(dm))
+#define FRAME_LAYOUT_VALID(dm, sm, pc)      ((dm) != 1 && (sm) != 1 && \
+                                             (!(pc) || ((dm) >= BASIC_RF_FRAME_ADDR_SHORT && \
+                                                        (sm) >= BASIC_RF_FRAME_ADDR_SHORT)))
+
+#define FRAME_LAYOUT_ENTRY(dm, sm, pc) { \
+    (dm) >= BASIC_RF_FRAME_ADDR_SHORT ? 2 : FRAME_FIELD_NONE, \
+    FRAME_SRC_PAN_LEN(dm, sm, pc) ? FRAME_SRC_OFFSET(dm) : FRAME_FIELD_NONE, \
+    (sm) >= BASIC_RF_FRAME_ADDR_SHORT ? \
+        FRAME_SRC_OFFSET(dm) + FRAME_SRC_PAN_LEN(dm, sm, pc) : FRAME_FIELD_NONE, \
+    FRAME_LAYOUT_VALID(dm, sm, pc) ? \
+        FRAME_SRC_OFFSET(dm) + FRAME_SRC_PAN_LEN(dm, sm, pc) + FRAME_ADDR_LEN(sm) : \
+        FRAME_LAYOUT_INVALID }
+#define FRAME_LAYOUT(index)                 FRAME_LAYOUT_ENTRY(((index) >> 1) & 0x03, \
+                                                               ((index) >> 3) & 0x03, \
+                                                               (index) & 0x01)
+
+// Frame type table entries: allowed address presence combinations, one bit
+// per FRAME_ADDR_PRESENCE() value, and whether security may be enabled
+#define FRAME_TYPE_NO_ADDR                  0x01
+#define FRAME_TYPE_DST_ONLY                 0x02
+#define FRAME_TYPE_SRC_ONLY                 0x04
+#define FRAME_TYPE_DST_SRC                  0x08
+#define FRAME_TYPE_SEC                      0x10
+
+#ifdef BASIC_RF_FRAME_HOST
+// Payload length of the round-trip frames is taken from the FCF
+#define FRAME_CHECK_PAYLOAD_BM              0x0F
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Offsets of the addressing fields from the end of the sequence number. The
+// destination PAN ID is at offset 0 if there is a destination address.
+typedef struct
+{
+  uint8 dstAddr;                // FRAME_FIELD_NONE if absent
+  uint8 srcPanId;               // FRAME_FIELD_NONE if absent or compressed
+  uint8 srcAddr;                // FRAME_FIELD_NONE if absent
+  uint8 length;                 // Addressing fields, FRAME_LAYOUT_INVALID if
+                                // reserved modes or invalid PAN ID compression
+} basicRfFrameLayout_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+// Addressing field layout, indexed by FRAME_LAYOUT_INDEX()
+static const basicRfFrameLayout_t frameLayout[32] = {
+  FRAME_LAYOUT(0),  FRAME_LAYOUT(1),  FRAME_LAYOUT(2),  FRAME_LAYOUT(3),
+  FRAME_LAYOUT(4),  FRAME_LAYOUT(5),  FRAME_LAYOUT(6),  FRAME_LAYOUT(7),
+  FRAME_LAYOUT(8),  FRAME_LAYOUT(9),  FRAME_LAYOUT(10), FRAME_LAYOUT(11),
+  FRAME_LAYOUT(12), FRAME_LAYOUT(13), FRAME_LAYOUT(14), FRAME_LAYOUT(15),
+  FRAME_LAYOUT(16), FRAME_LAYOUT(17), FRAME_LAYOUT(18), FRAME_LAYOUT(19),
+  FRAME_LAYOUT(20), FRAME_LAYOUT(21), FRAME_LAYOUT(22), FRAME_LAYOUT(23),
+  FRAME_LAYOUT(24), FRAME_LAYOUT(25), FRAME_LAYOUT(26), FRAME_LAYOUT(27),
+  FRAME_LAYOUT(28), FRAME_LAYOUT(29), FRAME_LAYOUT(30), FRAME_LAYOUT(31)
+};
+
+// Allowed addressing and security, indexed by frame type
+static const uint8 frameTypeInfo[8] = {
+  FRAME_TYPE_SRC_ONLY | FRAME_TYPE_SEC,                         // Beacon
+  FRAME_TYPE_DST_ONLY | FRAME_TYPE_SRC_ONLY | FRAME_TYPE_DST_SRC |
+  FRAME_TYPE_SEC,                                               // Data
+  FRAME_TYPE_NO_ADDR,                                           // Ack
+  FRAME_TYPE_DST_ONLY | FRAME_TYPE_SRC_ONLY | FRAME_TYPE_DST_SRC |
+  FRAME_TYPE_SEC,                                               // Command
+  0, 0, 0, 0                                                    // Reserved
+};
+
+// Key identifier length, indexed by key identifier mode. The auxiliary
+// security header adds the security control and the frame counter.
+static const uint8 frameKeyIdLength[4] = { 0, 1, 5, 9 };
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Looks up the addressing field layout of a frame and checks that
+*           the frame type allows it
+*
+* @param    fcf         Frame control field
+*
+* @return   Layout, or NULL if the frame is invalid
+******************************************************************************/
+static const basicRfFrameLayout_t* basicRfFrameGetLayout(uint16 fcf)
+{
+  const basicRfFrameLayout_t* pLayout;
+  uint8 index;
+  uint8 typeInfo;
+
+  index = FRAME_LAYOUT_INDEX(fcf);
+  pLayout = &frameLayout[index];
+  typeInfo = frameTypeInfo[fcf & BASIC_RF_FRAME_FCF_TYPE_BM];
+  if (pLayout->length == FRAME_LAYOUT_INVALID ||
+      !(typeInfo & BV(FRAME_ADDR_PRESENCE(index))) ||
+      ((fcf & BASIC_RF_FRAME_FCF_SEC_BM) && !(typeInfo & FRAME_TYPE_SEC))) {
+    return NULL;
+  }
+  return pLayout;
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Parses a frame in a single pass. The frame must stay in place
+*           while the descriptor is used.
+*
+* @param    pBuf        Frame, starting with the FCF
+* @param    length      Frame length without the FCS
+* @param    pFrame      Descriptor to fill
+*
+* @return   uint8 - SUCCESS, or FAILED if the frame is invalid or truncated
+******************************************************************************/
+uint8 basicRfFrameParse(const uint8* pBuf, uint8 length, basicRfFrame_t* pFrame)
+{
+  const basicRfFrameLayout_t* pLayout;
+  const uint8* p;
+  uint16 fcf;
+  uint8 hdrLength;
+  uint8 keyIdLength;
+
+  if (length < FRAME_MIN_HDR_SIZE) {
+    return FAILED;
+  }
+  fcf = BUILD_UINT16(pBuf[0], pBuf[1]);
+  pLayout = basicRfFrameGetLayout(fcf);
+  if (pLayout == NULL) {
+    return FAILED;
+  }
+  hdrLength = FRAME_MIN_HDR_SIZE + pLayout->length;
+  if (hdrLength > length) {
+    return FAILED;
+  }
+
+  pFrame->fcf = fcf;
+  pFrame->seqNumber = pBuf[2];
+  p = pBuf + FRAME_MIN_HDR_SIZE;
+
+  pFrame->dstAddr = BASIC_RF_FRAME_NO_SHORT_ADDR;
+  pFrame->pDstExtAddr = NULL;
+  if (pLayout->dstAddr != FRAME_FIELD_NONE) {
+    pFrame->dstPanId = BUILD_UINT16(p[0], p[1]);
+    if (BASIC_RF_FRAME_GET_DST_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT) {
+      pFrame->pDstExtAddr = p + pLayout->dstAddr;
+    } else {
+      pFrame->dstAddr = BUILD_UINT16(p[pLayout->dstAddr], p[pLayout->dstAddr + 1]);
+    }
+  } else {
+    pFrame->dstPanId = 0xFFFF;
+  }
+
+  if (pLayout->srcPanId != FRAME_FIELD_NONE) {
+    pFrame->srcPanId = BUILD_UINT16(p[pLayout->srcPanId], p[pLayout->srcPanId + 1]);
+  } else {
+    pFrame->srcPanId = pFrame->dstPanId;
+  }
+
+  pFrame->srcAddr = BASIC_RF_FRAME_NO_SHORT_ADDR;
+  pFrame->pSrcExtAddr = NULL;
+  if (pLayout->srcAddr != FRAME_FIELD_NONE) {
+    if (BASIC_RF_FRAME_GET_SRC_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT) {
+      pFrame->pSrcExtAddr = p + pLayout->srcAddr;
+    } else {
+      pFrame->srcAddr = BUILD_UINT16(p[pLayout->srcAddr], p[pLayout->srcAddr + 1]);
+    }
+  }
+
+  pFrame->pKeyId = NULL;
+  if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+    if (hdrLength >= length) {
+      return FAILED;
+    }
+    p = pBuf + hdrLength;
+    pFrame->secControl = p[0];
+    keyIdLength = frameKeyIdLength[(p[0] & BASIC_RF_FRAME_SEC_KEY_ID_MODE_BM) >>
+                                   BASIC_RF_FRAME_SEC_KEY_ID_MODE_S];
+    hdrLength += 5 + keyIdLength;
+    if (hdrLength > length) {
+      return FAILED;
+    }
+    pFrame->frameCounter = BUILD_UINT32(p[1], p[2], p[3], p[4]);
+    if (keyIdLength != 0) {
+      pFrame->pKeyId = p + 5;
+    }
+  } else {
+    pFrame->secControl = 0;
+    pFrame->frameCounter = 0;
+  }
+
+  pFrame->hdrLength = hdrLength;
+  pFrame->pPayload = pBuf + hdrLength;
+  pFrame->payloadLength = length - hdrLength;
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the MHR length of a frame
+*
+* @param    fcf         Frame control field
+* @param    secControl  Security control field, used if security is enabled
+*                       in \e fcf
+*
+* @return   uint8 - MHR length, or 0 if the frame is invalid
+******************************************************************************/
+uint8 basicRfFrameHdrLength(uint16 fcf, uint8 secControl)
+{
+  const basicRfFrameLayout_t* pLayout;
+  uint8 hdrLength;
+
+  pLayout = basicRfFrameGetLayout(fcf);
+  if (pLayout == NULL) {
+    return 0;
+  }
+  hdrLength = FRAME_MIN_HDR_SIZE + pLayout->length;
+  if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+    hdrLength += 5 + frameKeyIdLength[(secControl & BASIC_RF_FRAME_SEC_KEY_ID_MODE_BM) >>
+                                      BASIC_RF_FRAME_SEC_KEY_ID_MODE_S];
+  }
+  return hdrLength;
+}
+
+
+/**************************************************************************//**
+* @brief    Writes a frame from a descriptor. The addressing fields written
+*           are selected by the FCF; the other fields of the descriptor are
+*           ignored. \e hdrLength is not used. The payload may already be in
+*           place in \e pBuf.
+*
+* @param    pFrame      Descriptor
+* @param    pBuf        Where to write the frame, starting with the FCF
+*
+* @return   uint8 - Frame length without the FCS, or 0 if the frame is
+*           invalid or too long
+******************************************************************************/
+uint8 basicRfFrameWrite(const basicRfFrame_t* pFrame, uint8* pBuf)
+{
+  const basicRfFrameLayout_t* pLayout;
+  uint8* p;
+  uint16 fcf;
+  uint8 hdrLength;
+  uint8 keyIdLength;
+
+  fcf = pFrame->fcf;
+  pLayout = basicRfFrameGetLayout(fcf);
+  if (pLayout == NULL) {
+    return 0;
+  }
+  hdrLength = FRAME_MIN_HDR_SIZE + pLayout->length;
+  keyIdLength = 0;
+  if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+    keyIdLength = frameKeyIdLength[(pFrame->secControl & BASIC_RF_FRAME_SEC_KEY_ID_MODE_BM) >>
+                                   BASIC_RF_FRAME_SEC_KEY_ID_MODE_S];
+    hdrLength += 5 + keyIdLength;
+  }
+  if ((uint16)hdrLength + pFrame->payloadLength > BASIC_RF_FRAME_MAX_SIZE ||
+      (BASIC_RF_FRAME_GET_DST_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT && pFrame->pDstExtAddr == NULL) ||
+      (BASIC_RF_FRAME_GET_SRC_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT && pFrame->pSrcExtAddr == NULL) ||
+      (keyIdLength != 0 && pFrame->pKeyId == NULL)) {
+    return 0;
+  }
+
+  // The payload goes first in case it overlaps the header
+  if (pFrame->payloadLength != 0) {
+    memmove(pBuf + hdrLength, pFrame->pPayload, pFrame->payloadLength);
+  }
+
+  pBuf[0] = LO_UINT16(fcf);
+  pBuf[1] = HI_UINT16(fcf);
+  pBuf[2] = pFrame->seqNumber;
+  p = pBuf + FRAME_MIN_HDR_SIZE;
+
+  if (pLayout->dstAddr != FRAME_FIELD_NONE) {
+    p[0] = LO_UINT16(pFrame->dstPanId);
+    p[1] = HI_UINT16(pFrame->dstPanId);
+    if (BASIC_RF_FRAME_GET_DST_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT) {
+      memcpy(p + pLayout->dstAddr, pFrame->pDstExtAddr, BASIC_RF_FRAME_EXT_ADDR_SIZE);
+    } else {
+      p[pLayout->dstAddr] = LO_UINT16(pFrame->dstAddr);
+      p[pLayout->dstAddr + 1] = HI_UINT16(pFrame->dstAddr);
+    }
+  }
+  if (pLayout->srcPanId != FRAME_FIELD_NONE) {
+    p[pLayout->srcPanId] = LO_UINT16(pFrame->srcPanId);
+    p[pLayout->srcPanId + 1] = HI_UINT16(pFrame->srcPanId);
+  }
+  if (pLayout->srcAddr != FRAME_FIELD_NONE) {
+    if (BASIC_RF_FRAME_GET_SRC_MODE(fcf) == BASIC_RF_FRAME_ADDR_EXT) {
+      memcpy(p + pLayout->srcAddr, pFrame->pSrcExtAddr, BASIC_RF_FRAME_EXT_ADDR_SIZE);
+    } else {
+      p[pLayout->srcAddr] = LO_UINT16(pFrame->srcAddr);
+      p[pLayout->srcAddr + 1] = HI_UINT16(pFrame->srcAddr);
+    }
+  }
+
+  if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+    p += pLayout->length;
+    p[0] = pFrame->secControl;
+    p[1] = BREAK_UINT32(pFrame->frameCounter, 0);
+    p[2] = BREAK_UINT32(pFrame->frameCounter, 1);
+    p[3] = BREAK_UINT32(pFrame->frameCounter, 2);
+    p[4] = BREAK_UINT32(pFrame->frameCounter, 3);
+    memcpy(p + 5, pFrame->pKeyId, keyIdLength);
+  }
+
+  return hdrLength + pFrame->payloadLength;
+}
+
+
+#ifdef BASIC_RF_FRAME_HOST
+/**************************************************************************//**
+* @brief    Checks the codec against every value of the FCF, with every key
+*           identifier mode if security is enabled. For each combination a
+*           descriptor is filled with distinct field values and written. The
+*           expected validity and header length are worked out here from the
+*           standard rather than from the codec tables. A valid frame must
+*           parse back to the same fields, write back to the same bytes, and
+*           be rejected when truncated anywhere in the header. An invalid
+*           frame must be rejected by both the writer and the parser.
+*
+* @param    pResult     Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS if no combination failed, else FAILED
+******************************************************************************/
+uint8 basicRfFrameRoundTrip(basicRfFrameCheck_t* pResult)
+{
+  static const uint8 dstExtAddr[BASIC_RF_FRAME_EXT_ADDR_SIZE] = {
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17
+  };
+  static const uint8 srcExtAddr[BASIC_RF_FRAME_EXT_ADDR_SIZE] = {
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27
+  };
+  static const uint8 keyId[BASIC_RF_FRAME_MAX_KEY_ID_SIZE] = {
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38
+  };
+  static const uint8 payload[FRAME_CHECK_PAYLOAD_BM] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E
+  };
+  basicRfFrame_t frame;
+  basicRfFrame_t parsed;
+  uint8 buf[BASIC_RF_FRAME_MAX_SIZE];
+  uint8 rewritten[BASIC_RF_FRAME_MAX_SIZE];
+  uint32 fcf;
+  uint8 keyIdMode;
+  uint8 nKeyIdModes;
+  uint8 type, dm, sm;
+  uint8 isValid;
+  uint8 expectedLength;
+  uint8 keyIdLength;
+  uint8 length;
+  uint8 failed;
+  uint8 i;
+
+  memset(pResult, 0, sizeof(*pResult));
+
+  for (fcf = 0; fcf <= 0xFFFF; fcf++) {
+    nKeyIdModes = (fcf & BASIC_RF_FRAME_FCF_SEC_BM) ? 4 : 1;
+    for (keyIdMode = 0; keyIdMode < nKeyIdModes; keyIdMode++) {
+      pResult->frames++;
+
+      memset(&frame, 0, sizeof(frame));
+      frame.fcf = (uint16)fcf;
+      frame.seqNumber = (uint8)(fcf ^ (fcf >> 8));
+      frame.dstPanId = 0x1234;
+      frame.dstAddr = 0x5678;
+      frame.srcPanId = 0x9ABC;
+      frame.srcAddr = 0xDEF0;
+      frame.pDstExtAddr = dstExtAddr;
+      frame.pSrcExtAddr = srcExtAddr;
+      frame.secControl = 0x05 | (keyIdMode << BASIC_RF_FRAME_SEC_KEY_ID_MODE_S);
+      frame.frameCounter = 0x01020304UL + fcf;
+      frame.pKeyId = keyId;
+      frame.pPayload = payload;
+      frame.payloadLength = (uint8)(fcf & FRAME_CHECK_PAYLOAD_BM);
+
+      // Validity and header length by IEEE 802.15.4-2006
+      type = BASIC_RF_FRAME_GET_TYPE(fcf);
+      dm = BASIC_RF_FRAME_GET_DST_MODE(fcf);
+      sm = BASIC_RF_FRAME_GET_SRC_MODE(fcf);
+      isValid = dm != 1 && sm != 1;
+      if (fcf & BASIC_RF_FRAME_FCF_PANID_COMP_BM) {
+        isValid = isValid && dm != 0 && sm != 0;
+      }
+      switch (type) {
+      case BASIC_RF_FRAME_TYPE_BEACON:
+        isValid = isValid && dm == 0 && sm != 0;
+        break;
+      case BASIC_RF_FRAME_TYPE_DATA:
+      case BASIC_RF_FRAME_TYPE_CMD:
+        isValid = isValid && (dm != 0 || sm != 0);
+        break;
+      case BASIC_RF_FRAME_TYPE_ACK:
+        isValid = isValid && dm == 0 && sm == 0 &&
+                  !(fcf & BASIC_RF_FRAME_FCF_SEC_BM);
+        break;
+      default:
+        isValid = FALSE;
+        break;
+      }
+      expectedLength = 3;
+      if (dm != 0) {
+        expectedLength += 2 + (dm == BASIC_RF_FRAME_ADDR_EXT ? 8 : 2);
+      }
+      if (sm != 0) {
+        expectedLength += (dm != 0 && (fcf & BASIC_RF_FRAME_FCF_PANID_COMP_BM)) ? 0 : 2;
+        expectedLength += (sm == BASIC_RF_FRAME_ADDR_EXT ? 8 : 2);
+      }
+      keyIdLength = 0;
+      if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+        keyIdLength = (keyIdMode == 0) ? 0 : (keyIdMode == 1) ? 1 :
+                      (keyIdMode == 2) ? 5 : 9;
+        expectedLength += 5 + keyIdLength;
+      }
+
+      length = basicRfFrameWrite(&frame, buf);
+      failed = FALSE;
+
+      if (!isValid) {
+        // Rejected by the writer, and by the parser with a header of any
+        // length behind the FCF
+        memset(buf, 0, sizeof(buf));
+        buf[0] = LO_UINT16(fcf);
+        buf[1] = HI_UINT16(fcf);
+        failed = length != 0 ||
+                 basicRfFrameHdrLength((uint16)fcf, frame.secControl) != 0 ||
+                 basicRfFrameParse(buf, sizeof(buf), &parsed) == SUCCESS;
+      } else if (length != expectedLength + frame.payloadLength ||
+                 basicRfFrameHdrLength((uint16)fcf, frame.secControl) != expectedLength ||
+                 basicRfFrameParse(buf, length, &parsed) != SUCCESS) {
+        failed = TRUE;
+      } else {
+        pResult->validFrames++;
+
+        // Every field present in the frame comes back
+        failed = parsed.fcf != frame.fcf ||
+                 parsed.seqNumber != frame.seqNumber ||
+                 parsed.hdrLength != expectedLength ||
+                 parsed.payloadLength != frame.payloadLength ||
+                 memcmp(parsed.pPayload, payload, frame.payloadLength) != 0;
+        if (dm != 0) {
+          failed |= parsed.dstPanId != frame.dstPanId;
+        }
+        if (dm == BASIC_RF_FRAME_ADDR_SHORT) {
+          failed |= parsed.dstAddr != frame.dstAddr || parsed.pDstExtAddr != NULL;
+        } else if (dm == BASIC_RF_FRAME_ADDR_EXT) {
+          failed |= parsed.pDstExtAddr == NULL ||
+                    memcmp(parsed.pDstExtAddr, dstExtAddr, sizeof(dstExtAddr)) != 0;
+        }
+        if (sm != 0) {
+          failed |= parsed.srcPanId != ((dm != 0 && (fcf & BASIC_RF_FRAME_FCF_PANID_COMP_BM)) ?
+                                        frame.dstPanId : frame.srcPanId);
+        }
+        if (sm == BASIC_RF_FRAME_ADDR_SHORT) {
+          failed |= parsed.srcAddr != frame.srcAddr || parsed.pSrcExtAddr != NULL;
+        } else if (sm == BASIC_RF_FRAME_ADDR_EXT) {
+          failed |= parsed.pSrcExtAddr == NULL ||
+                    memcmp(parsed.pSrcExtAddr, srcExtAddr, sizeof(srcExtAddr)) != 0;
+        }
+        if (fcf & BASIC_RF_FRAME_FCF_SEC_BM) {
+          failed |= parsed.secControl != frame.secControl ||
+                    parsed.frameCounter != frame.frameCounter ||
+                    (keyIdLength == 0 ? parsed.pKeyId != NULL :
+                     (parsed.pKeyId == NULL ||
+                      memcmp(parsed.pKeyId, keyId, keyIdLength) != 0));
+        }
+
+        // Writing the parsed descriptor gives the same bytes
+        failed |= basicRfFrameWrite(&parsed, rewritten) != length ||
+                  memcmp(rewritten, buf, length) != 0;
+
+        // Truncated headers are rejected
+        for (i = 0; i < expectedLength && !failed; i++) {
+          failed = basicRfFrameParse(buf, i, &parsed) == SUCCESS;
+        }
+      }
+
+      if (failed) {
+        pResult->errors++;
+      }
+    }
+  }
+
+  return pResult->errors ? FAILED : SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Measures the speed of the codec on a mix of four frames: a Basic
+*           RF data frame with short addresses, a data frame from an
+*           extended address, an acknowledgment and a secured MAC command
+*           with extended addresses and a key index. Each frame is parsed and
+*           written BASIC_RF_FRAME_BENCH_ROUNDS times.
+*
+* @param    pResult     Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS, or FAILED if a frame of the mix did not parse
+******************************************************************************/
+uint8 basicRfFrameBenchmark(basicRfFrameBench_t* pResult)
+{
+  static const uint8 dataShort[] = {
+    0x41, 0x88, 0x01, 0x07, 0x20, 0x02, 0x00, 0x01, 0x00,
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+  };
+  static const uint8 dataExt[] = {
+    0x41, 0xC8, 0x02, 0x07, 0x20, 0x01, 0x00,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    0x01, 0x02, 0x03, 0x04
+  };
+  static const uint8 ack[] = {
+    0x02, 0x00, 0x03
+  };
+  static const uint8 cmdSec[] = {
+    0x6B, 0xDC, 0x04, 0x07, 0x20,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+    0x0D, 0x01, 0x00, 0x00, 0x00, 0x01,
+    0x04, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7
+  };
+  static const uint8* const pFrames[4] = { dataShort, dataExt, ack, cmdSec };
+  static const uint8 lengths[4] = {
+    sizeof(dataShort), sizeof(dataExt), sizeof(ack), sizeof(cmdSec)
+  };
+  basicRfFrame_t frames[4];
+  uint8 buf[BASIC_RF_FRAME_MAX_SIZE];
+  uint32 round;
+  uint8 i;
+  clock_t start;
+  clock_t parseClocks;
+  clock_t writeClocks;
+  double nFrames;
+
+  memset(pResult, 0, sizeof(*pResult));
+  for (i = 0; i < 4; i++) {
+    if (basicRfFrameParse(pFrames[i], lengths[i], &frames[i]) != SUCCESS) {
+      return FAILED;
+    }
+  }
+
+  start = clock();
+  for (round = 0; round < BASIC_RF_FRAME_BENCH_ROUNDS; round++) {
+    for (i = 0; i < 4; i++) {
+      basicRfFrameParse(pFrames[i], lengths[i], &frames[i]);
+    }
+  }
+  parseClocks = clock() - start;
+
+  start = clock();
+  for (round = 0; round < BASIC_RF_FRAME_BENCH_ROUNDS; round++) {
+    for (i = 0; i < 4; i++) {
+      basicRfFrameWrite(&frames[i], buf);
+    }
+  }
+  writeClocks = clock() - start;
+
+  nFrames = 4.0 * BASIC_RF_FRAME_BENCH_ROUNDS;
+  if (parseClocks != 0) {
+    pResult->parsedPerSec = (uint32)((nFrames * CLOCKS_PER_SEC) / parseClocks);
+    pResult->parseNs = (uint32)(((double)parseClocks * 1e9) / CLOCKS_PER_SEC / nFrames);
+  }
+  if (writeClocks != 0) {
+    pResult->writtenPerSec = (uint32)((nFrames * CLOCKS_PER_SEC) / writeClocks);
+    pResult->writeNs = (uint32)(((double)writeClocks * 1e9) / CLOCKS_PER_SEC / nFrames);
+  }
+
+  return SUCCESS;
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
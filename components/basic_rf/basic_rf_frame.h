@@ -0,0 +1,188 @@
+//*****************************************************************************
+//! @file       basic_rf_frame.h
+//! @brief      IEEE 802.15.4 frame codec.
+//!
+//!             Parses the MAC header (MHR) of any IEEE 802.15.4-2006 frame
+//!             (beacon, data, acknowledgment and MAC command) into a
+//!             basicRfFrame_t descriptor in a single pass, and writes a
+//!             frame from a descriptor. All addressing modes, PAN ID
+//!             compression and the auxiliary security header with any key
+//!             identifier mode are supported.
+//!
+//!             The header layout is not computed per frame. The offsets of
+//!             the PAN IDs and addresses are looked up in a table indexed by
+//!             the addressing modes and the PAN ID compression bit of the
+//!             frame control field (FCF), the addressing modes allowed for a
+//!             frame type in a table indexed by the frame type bits, and the
+//!             length of the auxiliary security header in a table indexed by
+//!             the key identifier mode.
+//!
+//!             The codec works on the MHR and the payload, without the
+//!             length byte and without the FCS. It is used by Basic RF to
+//!             parse received frames.
+//!
+//!             HOST BUILD:
+//!             Built with BASIC_RF_FRAME_HOST, the file runs on a host PC and
+//!             also contains:
+//!             - basicRfFrameRoundTrip(), which writes a frame for every
+//!               value of the FCF and every key identifier mode, and checks
+//!               that valid frames parse back to the same descriptor and
+//!               bytes, that invalid ones are rejected, and that truncated
+//!               frames are rejected.
+//!             - basicRfFrameBenchmark(), which reports the frames parsed
+//!               and written per second for a mix of frame formats.
+//!             tools/basic_rf/frame_check.c runs both and exits non-zero if
+//!             either fails.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_FRAME_H__
+#define __BASIC_RF_FRAME_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Frame types
+#define BASIC_RF_FRAME_TYPE_BEACON          0
+#define BASIC_RF_FRAME_TYPE_DATA            1
+#define BASIC_RF_FRAME_TYPE_ACK             2
+#define BASIC_RF_FRAME_TYPE_CMD             3
+
+// Frame control field
+#define BASIC_RF_FRAME_FCF_TYPE_BM          0x0007
+#define BASIC_RF_FRAME_FCF_SEC_BM           0x0008
+#define BASIC_RF_FRAME_FCF_PENDING_BM       0x0010
+#define BASIC_RF_FRAME_FCF_ACK_REQ_BM       0x0020
+#define BASIC_RF_FRAME_FCF_PANID_COMP_BM    0x0040
+#define BASIC_RF_FRAME_FCF_DST_MODE_S       10
+#define BASIC_RF_FRAME_FCF_VERSION_S        12
+#define BASIC_RF_FRAME_FCF_SRC_MODE_S       14
+
+// Addressing modes
+#define BASIC_RF_FRAME_ADDR_NONE            0
+#define BASIC_RF_FRAME_ADDR_SHORT           2
+#define BASIC_RF_FRAME_ADDR_EXT             3
+
+// Short address field of an extended or absent address
+#define BASIC_RF_FRAME_NO_SHORT_ADDR        0xFFFE
+
+// Security control field
+#define BASIC_RF_FRAME_SEC_LEVEL_BM         0x07
+#define BASIC_RF_FRAME_SEC_KEY_ID_MODE_S    3
+#define BASIC_RF_FRAME_SEC_KEY_ID_MODE_BM   0x18
+
+#define BASIC_RF_FRAME_EXT_ADDR_SIZE        8
+#define BASIC_RF_FRAME_MAX_KEY_ID_SIZE      9
+#define BASIC_RF_FRAME_FCS_SIZE             2
+
+// Longest MHR: FCF, sequence number, two PAN IDs, two extended addresses
+// and an auxiliary security header with an 8 byte key source
+#define BASIC_RF_FRAME_MAX_HDR_SIZE         37
+
+// Longest frame without the FCS
+#define BASIC_RF_FRAME_MAX_SIZE             (127 - BASIC_RF_FRAME_FCS_SIZE)
+
+// Frame control helpers
+#define BASIC_RF_FRAME_FCF(type, dstMode, srcMode) \
+    ((uint16)(type) | ((uint16)(dstMode) << BASIC_RF_FRAME_FCF_DST_MODE_S) | \
+     ((uint16)(srcMode) << BASIC_RF_FRAME_FCF_SRC_MODE_S))
+#define BASIC_RF_FRAME_GET_TYPE(fcf)        ((uint8)((fcf) & BASIC_RF_FRAME_FCF_TYPE_BM))
+#define BASIC_RF_FRAME_GET_DST_MODE(fcf)    ((uint8)(((fcf) >> BASIC_RF_FRAME_FCF_DST_MODE_S) & 0x03))
+#define BASIC_RF_FRAME_GET_SRC_MODE(fcf)    ((uint8)(((fcf) >> BASIC_RF_FRAME_FCF_SRC_MODE_S) & 0x03))
+
+// Times the frame mix is coded by basicRfFrameBenchmark()
+#ifndef BASIC_RF_FRAME_BENCH_ROUNDS
+#define BASIC_RF_FRAME_BENCH_ROUNDS         100000
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Frame descriptor. Short address fields hold BASIC_RF_FRAME_NO_SHORT_ADDR
+// and PAN ID fields 0xFFFF when absent from the frame. Extended addresses,
+// the key identifier and the payload point into the frame buffer.
+typedef struct {
+    uint16 fcf;                 // Frame control field, selects the layout
+    uint8 seqNumber;
+    uint8 hdrLength;            // MHR length
+    uint16 dstPanId;
+    uint16 dstAddr;             // Short destination address
+    uint16 srcPanId;            // Destination PAN ID if compressed
+    uint16 srcAddr;             // Short source address
+    const uint8* pDstExtAddr;   // Extended destination address, or NULL
+    const uint8* pSrcExtAddr;   // Extended source address, or NULL
+    uint8 secControl;           // Security control, if security enabled
+    uint32 frameCounter;
+    const uint8* pKeyId;        // Key identifier, length by key id mode
+    const uint8* pPayload;
+    uint8 payloadLength;
+} basicRfFrame_t;
+
+// Round-trip check results, see basicRfFrameRoundTrip()
+typedef struct {
+    uint32 frames;              // Combinations written
+    uint32 validFrames;         // Combinations that form a valid frame
+    uint32 errors;              // Combinations that failed a check
+} basicRfFrameCheck_t;
+
+// Benchmark results, see basicRfFrameBenchmark()
+typedef struct {
+    uint32 parsedPerSec;        // Frames parsed per second
+    uint32 writtenPerSec;       // Frames written per second
+    uint32 parseNs;             // Average parse time per frame, ns
+    uint32 writeNs;             // Average write time per frame, ns
+} basicRfFrameBench_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 basicRfFrameParse(const uint8* pBuf, uint8 length, basicRfFrame_t* pFrame);
+uint8 basicRfFrameHdrLength(uint16 fcf, uint8 secControl);
+uint8 basicRfFrameWrite(const basicRfFrame_t* pFrame, uint8* pBuf);
+#ifdef BASIC_RF_FRAME_HOST
+uint8 basicRfFrameRoundTrip(basicRfFrameCheck_t* pResult);
+uint8 basicRfFrameBenchmark(basicRfFrameBench_t* pResult);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_FRAME_H__
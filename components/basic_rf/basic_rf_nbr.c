@@ -0,0 +1,574 @@
+//*****************************************************************************
+//! @file       basic_rf_nbr.c
+//! @brief      Basic RF neighbour table.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_int.h"
+#include "hal_rf.h"
+#include "basic_rf_nbr.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define NBR_NONE                            0xFF
+#define NBR_COUNTER_LIMIT                   0x8000
+
+// Entry flags
+#define NBR_FLAG_RX                         0x01    // A data frame was received
+#define NBR_FLAG_FC                         0x02    // frameCounter is valid
+#define NBR_HASH_MASK                       (BASIC_RF_NBR_HASH_SIZE - 1)
+
+#if (BASIC_RF_NBR_TABLE_SIZE < 1) || (BASIC_RF_NBR_TABLE_SIZE > 254)
+#error "BASIC_RF_NBR_TABLE_SIZE must be in the range 1-254"
+#endif
+#if (BASIC_RF_NBR_HASH_SIZE & NBR_HASH_MASK) || (BASIC_RF_NBR_HASH_SIZE > 256)
+#error "BASIC_RF_NBR_HASH_SIZE must be a power of 2 not larger than 256"
+#endif
+#if (BASIC_RF_NBR_REPLAY_WINDOW < 1) || (BASIC_RF_NBR_REPLAY_WINDOW > 32)
+#error "BASIC_RF_NBR_REPLAY_WINDOW must be in the range 1-32"
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// A table entry. Entries in use are on a hash chain and on the LRU list,
+// most recently heard first.
+typedef struct
+{
+  basicRfNbr_t nbr;
+  uint32 replayMask;      // Bit n: frameCounter - n was accepted
+  uint8 hashNext;
+  uint8 lruPrev;
+  uint8 lruNext;
+  uint8 flags;
+} basicRfNbrEntry_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static basicRfNbrEntry_t nbrTable[BASIC_RF_NBR_TABLE_SIZE];
+static uint8 nbrHash[BASIC_RF_NBR_HASH_SIZE];
+static uint8 nbrLruHead;                    // Most recently heard
+static uint8 nbrLruTail;                    // Least recently heard
+static uint8 nbrCount;
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Hash function for short addresses
+*
+* @param    addr        Short address
+*
+* @return   uint8 - Hash bucket
+******************************************************************************/
+static uint8 basicRfNbrHash(uint16 addr)
+{
+  return (uint8)((addr ^ (addr >> 8)) & NBR_HASH_MASK);
+}
+
+
+/**************************************************************************//**
+* @brief    Unlinks an entry from the LRU list
+*
+* @param    index       Table entry
+*
+* @return   None
+******************************************************************************/
+static void basicRfNbrLruUnlink(uint8 index)
+{
+  basicRfNbrEntry_t *pEntry = &nbrTable[index];
+
+  if (pEntry->lruPrev != NBR_NONE) {
+    nbrTable[pEntry->lruPrev].lruNext = pEntry->lruNext;
+  } else {
+    nbrLruHead = pEntry->lruNext;
+  }
+  if (pEntry->lruNext != NBR_NONE) {
+    nbrTable[pEntry->lruNext].lruPrev = pEntry->lruPrev;
+  } else {
+    nbrLruTail = pEntry->lruPrev;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Puts an entry first on the LRU list
+*
+* @param    index       Table entry, not on the LRU list
+*
+* @return   None
+******************************************************************************/
+static void basicRfNbrLruPushFront(uint8 index)
+{
+  basicRfNbrEntry_t *pEntry = &nbrTable[index];
+
+  pEntry->lruPrev = NBR_NONE;
+  pEntry->lruNext = nbrLruHead;
+  if (nbrLruHead != NBR_NONE) {
+    nbrTable[nbrLruHead].lruPrev = index;
+  } else {
+    nbrLruTail = index;
+  }
+  nbrLruHead = index;
+}
+
+
+/**************************************************************************//**
+* @brief    Finds the entry of a neighbour
+*
+* @param    addr        Short address
+*
+* @return   uint8 - Table entry, or NBR_NONE if not found
+******************************************************************************/
+static uint8 basicRfNbrFind(uint16 addr)
+{
+  uint8 index = nbrHash[basicRfNbrHash(addr)];
+
+  while (index != NBR_NONE && nbrTable[index].nbr.addr != addr) {
+    index = nbrTable[index].hashNext;
+  }
+  return index;
+}
+
+
+/**************************************************************************//**
+* @brief    Allocates an entry for a new neighbour, evicting the least
+*           recently used neighbour if the table is full. Neighbours with a
+*           replay window are never evicted, since an attacker could
+*           otherwise flush the window and replay old frames. The entry is
+*           put on its hash chain but not on the LRU list.
+*
+* @param    addr        Short address
+*
+* @return   uint8 - Table entry, or NBR_NONE if all entries hold a replay
+*                   window
+******************************************************************************/
+static uint8 basicRfNbrAdd(uint16 addr)
+{
+  uint8 index;
+  uint8 *pLink;
+
+  if (nbrCount < BASIC_RF_NBR_TABLE_SIZE) {
+    index = nbrCount++;
+  } else {
+    // Evict the least recently used neighbour without a replay window
+    index = nbrLruTail;
+    while (index != NBR_NONE && (nbrTable[index].flags & NBR_FLAG_FC)) {
+      index = nbrTable[index].lruPrev;
+    }
+    if (index == NBR_NONE) {
+      return NBR_NONE;
+    }
+    basicRfNbrLruUnlink(index);
+    pLink = &nbrHash[basicRfNbrHash(nbrTable[index].nbr.addr)];
+    while (*pLink != index) {
+      pLink = &nbrTable[*pLink].hashNext;
+    }
+    *pLink = nbrTable[index].hashNext;
+  }
+
+  memset(&nbrTable[index], 0, sizeof(nbrTable[index]));
+  nbrTable[index].nbr.addr = addr;
+  pLink = &nbrHash[basicRfNbrHash(addr)];
+  nbrTable[index].hashNext = *pLink;
+  *pLink = index;
+
+  return index;
+}
+
+
+/**************************************************************************//**
+* @brief    Finds or adds the entry of a neighbour and makes it the most
+*           recently used. Must be called with interrupts disabled.
+*
+* @param    addr        Short address
+*
+* @return   uint8 - Table entry, or NBR_NONE if the table is full, see
+*                   basicRfNbrAdd()
+******************************************************************************/
+static uint8 basicRfNbrTouch(uint16 addr)
+{
+  uint8 index;
+
+  index = basicRfNbrFind(addr);
+  if (index != NBR_NONE) {
+    basicRfNbrLruUnlink(index);
+  } else {
+    index = basicRfNbrAdd(addr);
+    if (index == NBR_NONE) {
+      return NBR_NONE;
+    }
+  }
+  basicRfNbrLruPushFront(index);
+
+  return index;
+}
+
+
+/**************************************************************************//**
+* @brief    Adds a sample to an average kept in 1/BASIC_RF_NBR_AVG_SCALE units
+*
+* @param    avg         Current average
+* @param    sample      New sample
+*
+* @return   int16 - New average
+******************************************************************************/
+static int16 basicRfNbrEwma(int16 avg, int16 sample)
+{
+  return avg + ((sample * BASIC_RF_NBR_AVG_SCALE - avg) >> BASIC_RF_NBR_EWMA_SHIFT);
+}
+
+
+/**************************************************************************//**
+* @brief    Returns a ratio in percent
+*
+* @param    part        Numerator
+* @param    total       Denominator
+*
+* @return   uint8 - 100 * part / total, 0 if total is 0
+******************************************************************************/
+static uint8 basicRfNbrPercent(uint16 part, uint16 total)
+{
+  if (total == 0) {
+    return 0;
+  }
+  return (uint8)(((uint32)part * 100) / total);
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Empties the neighbour table
+*
+* @return   None
+******************************************************************************/
+void basicRfNbrInit(void)
+{
+  uint16 i;
+  uint16 key;
+
+  key = halIntLock();
+  for (i = 0; i < BASIC_RF_NBR_HASH_SIZE; i++) {
+    nbrHash[i] = NBR_NONE;
+  }
+  nbrLruHead = NBR_NONE;
+  nbrLruTail = NBR_NONE;
+  nbrCount = 0;
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Records a data frame from a neighbour and checks if it is a
+*           duplicate, i.e. has the same sequence number as the previous
+*           frame from the same neighbour and was received within
+*           BASIC_RF_NBR_DUP_WINDOW symbols of it. Updates the link-quality
+*           statistics. Unknown neighbours are added to the table. Called
+*           from the RX ISR.
+*
+* @param    addr        Source short address
+* @param    seqNumber   Sequence number of the frame
+* @param    rssi        RSSI of the frame in dBm
+* @param    lqi         Correlation value of the frame
+* @param    now         MAC timer (symbols) when the frame was received
+* @param    pLost       Set to the number of frames found lost before this
+*                       one. NULL if not needed.
+*
+* @return   uint8 - TRUE if the frame is a duplicate
+******************************************************************************/
+uint8 basicRfNbrRxUpdate(uint16 addr, uint8 seqNumber, int8 rssi, uint8 lqi,
+                         uint32 now, uint8* pLost)
+{
+  basicRfNbrEntry_t *pEntry;
+  basicRfNbr_t *pNbr;
+  uint8 isDuplicate = FALSE;
+  uint8 lost = 0;
+  uint8 index;
+  uint8 gap;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfNbrTouch(addr);
+  if (index == NBR_NONE) {
+    halIntUnlock(key);
+    if (pLost != NULL) {
+      *pLost = 0;
+    }
+    return FALSE;
+  }
+  pEntry = &nbrTable[index];
+  pNbr = &pEntry->nbr;
+
+  if (pEntry->flags & NBR_FLAG_RX) {
+    pNbr->rssiAvg = basicRfNbrEwma(pNbr->rssiAvg, rssi);
+    pNbr->lqiAvg = (uint16)basicRfNbrEwma((int16)pNbr->lqiAvg, lqi);
+
+    gap = (uint8)(seqNumber - pNbr->seqNumber);
+    if (gap == 0 &&
+        ((now - pNbr->lastSeen) & HAL_RF_MAC_TIMER_MASK) < BASIC_RF_NBR_DUP_WINDOW) {
+      isDuplicate = TRUE;
+    } else if (gap > 1 && gap < BASIC_RF_NBR_MAX_SEQ_GAP) {
+      pNbr->rxLost += gap - 1;
+      lost = gap - 1;
+    }
+  } else {
+    pNbr->rssiAvg = rssi * BASIC_RF_NBR_AVG_SCALE;
+    pNbr->lqiAvg = lqi * BASIC_RF_NBR_AVG_SCALE;
+    pEntry->flags |= NBR_FLAG_RX;
+  }
+
+  if (!isDuplicate) {
+    pNbr->rxFrames++;
+    if (pNbr->rxFrames >= NBR_COUNTER_LIMIT || pNbr->rxLost >= NBR_COUNTER_LIMIT) {
+      pNbr->rxFrames >>= 1;
+      pNbr->rxLost >>= 1;
+    }
+  }
+  pNbr->seqNumber = seqNumber;
+  pNbr->lastSeen = now;
+  halIntUnlock(key);
+
+  if (pLost != NULL) {
+    *pLost = lost;
+  }
+  return isDuplicate;
+}
+
+
+/**************************************************************************//**
+* @brief    Records the outcome of a transmission that requested an
+*           acknowledgment and updates the TX power of the link. Unknown
+*           neighbours are added to the table.
+*
+* @param    addr        Destination short address
+* @param    attempts    Number of transmissions, including retries
+* @param    acked       TRUE if the last transmission was acknowledged
+*
+* @return   None
+******************************************************************************/
+void basicRfNbrTxUpdate(uint16 addr, uint8 attempts, uint8 acked)
+{
+  basicRfNbrEntry_t *pEntry;
+  basicRfNbr_t *pNbr;
+  uint8 index;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfNbrTouch(addr);
+  if (index == NBR_NONE) {
+    halIntUnlock(key);
+    return;
+  }
+  pEntry = &nbrTable[index];
+  pNbr = &pEntry->nbr;
+  basicRfTpcUpdate(&pNbr->tpc, (pEntry->flags & NBR_FLAG_RX) ?
+                   pNbr->rssiAvg : BASIC_RF_TPC_NO_RSSI, attempts, acked);
+  pNbr->txAttempts += attempts;
+  if (acked) {
+    pNbr->txAcked++;
+  }
+  if (pNbr->txAttempts >= NBR_COUNTER_LIMIT) {
+    pNbr->txAttempts >>= 1;
+    pNbr->txAcked >>= 1;
+  }
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Checks the frame counter of an authenticated frame against the
+*           replay window of the neighbour. Counters that are new and not
+*           more than BASIC_RF_NBR_REPLAY_WINDOW - 1 below the highest
+*           accepted one are accepted and recorded. Unknown senders are
+*           added to the table. Called from the RX ISR before
+*           basicRfNbrRxUpdate(), so that replays do not update the
+*           neighbour statistics.
+*
+* @param    addr            Source short address
+* @param    frameCounter    Frame counter of the frame
+*
+* @return   uint8 - TRUE if the frame is a replay and must be dropped. Also
+*                   TRUE for a new sender when every entry holds a replay
+*                   window, since its frames can not be checked.
+******************************************************************************/
+uint8 basicRfNbrReplayCheck(uint16 addr, uint32 frameCounter)
+{
+  basicRfNbrEntry_t *pEntry;
+  uint8 isReplay = FALSE;
+  uint8 index;
+  uint32 age;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfNbrTouch(addr);
+  if (index == NBR_NONE) {
+    halIntUnlock(key);
+    return TRUE;
+  }
+  pEntry = &nbrTable[index];
+
+  if (!(pEntry->flags & NBR_FLAG_FC)) {
+    pEntry->nbr.frameCounter = frameCounter;
+    pEntry->replayMask = 1;
+    pEntry->flags |= NBR_FLAG_FC;
+  } else if (frameCounter > pEntry->nbr.frameCounter) {
+    age = frameCounter - pEntry->nbr.frameCounter;
+    pEntry->replayMask = (age < 32) ? (pEntry->replayMask << age) | 1 : 1;
+    pEntry->nbr.frameCounter = frameCounter;
+  } else {
+    age = pEntry->nbr.frameCounter - frameCounter;
+    if (age >= BASIC_RF_NBR_REPLAY_WINDOW || (pEntry->replayMask & (1UL << age))) {
+      isReplay = TRUE;
+    } else {
+      pEntry->replayMask |= 1UL << age;
+    }
+  }
+  halIntUnlock(key);
+
+  return isReplay;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the state of a neighbour
+*
+* @param    addr        Short address
+* @param    pNbr        Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS, or FAILED if the neighbour is not in the table
+******************************************************************************/
+uint8 basicRfNbrGet(uint16 addr, basicRfNbr_t* pNbr)
+{
+  uint8 index;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfNbrFind(addr);
+  if (index != NBR_NONE) {
+    *pNbr = nbrTable[index].nbr;
+  }
+  halIntUnlock(key);
+
+  return (index != NBR_NONE) ? SUCCESS : FAILED;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the TX power level to use for a neighbour, see
+*           basic_rf_tpc.h
+*
+* @param    addr        Destination short address
+*
+* @return   uint8 - HAL_RF_TXPOWER_* level, the highest if the neighbour is
+*           not in the table
+******************************************************************************/
+uint8 basicRfNbrTxPower(uint16 addr)
+{
+  uint8 index;
+  uint8 power;
+  uint16 key;
+
+  key = halIntLock();
+  index = basicRfNbrFind(addr);
+  power = basicRfTpcLevel((index != NBR_NONE) ? &nbrTable[index].nbr.tpc : NULL);
+  halIntUnlock(key);
+
+  return power;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the number of neighbours in the table
+*
+* @return   uint8 - Number of neighbours
+******************************************************************************/
+uint8 basicRfNbrCount(void)
+{
+  return nbrCount;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the packet error rate of the frames received from a
+*           neighbour
+*
+* @param    pNbr        Neighbour state from basicRfNbrGet()
+*
+* @return   uint8 - Lost frames in percent of sent frames
+******************************************************************************/
+uint8 basicRfNbrPer(const basicRfNbr_t* pNbr)
+{
+  return basicRfNbrPercent(pNbr->rxLost, pNbr->rxFrames + pNbr->rxLost);
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the ratio of acknowledged transmissions to a neighbour
+*
+* @param    pNbr        Neighbour state from basicRfNbrGet()
+*
+* @return   uint8 - Acknowledged transmissions in percent of attempts
+******************************************************************************/
+uint8 basicRfNbrAckRatio(const basicRfNbr_t* pNbr)
+{
+  return basicRfNbrPercent(pNbr->txAcked, pNbr->txAttempts);
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
@@ -0,0 +1,147 @@
+//*****************************************************************************
+//! @file       basic_rf_nbr.h
+//! @brief      Basic RF neighbour table.
+//!
+//!             Keeps per-neighbour state for the Basic RF library, indexed by
+//!             short address. Lookups are hashed and the least recently used
+//!             neighbour is evicted when the table is full, so the RX ISR can
+//!             use it in constant time regardless of the number of senders.
+//!
+//!             For each neighbour the table holds the state needed for
+//!             duplicate detection and link-quality statistics: averaged RSSI
+//!             and LQI, received and lost frames, and transmission attempts
+//!             and acknowledgments. Lost frames are inferred from gaps in the
+//!             sequence numbers, which assumes the neighbour sends all its
+//!             data frames to this node.
+//!
+//!             With SECURITY_CCM each entry also holds a replay window of
+//!             the frame counters of authenticated frames. Entries with a
+//!             replay window are never evicted, so BASIC_RF_NBR_TABLE_SIZE
+//!             must hold all senders of secured frames. Once every entry
+//!             holds a window, secured frames from new senders are dropped
+//!             and unsecured senders are not tracked.
+//!
+//!             The table is updated from the RX ISR and on TX completion by
+//!             basic_rf.c. The application reads it with basicRfNbrGet() and
+//!             the basicRfNbrPer()/basicRfNbrAckRatio() helpers, e.g. for
+//!             routing decisions. The per-neighbour TX power control state
+//!             of basic_rf_tpc.h is kept here as well.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_NBR_H__
+#define __BASIC_RF_NBR_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "basic_rf_tpc.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Number of neighbours in the table. Must not be larger than 254.
+#ifndef BASIC_RF_NBR_TABLE_SIZE
+#define BASIC_RF_NBR_TABLE_SIZE             224
+#endif
+
+// Number of hash buckets. Must be a power of 2 and not larger than 256.
+#ifndef BASIC_RF_NBR_HASH_SIZE
+#define BASIC_RF_NBR_HASH_SIZE              128
+#endif
+
+// A frame with the same sequence number as the previous frame from the same
+// neighbour is only a duplicate if it arrives within this many symbols
+// (62500 symbols = 1 s). Older state is assumed stale, e.g. after a reboot.
+#ifndef BASIC_RF_NBR_DUP_WINDOW
+#define BASIC_RF_NBR_DUP_WINDOW             62500UL
+#endif
+
+// Weight of a new sample in the RSSI and LQI averages is 1/2^N
+#ifndef BASIC_RF_NBR_EWMA_SHIFT
+#define BASIC_RF_NBR_EWMA_SHIFT             3
+#endif
+
+// Sequence number gaps of this size or larger are taken as a restart of the
+// neighbour rather than lost frames
+#define BASIC_RF_NBR_MAX_SEQ_GAP            32
+
+// Scale of the rssiAvg and lqiAvg fields
+#define BASIC_RF_NBR_AVG_SCALE              16
+
+// Frame counters up to this much below the highest accepted one are
+// accepted once, to allow for reordering. At most 32.
+#define BASIC_RF_NBR_REPLAY_WINDOW          32
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Neighbour state. The counter pairs are halved together before either
+// overflows, so the ratios between them follow recent behaviour.
+typedef struct {
+    uint16 addr;                // Short address
+    uint8 seqNumber;            // Sequence number of the last data frame
+    uint32 lastSeen;            // MAC timer (symbols) of the last data frame
+    int16 rssiAvg;              // Averaged RSSI in 1/16 dBm
+    uint16 lqiAvg;              // Averaged correlation value in 1/16
+    uint16 rxFrames;            // Data frames received
+    uint16 rxLost;              // Data frames lost (sequence number gaps)
+    uint16 txAttempts;          // Transmissions, including retries, that
+                                // requested an ACK
+    uint16 txAcked;             // Acknowledged transmissions
+    uint32 frameCounter;        // Highest accepted security frame counter
+    basicRfTpcLink_t tpc;       // TX power control state
+} basicRfNbr_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+void basicRfNbrInit(void);
+uint8 basicRfNbrRxUpdate(uint16 addr, uint8 seqNumber, int8 rssi, uint8 lqi,
+                         uint32 now, uint8* pLost);
+void basicRfNbrTxUpdate(uint16 addr, uint8 attempts, uint8 acked);
+uint8 basicRfNbrTxPower(uint16 addr);
+uint8 basicRfNbrReplayCheck(uint16 addr, uint32 frameCounter);
+uint8 basicRfNbrGet(uint16 addr, basicRfNbr_t* pNbr);
+uint8 basicRfNbrCount(void);
+uint8 basicRfNbrPer(const basicRfNbr_t* pNbr);
+uint8 basicRfNbrAckRatio(const basicRfNbr_t* pNbr);
+
+
+#endif // #ifdef __BASIC_RF_NBR_H__
@@ -0,0 +1,312 @@
+//*****************************************************************************
+//! @file       basic_rf_rxq.c
+//! @brief      Basic RF receive queue.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_defs.h"
+#include "basic_rf_rxq.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define RXQ_MASK                            (BASIC_RF_RX_QUEUE_SIZE - 1)
+#if (BASIC_RF_RX_QUEUE_SIZE & RXQ_MASK) || (BASIC_RF_RX_QUEUE_SIZE > 128)
+#error "BASIC_RF_RX_QUEUE_SIZE must be a power of 2 not larger than 128"
+#endif
+
+#ifdef BASIC_RF_RXQ_HOST
+// Benchmark frames: data frames with short addresses, back-to-back at
+// 250 kbps. A frame longer than aMaxSIFSFrameSize is followed by a long
+// interframe spacing (40 symbols), a shorter one by a short one (12 symbols).
+#define RXQ_BENCH_MAC_OVERHEAD              11      // MHR and FCS
+#define RXQ_BENCH_MAC_HDR_SIZE              9
+#define RXQ_BENCH_PHY_OVERHEAD              6       // SHR and PHR
+#define RXQ_BENCH_US_PER_BYTE               32
+#define RXQ_BENCH_MAX_SIFS_SIZE             18
+#define RXQ_BENCH_LIFS_US                   640
+#define RXQ_BENCH_SIFS_US                   192
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Index rings. The counters run freely and are masked on use.
+typedef struct
+{
+  volatile uint8 readyHead; // Written by the RX ISR only
+  volatile uint8 readyTail; // Written by basicRfRxBorrow() only
+  volatile uint8 freeHead;  // Written by basicRfRxRelease() only
+  volatile uint8 freeTail;  // Written by the RX ISR only
+  uint8 ready[BASIC_RF_RX_QUEUE_SIZE];
+  uint8 free[BASIC_RF_RX_QUEUE_SIZE];
+} basicRfRxq_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static basicRfRxq_t rxq;
+static basicRfRxSlot_t rxqSlots[BASIC_RF_RX_QUEUE_SIZE];
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Empties the queue and puts all slots on the free ring. Must be
+*           called with interrupts disabled.
+*
+* @return   None
+******************************************************************************/
+void basicRfRxqInit(void)
+{
+  uint8 i;
+
+  rxq.readyHead = 0;
+  rxq.readyTail = 0;
+  rxq.freeHead = BASIC_RF_RX_QUEUE_SIZE;
+  rxq.freeTail = 0;
+  for (i = 0; i < BASIC_RF_RX_QUEUE_SIZE; i++) {
+    rxq.free[i] = i;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the slot the next received frame is read into. The slot
+*           stays on the free ring until basicRfRxqPublish() is called, so a
+*           frame that is not published, e.g. an acknowledgment, does not
+*           use it up. RX ISR only.
+*
+* @return   basicRfRxSlot_t* - Free slot, or NULL if all slots are in use
+******************************************************************************/
+basicRfRxSlot_t* basicRfRxqNext(void)
+{
+  if (rxq.freeTail == rxq.freeHead) {
+    return NULL;
+  }
+
+  return &rxqSlots[rxq.free[rxq.freeTail & RXQ_MASK]];
+}
+
+
+/**************************************************************************//**
+* @brief    Moves the slot returned by basicRfRxqNext() from the free ring to
+*           the ready ring, where the application finds it. RX ISR only.
+*
+* @return   None
+******************************************************************************/
+void basicRfRxqPublish(void)
+{
+  uint8 index;
+
+  index = rxq.free[rxq.freeTail & RXQ_MASK];
+  rxq.freeTail++;
+  rxq.ready[rxq.readyHead & RXQ_MASK] = index;
+  rxq.readyHead++;
+}
+
+
+/**************************************************************************//**
+* @brief    Check if a new packet is ready to be read by next higher layer
+*
+* @param    none
+*
+* @return   uint8 - TRUE if a packet is ready to be read by higher layer
+******************************************************************************/
+uint8 basicRfPacketIsReady(void)
+{
+  return (rxq.readyHead != rxq.readyTail);
+}
+
+
+/**************************************************************************//**
+* @brief    Takes the oldest received packet out of the RX queue without
+*           copying it. The descriptor and the payload it points to stay
+*           valid until the packet is handed back with basicRfRxRelease().
+*           Packets may be released in any order. While all
+*           BASIC_RF_RX_QUEUE_SIZE slots are borrowed, received packets are
+*           dropped. Must not be called from interrupt context.
+*
+* @return   basicRfRxFrame_t* - Received packet, or NULL if none is ready
+******************************************************************************/
+basicRfRxFrame_t* basicRfRxBorrow(void)
+{
+  uint8 index;
+
+  if (rxq.readyHead == rxq.readyTail) {
+    return NULL;
+  }
+
+  index = rxq.ready[rxq.readyTail & RXQ_MASK];
+  rxq.readyTail++;
+
+  return &rxqSlots[index].frame;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns a packet obtained with basicRfRxBorrow() to the RX pool.
+*           Must not be called from interrupt context.
+*
+* @param    pFrame      Packet to release
+*
+* @return   None
+******************************************************************************/
+void basicRfRxRelease(basicRfRxFrame_t* pFrame)
+{
+  uint8 index = (uint8)((basicRfRxSlot_t*)pFrame - rxqSlots);
+
+  rxq.free[rxq.freeHead & RXQ_MASK] = index;
+  rxq.freeHead++;
+}
+
+
+#ifdef BASIC_RF_RXQ_HOST
+/**************************************************************************//**
+* @brief    Simulates a burst of back-to-back frames received while the
+*           application is slow to drain the queue. The simulated RX ISR
+*           stores each frame when it ends, as basic_rf.c does. The
+*           application drains the queue \e drainDelay after the first frame
+*           it has not seen became ready, and then takes every ready frame.
+*           Time is simulated, so the result only depends on the parameters
+*           and BASIC_RF_RX_QUEUE_SIZE.
+*
+* @param    payloadLength   Payload length of the frames
+* @param    frames          Frames in the burst
+* @param    drainDelay      Drain latency of the application, us
+* @param    pResult         Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS, or FAILED if a parameter is out of range or the
+*                   frames were not delivered in order
+******************************************************************************/
+uint8 basicRfRxqBenchmark(uint8 payloadLength, uint16 frames,
+                          uint32 drainDelay, basicRfRxqBench_t* pResult)
+{
+  basicRfRxSlot_t* pSlot;
+  basicRfRxFrame_t* pFrame;
+  uint32 now;
+  uint32 drainAt;
+  uint32 expected;
+  uint16 sent;
+  uint8 psduLength;
+  uint8 depth;
+  uint8 drainPending;
+  uint8 status;
+
+  if (payloadLength > 127 - RXQ_BENCH_MAC_OVERHEAD || frames == 0) {
+    return FAILED;
+  }
+  psduLength = payloadLength + RXQ_BENCH_MAC_OVERHEAD;
+
+  memset(pResult, 0, sizeof(*pResult));
+  pResult->frameUs = (psduLength + RXQ_BENCH_PHY_OVERHEAD) * RXQ_BENCH_US_PER_BYTE;
+  pResult->frameUs += (psduLength > RXQ_BENCH_MAX_SIFS_SIZE) ?
+    RXQ_BENCH_LIFS_US : RXQ_BENCH_SIFS_US;
+
+  basicRfRxqInit();
+  status = SUCCESS;
+  sent = 0;
+  depth = 0;
+  drainPending = FALSE;
+  drainAt = 0;
+  expected = 0;
+
+  // Frame n ends at (n + 1) * frameUs. A drain due at the same time as a
+  // frame end comes first.
+  while (sent < frames || drainPending) {
+    now = (uint32)(sent + 1) * pResult->frameUs;
+
+    if (drainPending && (sent == frames || drainAt <= now)) {
+      // Application. Frames carry their number in the timestamp, so loss
+      // shows as a gap and reordering as a step back.
+      while ((pFrame = basicRfRxBorrow()) != NULL) {
+        if (pFrame->timestamp < expected) {
+          status = FAILED;
+        }
+        expected = pFrame->timestamp + 1;
+        basicRfRxRelease(pFrame);
+        pResult->received++;
+      }
+      depth = 0;
+      drainPending = FALSE;
+    } else {
+      // RX ISR
+      pSlot = basicRfRxqNext();
+      if (pSlot == NULL) {
+        pResult->dropped++;
+      } else {
+        memset(pSlot->mpdu, (uint8)sent, psduLength);
+        pSlot->frame.pPayload = pSlot->mpdu + RXQ_BENCH_MAC_HDR_SIZE;
+        pSlot->frame.length = payloadLength;
+        pSlot->frame.seqNumber = (uint8)sent;
+        pSlot->frame.timestamp = sent;
+        basicRfRxqPublish();
+
+        if (++depth > pResult->maxDepth) {
+          pResult->maxDepth = depth;
+        }
+        if (!drainPending) {
+          drainPending = TRUE;
+          drainAt = now + drainDelay;
+        }
+      }
+      sent++;
+    }
+  }
+
+  return status;
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
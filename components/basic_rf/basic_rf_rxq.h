@@ -0,0 +1,102 @@
+//*****************************************************************************
+//! @file       basic_rf_rxq.h
+//! @brief      Basic RF receive queue.
+//!
+//!             A pool of BASIC_RF_RX_QUEUE_SIZE frame buffers passed between
+//!             the RX ISR and the application through two index rings. The
+//!             ready ring carries filled slots from the RX ISR to
+//!             basicRfRxBorrow(), the free ring carries released slots from
+//!             basicRfRxRelease() back to the RX ISR. Each ring has one
+//!             producer and one consumer and each counter is written by one
+//!             side only, so no critical section is needed.
+//!
+//!             The RX ISR in basic_rf.c reads a frame into the slot returned
+//!             by basicRfRxqNext() and hands it over with basicRfRxqPublish().
+//!             The application side, basicRfPacketIsReady(),
+//!             basicRfRxBorrow() and basicRfRxRelease(), is declared in
+//!             basic_rf.h.
+//!
+//!             HOST BUILD:
+//!             Built with BASIC_RF_RXQ_HOST, the file runs on a host PC and
+//!             also contains basicRfRxqBenchmark(). It feeds a burst of
+//!             back-to-back frames through the queue from a simulated RX ISR
+//!             while the application drains the queue a given time after a
+//!             frame is ready, and reports how many frames survive.
+//!             tools/basic_rf/rxq_bench.c runs it for a range of delays.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_RXQ_H__
+#define __BASIC_RF_RXQ_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "basic_rf.h"
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// A receive buffer. The frame descriptor must be the first member,
+// basicRfRxRelease() maps a descriptor back to its slot.
+typedef struct {
+    basicRfRxFrame_t frame;
+    uint8 mpdu[128];
+} basicRfRxSlot_t;
+
+// Benchmark results, see basicRfRxqBenchmark()
+typedef struct {
+    uint32 frameUs;             // Time between frame ends in the burst, us
+    uint16 received;            // Frames delivered to the application
+    uint16 dropped;             // Frames dropped because the queue was full
+    uint8 maxDepth;             // Most frames waiting at once
+} basicRfRxqBench_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+void basicRfRxqInit(void);
+basicRfRxSlot_t* basicRfRxqNext(void);
+void basicRfRxqPublish(void);
+#ifdef BASIC_RF_RXQ_HOST
+uint8 basicRfRxqBenchmark(uint8 payloadLength, uint16 frames,
+                          uint32 drainDelay, basicRfRxqBench_t* pResult);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_RXQ_H__
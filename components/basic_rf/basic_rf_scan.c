@@ -0,0 +1,321 @@
+//*****************************************************************************
+//! @file       basic_rf_scan.c
+//! @brief      Basic RF energy detect channel scan.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_rf.h"
+#include "hal_timer_32k.h"
+#include "basic_rf.h"
+#include "basic_rf_scan.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// The RSSI is averaged over 8 symbol periods, so samples taken further apart
+// are independent
+#define SCAN_SAMPLE_INTERVAL                8
+
+// Sleep timer periods per second
+#define SCAN_TICKS_PER_SECOND               32768UL
+
+#define SCAN_RSSI_MIN                       (-128)
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+typedef struct {
+    uint16 dwell;
+    uint32 periodTicks;
+    uint16 blacklist;
+    uint32 lastScan;
+    uint8 bestChannel;          // 0 until the first scan
+} basicRfScanState_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static basicRfScanState_t scanState = {
+    BASIC_RF_SCAN_DWELL,
+    BASIC_RF_SCAN_PERIOD * SCAN_TICKS_PER_SECOND,
+    BASIC_RF_SCAN_BLACKLIST,
+    0,
+    0
+};
+static basicRfScanChannel_t scanTable[BASIC_RF_SCAN_CHANNELS];
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Samples the RSSI on one channel for the dwell time and records
+*           the peak and the average. The receiver must be off.
+*
+* @param    channel     Channel, 11-26
+*
+* @return   None
+******************************************************************************/
+static void basicRfScanChannel(uint8 channel)
+{
+  basicRfScanChannel_t* pEntry;
+  uint32 start;
+  uint32 elapsed;
+  uint32 nextSample;
+  int32 sum;
+  uint16 samples;
+  int8 rssi;
+
+  pEntry = &scanTable[channel - BASIC_RF_SCAN_FIRST_CHANNEL];
+  pEntry->peak = SCAN_RSSI_MIN;
+  sum = 0;
+  samples = 0;
+
+  halRfSetChannel(channel);
+  halRfReceiveOn();
+
+  start = halRfMacTimerGet();
+  nextSample = 0;
+  do {
+    elapsed = (halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK;
+    if (elapsed >= nextSample) {
+      rssi = halRfGetRssi();
+      if (rssi > pEntry->peak) {
+        pEntry->peak = rssi;
+      }
+      sum += rssi;
+      samples++;
+      nextSample += SCAN_SAMPLE_INTERVAL;
+    }
+  } while (elapsed < scanState.dwell);
+
+  halRfReceiveOff();
+
+  pEntry->average = (int8)(sum / samples);
+}
+
+
+/**************************************************************************//**
+* @brief    Selects the quietest channel of the last scan: the lowest average
+*           energy, then the lowest peak. Blacklisted channels are skipped
+*           unless all channels are blacklisted.
+*
+* @return   uint8 - Channel, 11-26
+******************************************************************************/
+static uint8 basicRfScanSelect(void)
+{
+  basicRfScanChannel_t* pEntry;
+  basicRfScanChannel_t* pBest;
+  uint8 avoidBlacklist;
+  uint8 best;
+  uint8 i;
+
+  avoidBlacklist = (scanState.blacklist & 0xFFFF) != 0xFFFF;
+  pBest = NULL;
+  best = BASIC_RF_SCAN_FIRST_CHANNEL;
+
+  for (i = 0; i < BASIC_RF_SCAN_CHANNELS; i++) {
+    pEntry = &scanTable[i];
+    if (avoidBlacklist && pEntry->blacklisted) {
+      continue;
+    }
+    if (pBest == NULL || pEntry->average < pBest->average ||
+        (pEntry->average == pBest->average && pEntry->peak < pBest->peak)) {
+      pBest = pEntry;
+      best = BASIC_RF_SCAN_FIRST_CHANNEL + i;
+    }
+  }
+
+  return best;
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Configures the scan. Without this call the defaults
+*           BASIC_RF_SCAN_DWELL, BASIC_RF_SCAN_PERIOD and
+*           BASIC_RF_SCAN_BLACKLIST are used. May be called before
+*           basicRfInit(), so that it applies to the scan for
+*           BASIC_RF_CHANNEL_AUTO.
+*
+* @param    dwell       Time spent on each channel, in symbol periods (16 us)
+* @param    period      Time between scans started by basicRfScanPoll(), in
+*                       seconds, or 0 for no periodic scans
+* @param    blacklist   Channels to avoid, bit n is channel 11 + n, e.g.
+*                       BASIC_RF_SCAN_WIFI_1_6_11
+*
+* @return   None
+******************************************************************************/
+void basicRfScanInit(uint16 dwell, uint16 period, uint16 blacklist)
+{
+  scanState.dwell = dwell;
+  scanState.periodTicks = period * SCAN_TICKS_PER_SECOND;
+  scanState.blacklist = blacklist;
+}
+
+
+/**************************************************************************//**
+* @brief    Scans channels 11-26 and selects the quietest. The receiver is
+*           returned to the operating channel afterwards, and left on if it
+*           was on. Blocks for 16 times the dwell time. Must not be called
+*           while a packet is being sent.
+*
+* @return   uint8 - The quietest channel, 11-26, or 0 if a packet is being
+*           sent
+******************************************************************************/
+uint8 basicRfScanRun(void)
+{
+  uint8 channel;
+  uint8 i;
+
+  if (basicRfTxIsBusy()) {
+    return 0;
+  }
+
+  channel = basicRfGetChannel();
+  halRfReceiveOff();
+
+  for (i = 0; i < BASIC_RF_SCAN_CHANNELS; i++) {
+    scanTable[i].blacklisted = (scanState.blacklist >> i) & 0x01;
+    basicRfScanChannel(BASIC_RF_SCAN_FIRST_CHANNEL + i);
+  }
+
+  // Called from basicRfInit() there is no operating channel yet. Setting
+  // the channel turns the receiver back on if it was on.
+  if (channel != BASIC_RF_CHANNEL_AUTO) {
+    basicRfSetChannel(channel);
+  }
+
+  scanState.lastScan = halTimer32kReadTimerValue();
+  scanState.bestChannel = basicRfScanSelect();
+
+  return scanState.bestChannel;
+}
+
+
+/**************************************************************************//**
+* @brief    Periodic scan, to be called from the main loop. Scans once every
+*           period while nothing is being sent or waiting to be read, and
+*           recommends the quietest channel if its average energy is at
+*           least BASIC_RF_SCAN_HYSTERESIS dB below that of the operating
+*           channel, or the operating channel is blacklisted. The channel
+*           is only changed if BASIC_RF_SCAN_AUTO_SWITCH is set; otherwise
+*           the application decides, since peers must move as well.
+*
+* @return   uint8 - The recommended channel (the new channel with
+*                   BASIC_RF_SCAN_AUTO_SWITCH), otherwise 0
+******************************************************************************/
+uint8 basicRfScanPoll(void)
+{
+  basicRfScanChannel_t* pCurrent;
+  basicRfScanChannel_t* pBest;
+  uint8 current;
+  uint8 best;
+
+  if (scanState.periodTicks == 0 ||
+      halTimer32kReadTimerValue() - scanState.lastScan < scanState.periodTicks) {
+    return 0;
+  }
+  if (basicRfTxIsBusy() || basicRfPacketIsReady()) {
+    return 0;
+  }
+
+  current = basicRfGetChannel();
+  best = basicRfScanRun();
+  if (best == 0 || best == current) {
+    return 0;
+  }
+
+  pCurrent = &scanTable[current - BASIC_RF_SCAN_FIRST_CHANNEL];
+  pBest = &scanTable[best - BASIC_RF_SCAN_FIRST_CHANNEL];
+  if ((pCurrent->blacklisted && !pBest->blacklisted) ||
+      pBest->average + BASIC_RF_SCAN_HYSTERESIS <= pCurrent->average) {
+#if BASIC_RF_SCAN_AUTO_SWITCH
+    basicRfSetChannel(best);
+#endif
+    return best;
+  }
+
+  return 0;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the quietest channel found by the last scan
+*
+* @return   uint8 - Channel, 11-26, or 0 if no scan has been run
+******************************************************************************/
+uint8 basicRfScanBestChannel(void)
+{
+  return scanState.bestChannel;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the per channel results of the last scan
+*
+* @param    pTable      Table of BASIC_RF_SCAN_CHANNELS entries, channel 11
+*                       first
+*
+* @return   None
+******************************************************************************/
+void basicRfScanGetTable(basicRfScanChannel_t* pTable)
+{
+  memcpy(pTable, scanTable, sizeof(scanTable));
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
@@ -0,0 +1,134 @@
+//*****************************************************************************
+//! @file       basic_rf_scan.h
+//! @brief      Basic RF energy detect channel scan.
+//!
+//!             Measures the energy on each of the channels 11-26 by sampling
+//!             the RSSI for a dwell time, keeps the peak and the average per
+//!             channel, and selects the quietest channel: the one with the
+//!             lowest average, then the lowest peak. Channels can be
+//!             blacklisted, e.g. those overlapped by Wi-Fi channels 1, 6 and
+//!             11 (BASIC_RF_SCAN_WIFI_1_6_11); a blacklisted channel is only
+//!             selected if all channels are blacklisted.
+//!
+//!             Set channel to BASIC_RF_CHANNEL_AUTO in basicRfCfg_t to have
+//!             basicRfInit() scan and use the quietest channel. Call
+//!             basicRfScanPoll() from the main loop to scan again every
+//!             period while the radio is idle. It only updates the scan
+//!             table and returns a channel that has become quieter by at
+//!             least BASIC_RF_SCAN_HYSTERESIS dB; the application decides
+//!             whether to move, and tells the other nodes. Define
+//!             BASIC_RF_SCAN_AUTO_SWITCH to 1 to have the poll move to that
+//!             channel by itself, e.g. when all nodes scan the same way.
+//!
+//!             The receiver is taken from the operating channel during a
+//!             scan, so packets sent to the node meanwhile are lost. Scans
+//!             must not be run while the channel hopping scheduler
+//!             (basic_rf_tsch.h) runs.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_SCAN_H__
+#define __BASIC_RF_SCAN_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define BASIC_RF_SCAN_FIRST_CHANNEL         11
+#define BASIC_RF_SCAN_CHANNELS              16
+
+// Time spent on each channel, in symbol periods (16 us)
+#ifndef BASIC_RF_SCAN_DWELL
+#define BASIC_RF_SCAN_DWELL                 960
+#endif
+
+// Time between scans started by basicRfScanPoll(), in seconds. 0 disables
+// periodic scans.
+#ifndef BASIC_RF_SCAN_PERIOD
+#define BASIC_RF_SCAN_PERIOD                600
+#endif
+
+// How much lower the average energy of a channel must be, in dB, before
+// basicRfScanPoll() recommends it
+#ifndef BASIC_RF_SCAN_HYSTERESIS
+#define BASIC_RF_SCAN_HYSTERESIS            6
+#endif
+
+// Set to 1 to have basicRfScanPoll() move to the recommended channel. Peers
+// are not told, so this is off by default.
+#ifndef BASIC_RF_SCAN_AUTO_SWITCH
+#define BASIC_RF_SCAN_AUTO_SWITCH           0
+#endif
+
+// Channel masks, bit n is channel 11 + n
+#define BASIC_RF_SCAN_CHANNEL_BIT(ch)       (1U << ((ch) - BASIC_RF_SCAN_FIRST_CHANNEL))
+#define BASIC_RF_SCAN_NONE                  0x0000
+
+// Channels overlapped by Wi-Fi channels 1, 6 and 11, i.e. all except 15, 20,
+// 25 and 26
+#define BASIC_RF_SCAN_WIFI_1_6_11           0x3DEF
+
+#ifndef BASIC_RF_SCAN_BLACKLIST
+#define BASIC_RF_SCAN_BLACKLIST             BASIC_RF_SCAN_NONE
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Energy measured on one channel by the last scan
+typedef struct {
+    int8 peak;                  // Highest RSSI sample, dBm
+    int8 average;               // Average of the RSSI samples, dBm
+    uint8 blacklisted;          // TRUE if never selected when avoidable
+} basicRfScanChannel_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+void basicRfScanInit(uint16 dwell, uint16 period, uint16 blacklist);
+uint8 basicRfScanRun(void);
+uint8 basicRfScanPoll(void);
+uint8 basicRfScanBestChannel(void);
+void basicRfScanGetTable(basicRfScanChannel_t* pTable);
+
+
+#endif // #ifdef __BASIC_RF_SCAN_H__
@@ -0,0 +1,465 @@
+//*****************************************************************************
+//! @file       basic_rf_sec.c
+//! @brief      Basic RF frame security.
+//!
+//!             CCM* as specified in IEEE 802.15.4-2006 annex B, with a
+//!             2 byte length field. The authentication tag is a CBC-MAC over
+//!             the header (and the payload if it is not encrypted) followed by
+//!             the payload. The payload and the tag are encrypted in counter
+//!             mode.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_defs.h"
+#include "hal_aes.h"
+#include "basic_rf_sec.h"
+#ifdef BASIC_RF_SEC_BENCHMARK
+#include "hal_rf.h"
+#endif
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Security level fields
+#define SEC_LEVEL_MIC_BM                    0x03
+#define SEC_LEVEL_ENC_BM                    0x04
+
+// CCM* flags byte: Adata, M' = (M - 2) / 2 and L' = L - 1, with L = 2
+#define CCM_FLAGS_ADATA                     0x40
+#define CCM_FLAGS_M_S                       3
+#define CCM_FLAGS_L                         0x01
+
+#ifdef BASIC_RF_SEC_BENCHMARK
+// Benchmark frames per measurement and microseconds per MAC timer symbol
+#define SEC_BENCH_ROUNDS                    64
+#define SEC_BENCH_US_PER_SYMBOL             16
+// Header with short addresses, PAN ID compression and the auxiliary
+// security header, without the length byte
+#define SEC_BENCH_HDR_LENGTH                14
+#endif
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static uint8 secNoncePrefix[BASIC_RF_SEC_NONCE_PREFIX_SIZE];
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Feeds data into a CBC-MAC. Each time a block is full it is
+*           encrypted.
+*
+* @param    pX          CBC-MAC state
+* @param    pos         Number of bytes already fed into the current block
+* @param    pData       Data
+* @param    length      Length of data
+*
+* @return   uint8 - New position in the current block, or 0xFF on an AES
+*           error
+******************************************************************************/
+static uint8 basicRfSecCbcUpdate(uint8* pX, uint8 pos, const uint8* pData,
+                                 uint8 length)
+{
+  while (length--) {
+    pX[pos++] ^= *pData++;
+    if (pos == HAL_AES_BLOCK_SIZE) {
+      if (halAesEncrypt(pX, pX) != SUCCESS) {
+        return 0xFF;
+      }
+      pos = 0;
+    }
+  }
+  return pos;
+}
+
+
+/**************************************************************************//**
+* @brief    Computes the CCM* authentication tag T
+*
+* @param    pNonce      Nonce
+* @param    micLength   Tag length M
+* @param    pAuth       Additional authenticated data a
+* @param    authLength  Length of a
+* @param    pData       Message m
+* @param    dataLength  Length of m
+* @param    pTag        Buffer for the tag, \e micLength bytes
+*
+* @return   uint8 - SUCCESS, or FAILED on an AES error
+******************************************************************************/
+static uint8 basicRfSecMac(const uint8* pNonce, uint8 micLength,
+                           const uint8* pAuth, uint8 authLength,
+                           const uint8* pData, uint8 dataLength, uint8* pTag)
+{
+  uint8 x[HAL_AES_BLOCK_SIZE];
+  uint8 pos;
+
+  // B0
+  x[0] = CCM_FLAGS_L | (((micLength - 2) / 2) << CCM_FLAGS_M_S);
+  if (authLength) {
+    x[0] |= CCM_FLAGS_ADATA;
+  }
+  memcpy(&x[1], pNonce, BASIC_RF_SEC_NONCE_SIZE);
+  x[14] = 0;
+  x[15] = dataLength;
+  if (halAesEncrypt(x, x) != SUCCESS) {
+    return FAILED;
+  }
+
+  // Length of a and a, zero padded to a whole block
+  pos = 0;
+  if (authLength) {
+    x[1] ^= authLength;
+    pos = basicRfSecCbcUpdate(x, 2, pAuth, authLength);
+    if (pos != 0 && pos != 0xFF) {
+      pos = (halAesEncrypt(x, x) == SUCCESS) ? 0 : 0xFF;
+    }
+  }
+
+  // m, zero padded to a whole block
+  if (pos == 0) {
+    pos = basicRfSecCbcUpdate(x, 0, pData, dataLength);
+    if (pos != 0 && pos != 0xFF) {
+      pos = (halAesEncrypt(x, x) == SUCCESS) ? 0 : 0xFF;
+    }
+  }
+  if (pos != 0) {
+    return FAILED;
+  }
+
+  memcpy(pTag, x, micLength);
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    CCM* counter mode. Encrypts or decrypts the message and the
+*           authentication tag in place.
+*
+* @param    pNonce      Nonce
+* @param    pData       Message, may be NULL if \e dataLength is 0
+* @param    dataLength  Length of message
+* @param    pTag        Authentication tag
+* @param    micLength   Tag length
+*
+* @return   uint8 - SUCCESS, or FAILED on an AES error
+******************************************************************************/
+static uint8 basicRfSecCtr(const uint8* pNonce, uint8* pData, uint8 dataLength,
+                           uint8* pTag, uint8 micLength)
+{
+  uint8 a[HAL_AES_BLOCK_SIZE];
+  uint8 s[HAL_AES_BLOCK_SIZE];
+  uint8 counter = 0;
+  uint8 n, i;
+
+  a[0] = CCM_FLAGS_L;
+  memcpy(&a[1], pNonce, BASIC_RF_SEC_NONCE_SIZE);
+  a[14] = 0;
+
+  // Key stream block 0 is used for the tag, blocks 1.. for the message
+  do {
+    a[15] = counter;
+    if (halAesEncrypt(a, s) != SUCCESS) {
+      return FAILED;
+    }
+    if (counter == 0) {
+      for (i = 0; i < micLength; i++) {
+        pTag[i] ^= s[i];
+      }
+    } else {
+      n = MIN(dataLength, HAL_AES_BLOCK_SIZE);
+      for (i = 0; i < n; i++) {
+        *pData++ ^= s[i];
+      }
+      dataLength -= n;
+    }
+    counter++;
+  } while (dataLength);
+
+  return SUCCESS;
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Loads the network key and the nonce prefix
+*
+* @param    pKey            Key, BASIC_RF_SEC_KEY_SIZE bytes
+* @param    pNoncePrefix    Nonce prefix, BASIC_RF_SEC_NONCE_PREFIX_SIZE
+*                           bytes. Replaces the upper half of the extended
+*                           address in the nonces of nodes that only have a
+*                           short address.
+*
+* @return   uint8 - SUCCESS, or FAILED if the key could not be loaded
+******************************************************************************/
+uint8 basicRfSecInit(const uint8* pKey, const uint8* pNoncePrefix)
+{
+  memcpy(secNoncePrefix, pNoncePrefix, BASIC_RF_SEC_NONCE_PREFIX_SIZE);
+  return halAesLoadKey(pKey);
+}
+
+
+/**************************************************************************//**
+* @brief    Builds the CCM* nonce of a frame: the source extended address and
+*           the frame counter, most significant byte first, and the security
+*           level
+*
+* @param    pNonce          Buffer for the nonce, BASIC_RF_SEC_NONCE_SIZE
+*                           bytes
+* @param    pSrcExtAddr     Source extended address, least significant byte
+*                           first, or NULL if the source has a short address
+* @param    srcPanId        Source PAN ID, used if \e pSrcExtAddr is NULL
+* @param    srcAddr         Source short address, used if \e pSrcExtAddr is
+*                           NULL
+* @param    frameCounter    Frame counter of the auxiliary security header
+* @param    level           Security level
+*
+* @return   None
+******************************************************************************/
+void basicRfSecBuildNonce(uint8* pNonce, const uint8* pSrcExtAddr,
+                          uint16 srcPanId, uint16 srcAddr,
+                          uint32 frameCounter, uint8 level)
+{
+  uint8 i;
+
+  if (pSrcExtAddr != NULL) {
+    for (i = 0; i < 8; i++) {
+      pNonce[i] = pSrcExtAddr[7 - i];
+    }
+  } else {
+    memcpy(pNonce, secNoncePrefix, BASIC_RF_SEC_NONCE_PREFIX_SIZE);
+    pNonce[4] = HI_UINT16(srcPanId);
+    pNonce[5] = LO_UINT16(srcPanId);
+    pNonce[6] = HI_UINT16(srcAddr);
+    pNonce[7] = LO_UINT16(srcAddr);
+  }
+  pNonce[8] = BREAK_UINT32(frameCounter, 3);
+  pNonce[9] = BREAK_UINT32(frameCounter, 2);
+  pNonce[10] = BREAK_UINT32(frameCounter, 1);
+  pNonce[11] = BREAK_UINT32(frameCounter, 0);
+  pNonce[12] = level;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the MIC length of a security level
+*
+* @param    level       Security level
+*
+* @return   uint8 - MIC length: 0, 4, 8 or 16 bytes
+******************************************************************************/
+uint8 basicRfSecMicLength(uint8 level)
+{
+  return (level & SEC_LEVEL_MIC_BM) ? (2 << (level & SEC_LEVEL_MIC_BM)) : 0;
+}
+
+
+/**************************************************************************//**
+* @brief    Secures a frame in place. The MIC is written after the payload
+*           and, for encrypting security levels, the payload is encrypted.
+*
+* @param    pFrame          Frame, starting with the frame control field
+* @param    hdrLength       Length of the header including the auxiliary
+*                           security header
+* @param    payloadLength   Length of the payload following the header
+* @param    pNonce          Nonce from basicRfSecBuildNonce()
+* @param    level           Security level
+*
+* @return   uint8 - SUCCESS, or FAILED on an AES error
+******************************************************************************/
+uint8 basicRfSecProtect(uint8* pFrame, uint8 hdrLength, uint8 payloadLength,
+                        const uint8* pNonce, uint8 level)
+{
+  uint8 *pPayload = pFrame + hdrLength;
+  uint8 *pMic = pPayload + payloadLength;
+  uint8 micLength = basicRfSecMicLength(level);
+
+  if (level & SEC_LEVEL_ENC_BM) {
+    if (micLength &&
+        basicRfSecMac(pNonce, micLength, pFrame, hdrLength,
+                      pPayload, payloadLength, pMic) != SUCCESS) {
+      return FAILED;
+    }
+    return basicRfSecCtr(pNonce, pPayload, payloadLength, pMic, micLength);
+  }
+
+  // Authentication only: the whole frame is authenticated data
+  if (micLength == 0) {
+    return SUCCESS;
+  }
+  if (basicRfSecMac(pNonce, micLength, pFrame, hdrLength + payloadLength,
+                    NULL, 0, pMic) != SUCCESS) {
+    return FAILED;
+  }
+  return basicRfSecCtr(pNonce, NULL, 0, pMic, micLength);
+}
+
+
+/**************************************************************************//**
+* @brief    Checks and, for encrypting security levels, decrypts a frame in
+*           place
+*
+* @param    pFrame          Frame, starting with the frame control field
+* @param    hdrLength       Length of the header including the auxiliary
+*                           security header
+* @param    payloadLength   Length of the payload, excluding the MIC
+* @param    pNonce          Nonce from basicRfSecBuildNonce()
+* @param    level           Security level
+*
+* @return   uint8 - SUCCESS if the MIC is correct, FAILED otherwise
+******************************************************************************/
+uint8 basicRfSecUnprotect(uint8* pFrame, uint8 hdrLength, uint8 payloadLength,
+                          const uint8* pNonce, uint8 level)
+{
+  uint8 *pPayload = pFrame + hdrLength;
+  uint8 *pMic = pPayload + payloadLength;
+  uint8 micLength = basicRfSecMicLength(level);
+  uint8 tag[16];
+  uint8 diff = 0;
+  uint8 i;
+
+  if (level & SEC_LEVEL_ENC_BM) {
+    if (basicRfSecCtr(pNonce, pPayload, payloadLength, pMic, micLength) != SUCCESS) {
+      return FAILED;
+    }
+    if (micLength == 0) {
+      return SUCCESS;
+    }
+    if (basicRfSecMac(pNonce, micLength, pFrame, hdrLength,
+                      pPayload, payloadLength, tag) != SUCCESS) {
+      return FAILED;
+    }
+  } else {
+    if (micLength == 0) {
+      return SUCCESS;
+    }
+    if (basicRfSecCtr(pNonce, NULL, 0, pMic, micLength) != SUCCESS ||
+        basicRfSecMac(pNonce, micLength, pFrame, hdrLength + payloadLength,
+                      NULL, 0, tag) != SUCCESS) {
+      return FAILED;
+    }
+  }
+
+  // Compare in constant time
+  for (i = 0; i < micLength; i++) {
+    diff |= tag[i] ^ pMic[i];
+  }
+  return diff ? FAILED : SUCCESS;
+}
+
+
+#ifdef BASIC_RF_SEC_BENCHMARK
+/**************************************************************************//**
+* @brief    Measures the time security adds to each transmitted and received
+*           frame, at the MIC-64 and ENC-MIC-64 security levels. Each figure
+*           is averaged over SEC_BENCH_ROUNDS frames with a payload of
+*           \e payloadLength bytes. The key must be loaded with
+*           basicRfSecInit() first. Interrupts should be disabled for
+*           accurate figures.
+*
+* @param    payloadLength   Payload length, at most 127 - 14 - 8 - 2 bytes
+* @param    pResult         Pointer to struct to fill
+*
+* @return   uint8 - SUCCESS, or FAILED on an AES error
+******************************************************************************/
+uint8 basicRfSecBenchmark(uint8 payloadLength, basicRfSecBench_t* pResult)
+{
+  static const uint8 levels[2] = {
+    BASIC_RF_SEC_LEVEL_MIC_64, BASIC_RF_SEC_LEVEL_ENC_MIC_64
+  };
+  uint8 frame[127];
+  uint8 nonce[BASIC_RF_SEC_NONCE_SIZE];
+  uint16 elapsed[4];
+  uint32 start;
+  uint8 i, round;
+  uint8 status = SUCCESS;
+
+  for (i = 0; i < sizeof(frame); i++) {
+    frame[i] = i;
+  }
+
+  for (i = 0; i < 2; i++) {
+    basicRfSecBuildNonce(nonce, NULL, 0x2007, 0x0001, i, levels[i]);
+
+    start = halRfMacTimerGet();
+    for (round = 0; round < SEC_BENCH_ROUNDS; round++) {
+      status |= basicRfSecProtect(frame, SEC_BENCH_HDR_LENGTH, payloadLength,
+                                  nonce, levels[i]);
+    }
+    elapsed[2 * i] = (uint16)((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK);
+
+    // Checking the last protected frame succeeds once, after which it is
+    // decrypted and the remaining rounds fail the MIC check. The work done
+    // is the same either way.
+    start = halRfMacTimerGet();
+    for (round = 0; round < SEC_BENCH_ROUNDS; round++) {
+      basicRfSecUnprotect(frame, SEC_BENCH_HDR_LENGTH, payloadLength,
+                          nonce, levels[i]);
+    }
+    elapsed[2 * i + 1] = (uint16)((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK);
+  }
+
+  pResult->txMic = (uint16)(((uint32)elapsed[0] * SEC_BENCH_US_PER_SYMBOL) / SEC_BENCH_ROUNDS);
+  pResult->rxMic = (uint16)(((uint32)elapsed[1] * SEC_BENCH_US_PER_SYMBOL) / SEC_BENCH_ROUNDS);
+  pResult->txEncMic = (uint16)(((uint32)elapsed[2] * SEC_BENCH_US_PER_SYMBOL) / SEC_BENCH_ROUNDS);
+  pResult->rxEncMic = (uint16)(((uint32)elapsed[3] * SEC_BENCH_US_PER_SYMBOL) / SEC_BENCH_ROUNDS);
+
+  return status ? FAILED : SUCCESS;
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
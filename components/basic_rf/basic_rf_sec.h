@@ -0,0 +1,114 @@
+//*****************************************************************************
+//! @file       basic_rf_sec.h
+//! @brief      Basic RF frame security.
+//!
+//!             IEEE 802.15.4 CCM* frame protection for the Basic RF library
+//!             when built with SECURITY_CCM. The block cipher is provided by
+//!             hal_aes.h, on the CC2538 by the AES engine. The CCM* modes
+//!             are built on top of it here so that the same code can be run
+//!             on a host PC with the software cipher (HAL_AES_SOFTWARE).
+//!
+//!             All nodes in the network share one key. The nonce is made
+//!             unique per frame from the source address and the frame
+//!             counter of the auxiliary security header. Nodes without an
+//!             extended address use a network-wide nonce prefix followed by
+//!             their PAN ID and short address in place of the extended
+//!             address.
+//!
+//!             Define BASIC_RF_SEC_BENCHMARK to include
+//!             basicRfSecBenchmark(), which measures the time added per
+//!             frame by the MIC-64 and ENC-MIC-64 security levels.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_SEC_H__
+#define __BASIC_RF_SEC_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// IEEE 802.15.4 security levels used by Basic RF. Both have an 8 byte MIC;
+// only ENC-MIC-64 encrypts the payload.
+#define BASIC_RF_SEC_LEVEL_MIC_64           2
+#define BASIC_RF_SEC_LEVEL_ENC_MIC_64       6
+
+// Security level of all secured frames
+#ifndef BASIC_RF_SEC_LEVEL
+#define BASIC_RF_SEC_LEVEL                  BASIC_RF_SEC_LEVEL_ENC_MIC_64
+#endif
+
+#define BASIC_RF_SEC_KEY_SIZE               16
+#define BASIC_RF_SEC_NONCE_SIZE             13
+
+// Length of the network-wide nonce prefix, see basicRfSecInit()
+#define BASIC_RF_SEC_NONCE_PREFIX_SIZE      4
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Time added per frame by security, in microseconds
+typedef struct {
+    uint16 txMic;               // MIC-64, protect
+    uint16 rxMic;               // MIC-64, check
+    uint16 txEncMic;            // ENC-MIC-64, protect
+    uint16 rxEncMic;            // ENC-MIC-64, check and decrypt
+} basicRfSecBench_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 basicRfSecInit(const uint8* pKey, const uint8* pNoncePrefix);
+void basicRfSecBuildNonce(uint8* pNonce, const uint8* pSrcExtAddr,
+                          uint16 srcPanId, uint16 srcAddr,
+                          uint32 frameCounter, uint8 level);
+uint8 basicRfSecMicLength(uint8 level);
+uint8 basicRfSecProtect(uint8* pFrame, uint8 hdrLength, uint8 payloadLength,
+                        const uint8* pNonce, uint8 level);
+uint8 basicRfSecUnprotect(uint8* pFrame, uint8 hdrLength, uint8 payloadLength,
+                          const uint8* pNonce, uint8 level);
+#ifdef BASIC_RF_SEC_BENCHMARK
+uint8 basicRfSecBenchmark(uint8 payloadLength, basicRfSecBench_t* pResult);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_SEC_H__
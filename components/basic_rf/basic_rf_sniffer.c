@@ -0,0 +1,524 @@
+//*****************************************************************************
+//! @file       basic_rf_sniffer.c
+//! @brief      Basic RF promiscuous sniffer.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_defs.h"
+#ifndef BASIC_RF_SNIFFER_HOST
+#include "hal_int.h"
+#include "hal_rf.h"
+#include "hal_uart.h"
+#endif
+#include "basic_rf_frame.h"
+#include "basic_rf_sniffer.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define SNIFFER_MAX_RECORD_SIZE             (BASIC_RF_SNIFFER_OVERHEAD + \
+                                             BASIC_RF_FRAME_MAX_SIZE)
+
+// Record fields
+#define SNIFFER_LEN_OFS                     2
+#define SNIFFER_TS_OFS                      3
+#define SNIFFER_RSSI_OFS                    7
+#define SNIFFER_STATUS_OFS                  8
+#define SNIFFER_CHANNEL_OFS                 9
+
+#ifndef BASIC_RF_SNIFFER_HOST
+// Status word appended by the radio in place of the FCS
+#define SNIFFER_RX_STATUS_SIZE              2
+#define SNIFFER_RX_LEN_MASK                 0x7F
+
+// Airtime of one byte in us
+#define SNIFFER_BYTE_US                     (2 * HAL_RF_SYMBOL_US)
+#else
+#define SNIFFER_TS_MASK                     0x0FFFFFFFUL
+
+// PCAP file format
+#define PCAP_MAGIC                          0xA1B2C3D4UL
+#define PCAP_VERSION_MAJOR                  2
+#define PCAP_VERSION_MINOR                  4
+#define PCAP_SNAPLEN                        65535
+#define PCAP_LINKTYPE_IEEE802_15_4_TAP      283
+
+// IEEE 802.15.4 TAP header: FCS type, RSS, channel and LQI TLVs
+#define TAP_HDR_SIZE                        36
+#define TAP_TLV_FCS_TYPE                    0
+#define TAP_TLV_RSS                         1
+#define TAP_TLV_CHANNEL                     3
+#define TAP_TLV_LQI                         10
+#define TAP_FCS_TYPE_16                     1
+
+// FCS, CRC-16 ITU-T sent least significant bit first
+#define FCS_POLY_REFLECTED                  0x8408
+#endif
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+#ifndef BASIC_RF_SNIFFER_HOST
+static basicRfSnifferStats_t stats;
+static uint8 snifferChannel;
+static uint8 record[BASIC_RF_SNIFFER_HDR_SIZE + BASIC_RF_FRAME_MAX_SIZE +
+                    SNIFFER_RX_STATUS_SIZE];
+#endif
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+#ifndef BASIC_RF_SNIFFER_HOST
+/**************************************************************************//**
+* @brief    Reads one frame from the RX FIFO and queues its record on the
+*           UART. The frame is read out of the RX FIFO even if the record
+*           does not fit.
+*
+* @return   None
+******************************************************************************/
+static void basicRfSnifferRxFrame(void)
+{
+  uint32 timestamp;
+  uint8 packetLength;
+  uint8 psduLength;
+  uint8 *pStatusWord;
+  uint8 checksum;
+  uint8 i;
+
+  halRfReadRxBuf(&packetLength, 1);
+  packetLength &= SNIFFER_RX_LEN_MASK;
+  timestamp = (halRfMacTimerGetUs() - (1 + (uint32)packetLength) * SNIFFER_BYTE_US) &
+    HAL_RF_MAC_TIMER_US_MASK;
+
+  // The PSDU goes straight to its place in the record, the status word
+  // lands where the checksum and the next bytes go
+  halRfReadRxBuf(&record[BASIC_RF_SNIFFER_HDR_SIZE], packetLength);
+  if (packetLength < SNIFFER_RX_STATUS_SIZE) {
+    stats.dropped++;
+    return;
+  }
+  psduLength = packetLength - SNIFFER_RX_STATUS_SIZE;
+  pStatusWord = &record[BASIC_RF_SNIFFER_HDR_SIZE + psduLength];
+
+  stats.frames++;
+  if (!(pStatusWord[1] & BASIC_RF_SNIFFER_CRC_OK_BM)) {
+    stats.crcErrors++;
+  }
+
+  record[0] = BASIC_RF_SNIFFER_SYNC0;
+  record[1] = BASIC_RF_SNIFFER_SYNC1;
+  record[SNIFFER_LEN_OFS] = psduLength;
+  record[SNIFFER_TS_OFS] = (uint8)timestamp;
+  record[SNIFFER_TS_OFS + 1] = (uint8)(timestamp >> 8);
+  record[SNIFFER_TS_OFS + 2] = (uint8)(timestamp >> 16);
+  record[SNIFFER_TS_OFS + 3] = (uint8)(timestamp >> 24);
+  record[SNIFFER_RSSI_OFS] = (uint8)((int8)pStatusWord[0] - halRfGetRssiOffset());
+  record[SNIFFER_STATUS_OFS] = pStatusWord[1];
+  record[SNIFFER_CHANNEL_OFS] = snifferChannel;
+
+  checksum = 0;
+  for (i = SNIFFER_LEN_OFS; i < BASIC_RF_SNIFFER_HDR_SIZE + psduLength; i++) {
+    checksum ^= record[i];
+  }
+  record[BASIC_RF_SNIFFER_HDR_SIZE + psduLength] = checksum;
+
+  if (halUartWrite(record, BASIC_RF_SNIFFER_OVERHEAD + psduLength) == SUCCESS) {
+    stats.bytes += BASIC_RF_SNIFFER_OVERHEAD + psduLength;
+  } else {
+    stats.dropped++;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Interrupt service routine for received frames. Reads all frames
+*           in the RX FIFO, like the Basic RF receive ISR.
+*
+* @return   None
+******************************************************************************/
+static void basicRfSnifferRxIsr(void)
+{
+  halRfDisableRxInterrupt();
+  halIntOn();
+
+  while (halRfRxFrameReady()) {
+    basicRfSnifferRxFrame();
+  }
+
+  if (halRfRxFifoOverflow()) {
+    stats.fifoOverflows++;
+    halRfReceiveOn();
+  }
+
+  halIntOff();
+  halRfEnableRxInterrupt();
+}
+#else
+/**************************************************************************//**
+* @brief    Reads bytes from \e pIn until \e pBuf holds \e size bytes.
+*
+* @param    pIn         Input stream
+* @param    pBuf        Buffer
+* @param    pCount      Bytes in the buffer, updated
+* @param    size        Bytes wanted
+*
+* @return   SUCCESS, or FAILED at the end of the stream
+******************************************************************************/
+static uint8 basicRfSnifferFill(FILE* pIn, uint8* pBuf, uint16* pCount,
+                                uint16 size)
+{
+  int c;
+
+  while (*pCount < size) {
+    c = getc(pIn);
+    if (c == EOF) {
+      return FAILED;
+    }
+    pBuf[(*pCount)++] = (uint8)c;
+  }
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Stores a little endian 16 or 32 bit value.
+*
+* @param    pBuf        Destination
+* @param    value       Value
+*
+* @return   None
+******************************************************************************/
+static void basicRfSnifferPut16(uint8* pBuf, uint16 value)
+{
+  pBuf[0] = (uint8)value;
+  pBuf[1] = (uint8)(value >> 8);
+}
+
+static void basicRfSnifferPut32(uint8* pBuf, uint32 value)
+{
+  basicRfSnifferPut16(pBuf, (uint16)value);
+  basicRfSnifferPut16(pBuf + 2, (uint16)(value >> 16));
+}
+
+
+/**************************************************************************//**
+* @brief    Computes the IEEE 802.15.4 FCS of a PSDU.
+*
+* @param    pData       PSDU without the FCS
+* @param    length      Length
+*
+* @return   FCS
+******************************************************************************/
+static uint16 basicRfSnifferFcs(const uint8* pData, uint8 length)
+{
+  uint16 crc = 0;
+  uint8 i;
+
+  while (length-- > 0) {
+    crc ^= *pData++;
+    for (i = 0; i < 8; i++) {
+      crc = (crc & 0x0001) ? (crc >> 1) ^ FCS_POLY_REFLECTED : crc >> 1;
+    }
+  }
+
+  return crc;
+}
+
+
+/**************************************************************************//**
+* @brief    Writes a record as a PCAP packet: record header, TAP header, the
+*           PSDU and its FCS. The FCS of a frame received with a CRC error is
+*           inverted, so that it is shown as wrong.
+*
+* @param    pRecord     Record, checked
+* @param    sec         Timestamp, seconds
+* @param    usec        Timestamp, microseconds
+* @param    pOut        Output stream
+*
+* @return   SUCCESS, or FAILED on a write error
+******************************************************************************/
+static uint8 basicRfSnifferWritePacket(const uint8* pRecord, uint32 sec,
+                                       uint32 usec, FILE* pOut)
+{
+  uint8 hdr[16 + TAP_HDR_SIZE];
+  uint8 fcs[BASIC_RF_FRAME_FCS_SIZE];
+  uint8 psduLength = pRecord[SNIFFER_LEN_OFS];
+  uint16 packetLength = TAP_HDR_SIZE + psduLength + BASIC_RF_FRAME_FCS_SIZE;
+  uint16 crc;
+  uint32 rssBits;
+  float rss;
+  uint8 *pTap = &hdr[16];
+
+  memset(hdr, 0, sizeof(hdr));
+  basicRfSnifferPut32(&hdr[0], sec);
+  basicRfSnifferPut32(&hdr[4], usec);
+  basicRfSnifferPut32(&hdr[8], packetLength);
+  basicRfSnifferPut32(&hdr[12], packetLength);
+
+  // TAP header, TLVs padded to 4 bytes
+  basicRfSnifferPut16(&pTap[2], TAP_HDR_SIZE);
+  basicRfSnifferPut16(&pTap[4], TAP_TLV_FCS_TYPE);
+  basicRfSnifferPut16(&pTap[6], 1);
+  pTap[8] = TAP_FCS_TYPE_16;
+  basicRfSnifferPut16(&pTap[12], TAP_TLV_RSS);
+  basicRfSnifferPut16(&pTap[14], 4);
+  rss = (float)(int8)pRecord[SNIFFER_RSSI_OFS];
+  memcpy(&rssBits, &rss, sizeof(rss));
+  basicRfSnifferPut32(&pTap[16], rssBits);
+  basicRfSnifferPut16(&pTap[20], TAP_TLV_CHANNEL);
+  basicRfSnifferPut16(&pTap[22], 3);
+  basicRfSnifferPut16(&pTap[24], pRecord[SNIFFER_CHANNEL_OFS]);
+  basicRfSnifferPut16(&pTap[28], TAP_TLV_LQI);
+  basicRfSnifferPut16(&pTap[30], 1);
+  pTap[32] = pRecord[SNIFFER_STATUS_OFS] & BASIC_RF_SNIFFER_CORR_BM;
+
+  crc = basicRfSnifferFcs(&pRecord[BASIC_RF_SNIFFER_HDR_SIZE], psduLength);
+  if (!(pRecord[SNIFFER_STATUS_OFS] & BASIC_RF_SNIFFER_CRC_OK_BM)) {
+    crc = ~crc;
+  }
+  basicRfSnifferPut16(fcs, crc);
+
+  if (fwrite(hdr, 1, sizeof(hdr), pOut) != sizeof(hdr) ||
+      fwrite(&pRecord[BASIC_RF_SNIFFER_HDR_SIZE], 1, psduLength, pOut) != psduLength ||
+      fwrite(fcs, 1, sizeof(fcs), pOut) != sizeof(fcs)) {
+    return FAILED;
+  }
+
+  return SUCCESS;
+}
+#endif
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+#ifndef BASIC_RF_SNIFFER_HOST
+/**************************************************************************//**
+* @brief    Initialises the radio and the UART for sniffing on \e channel and
+*           starts receiving. Replaces basicRfInit().
+*
+* @param    channel     Channel, MIN_CHANNEL to MAX_CHANNEL
+*
+* @return   SUCCESS or FAILED
+******************************************************************************/
+uint8 basicRfSnifferInit(uint8 channel)
+{
+  if (channel < MIN_CHANNEL || channel > MAX_CHANNEL)
+    return FAILED;
+
+  if (halRfInit()==FAILED)
+    return FAILED;
+  if (halUartInit(BASIC_RF_SNIFFER_BAUD)==FAILED)
+    return FAILED;
+
+  halIntOff();
+
+  memset(&stats, 0, sizeof(stats));
+  snifferChannel = channel;
+  halRfSetChannel(channel);
+
+  // Keep every frame, and do not acknowledge any
+  halRfSetPromiscuous(TRUE);
+
+  halRfRxInterruptConfig(basicRfSnifferRxIsr);
+  halRfEnableRxInterrupt();
+  halRfReceiveOn();
+
+  halIntOn();
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Moves the sniffer to another channel. Frames in the RX FIFO are
+*           discarded.
+*
+* @param    channel     Channel, MIN_CHANNEL to MAX_CHANNEL
+*
+* @return   SUCCESS, or FAILED if the channel is out of range
+******************************************************************************/
+uint8 basicRfSnifferSetChannel(uint8 channel)
+{
+  uint16 key;
+
+  if (channel < MIN_CHANNEL || channel > MAX_CHANNEL)
+    return FAILED;
+
+  key = halIntLock();
+  halRfReceiveOff();
+  snifferChannel = channel;
+  halRfSetChannel(channel);
+  halRfReceiveOn();
+  halIntUnlock(key);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the capture counters.
+*
+* @param    pStats      Destination
+*
+* @return   None
+******************************************************************************/
+void basicRfSnifferGetStats(basicRfSnifferStats_t* pStats)
+{
+  uint16 key;
+
+  key = halIntLock();
+  *pStats = stats;
+  halIntUnlock(key);
+}
+#else
+/**************************************************************************//**
+* @brief    Converts a sniffer stream to a .pcap file with the IEEE 802.15.4
+*           TAP link type. The stream may start or be cut anywhere; bytes
+*           outside records with a valid length and checksum are skipped.
+*           Record timestamps are unwrapped and counted from \e startTime.
+*
+* @param    pIn         Sniffer stream, opened in binary mode
+* @param    pOut        .pcap file, opened in binary mode
+* @param    startTime   Time of the first record, seconds since 1970
+* @param    pStats      Decoder counters
+*
+* @return   SUCCESS, or FAILED on a write error
+******************************************************************************/
+uint8 basicRfSnifferToPcap(FILE* pIn, FILE* pOut, uint32 startTime,
+                           basicRfSnifferDecodeStats_t* pStats)
+{
+  uint8 buf[SNIFFER_MAX_RECORD_SIZE];
+  uint8 fileHdr[24];
+  uint16 count = 0;
+  uint16 size;
+  uint8 checksum;
+  uint8 valid;
+  uint8 first = TRUE;
+  uint16 i;
+  uint32 timestamp;
+  uint32 lastTimestamp = 0;
+  uint32 sec = startTime;
+  uint32 usec = 0;
+  uint32 delta;
+
+  memset(pStats, 0, sizeof(*pStats));
+
+  memset(fileHdr, 0, sizeof(fileHdr));
+  basicRfSnifferPut32(&fileHdr[0], PCAP_MAGIC);
+  basicRfSnifferPut16(&fileHdr[4], PCAP_VERSION_MAJOR);
+  basicRfSnifferPut16(&fileHdr[6], PCAP_VERSION_MINOR);
+  basicRfSnifferPut32(&fileHdr[16], PCAP_SNAPLEN);
+  basicRfSnifferPut32(&fileHdr[20], PCAP_LINKTYPE_IEEE802_15_4_TAP);
+  if (fwrite(fileHdr, 1, sizeof(fileHdr), pOut) != sizeof(fileHdr)) {
+    return FAILED;
+  }
+
+  while (basicRfSnifferFill(pIn, buf, &count, BASIC_RF_SNIFFER_HDR_SIZE) == SUCCESS) {
+    valid = (buf[0] == BASIC_RF_SNIFFER_SYNC0 &&
+             buf[1] == BASIC_RF_SNIFFER_SYNC1 &&
+             buf[SNIFFER_LEN_OFS] <= BASIC_RF_FRAME_MAX_SIZE);
+    if (valid) {
+      size = BASIC_RF_SNIFFER_OVERHEAD + buf[SNIFFER_LEN_OFS];
+      valid = (basicRfSnifferFill(pIn, buf, &count, size) == SUCCESS);
+    }
+    if (valid) {
+      checksum = 0;
+      for (i = SNIFFER_LEN_OFS; i < size; i++) {
+        checksum ^= buf[i];
+      }
+      valid = (checksum == 0);
+    }
+
+    // Resynchronise one byte further on. A record cut by the end of the
+    // stream is skipped the same way.
+    if (!valid) {
+      pStats->skippedBytes++;
+      count--;
+      memmove(buf, buf + 1, count);
+      continue;
+    }
+
+    timestamp = (uint32)buf[SNIFFER_TS_OFS] |
+                ((uint32)buf[SNIFFER_TS_OFS + 1] << 8) |
+                ((uint32)buf[SNIFFER_TS_OFS + 2] << 16) |
+                ((uint32)buf[SNIFFER_TS_OFS + 3] << 24);
+    if (!first) {
+      delta = (timestamp - lastTimestamp) & SNIFFER_TS_MASK;
+      usec += delta % 1000000UL;
+      sec += delta / 1000000UL + usec / 1000000UL;
+      usec %= 1000000UL;
+    }
+    lastTimestamp = timestamp;
+    first = FALSE;
+
+    if (basicRfSnifferWritePacket(buf, sec, usec, pOut) == FAILED) {
+      return FAILED;
+    }
+    pStats->records++;
+    if (!(buf[SNIFFER_STATUS_OFS] & BASIC_RF_SNIFFER_CRC_OK_BM)) {
+      pStats->crcErrors++;
+    }
+
+    // Bytes read past the record while resynchronising come next
+    count -= size;
+    memmove(buf, buf + size, count);
+  }
+  pStats->skippedBytes += count;
+
+  return SUCCESS;
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
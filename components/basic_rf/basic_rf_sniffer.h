@@ -0,0 +1,149 @@
+//*****************************************************************************
+//! @file       basic_rf_sniffer.h
+//! @brief      Basic RF promiscuous sniffer.
+//!
+//!             Receives every frame on a channel with frame filtering and
+//!             automatic acknowledgments disabled, including frames with a
+//!             CRC error, and streams them over the UART with the RSSI, the
+//!             correlation value, the channel and a microsecond timestamp.
+//!             basicRfSnifferToPcap() turns the stream into a .pcap file
+//!             with the IEEE 802.15.4 TAP link type, which Wireshark reads.
+//!
+//!             A PCAP record header and a TAP header take 52 bytes per
+//!             frame, too much for a serial link on a busy channel, so the
+//!             device sends compact records that are expanded on the host:
+//!
+//!                 byte 0-1    BASIC_RF_SNIFFER_SYNC0, BASIC_RF_SNIFFER_SYNC1
+//!                 byte 2      PSDU length without the FCS, 0-125
+//!                 byte 3-6    Timestamp of the SFD in us, little endian,
+//!                             wraps at 2^28 (HAL_RF_MAC_TIMER_US_MASK)
+//!                 byte 7      RSSI in dBm, signed
+//!                 byte 8      Bit 7: CRC OK, bit 0-6: correlation value
+//!                 byte 9      Channel
+//!                 byte 10-    PSDU without the FCS
+//!                 last byte   XOR of the bytes from byte 2 on
+//!
+//!             A record is 11 bytes longer than the frame without its FCS.
+//!             A fully loaded channel, back-to-back frames at 250 kbps, gives
+//!             at most 40 kB/s of records (acknowledgments), below the 46 kB/s
+//!             of the default BASIC_RF_SNIFFER_BAUD. Records that do not fit
+//!             in the UART transmit buffer are dropped and counted.
+//!
+//!             The timestamp is taken when the frame is read from the RX
+//!             FIFO, less the airtime of the frame, so it is late by the
+//!             interrupt latency.
+//!
+//!             INSTRUCTIONS:
+//!             1. Call basicRfSnifferInit() instead of basicRfInit(). No other
+//!                Basic RF function may be used.
+//!             2. Change channels with basicRfSnifferSetChannel().
+//!             3. On the host, capture the UART to a file and convert it with
+//!                basicRfSnifferToPcap(), built with BASIC_RF_SNIFFER_HOST:
+//!
+//!                    basicRfSnifferToPcap(pIn, pOut, time(NULL), &stats);
+//!
+//!                tools/basic_rf/sniffer_to_pcap.c does this for a capture
+//!                file given on the command line.
+//!
+//!             HOST BUILD:
+//!             Built with BASIC_RF_SNIFFER_HOST, the file contains only the
+//!             decoder and runs on a host PC.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_SNIFFER_H__
+#define __BASIC_RF_SNIFFER_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#ifdef BASIC_RF_SNIFFER_HOST
+#include <stdio.h>
+#endif
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// UART baud rate of the stream
+#ifndef BASIC_RF_SNIFFER_BAUD
+#define BASIC_RF_SNIFFER_BAUD               460800
+#endif
+
+// Record format
+#define BASIC_RF_SNIFFER_SYNC0              0x53
+#define BASIC_RF_SNIFFER_SYNC1              0x4E
+#define BASIC_RF_SNIFFER_HDR_SIZE           10
+#define BASIC_RF_SNIFFER_OVERHEAD           (BASIC_RF_SNIFFER_HDR_SIZE + 1)
+#define BASIC_RF_SNIFFER_CRC_OK_BM          0x80
+#define BASIC_RF_SNIFFER_CORR_BM            0x7F
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Capture counters
+typedef struct {
+    uint32 frames;              // Frames received, including CRC errors
+    uint32 crcErrors;           // Frames received with a CRC error
+    uint32 dropped;             // Frames not sent: UART buffer full or
+                                // shorter than the FCS
+    uint32 fifoOverflows;       // RX FIFO overflows, frames lost
+    uint32 bytes;               // Bytes queued on the UART
+} basicRfSnifferStats_t;
+
+// Decoder counters, see basicRfSnifferToPcap()
+typedef struct {
+    uint32 records;             // Records written to the .pcap file
+    uint32 crcErrors;           // Records of frames with a CRC error
+    uint32 skippedBytes;        // Bytes outside valid records
+} basicRfSnifferDecodeStats_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+#ifndef BASIC_RF_SNIFFER_HOST
+uint8 basicRfSnifferInit(uint8 channel);
+uint8 basicRfSnifferSetChannel(uint8 channel);
+void basicRfSnifferGetStats(basicRfSnifferStats_t* pStats);
+#else
+uint8 basicRfSnifferToPcap(FILE* pIn, FILE* pOut, uint32 startTime,
+                           basicRfSnifferDecodeStats_t* pStats);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_SNIFFER_H__
@@ -0,0 +1,435 @@
+//*****************************************************************************
+//! @file       basic_rf_tpc.c
+//! @brief      Basic RF per-destination TX power control.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#ifdef BASIC_RF_TPC_SIM
+#include <math.h>
+#endif
+#include "hal_defs.h"
+#include "hal_rf.h"
+#include "basic_rf_tpc.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Scale of the rssiAvg argument, as BASIC_RF_NBR_AVG_SCALE
+#define TPC_RSSI_SCALE                      16
+
+#ifdef BASIC_RF_TPC_SIM
+// Retransmissions per frame, as maxFrameRetries in basicRfCfg_t
+#define TPC_SIM_RETRIES                     3
+
+// Path loss at 1 m, 2.4 GHz
+#define TPC_SIM_PL0                         40.0
+
+// PHY header and MAC overhead of a frame, and airtime of one byte
+#define TPC_SIM_FRAME_OVERHEAD              (6 + 11)
+#define TPC_SIM_US_PER_BYTE                 32
+
+// Supply voltage, V
+#define TPC_SIM_VOLTAGE                     3
+#endif
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static uint8 tpcLevels[BASIC_RF_TPC_MAX_LEVELS];
+static int8 tpcDbm[BASIC_RF_TPC_MAX_LEVELS];
+static uint8 tpcCount;
+
+#ifdef BASIC_RF_TPC_SIM
+// CC2538 + CC2592 levels and their approximate supply current in mA
+static const uint8 tpcSimLevels[] = {
+    HAL_RF_TXPOWER_0_DBM, HAL_RF_TXPOWER_4_DBM, HAL_RF_TXPOWER_7_DBM,
+    HAL_RF_TXPOWER_13_DBM, HAL_RF_TXPOWER_16_DBM, HAL_RF_TXPOWER_20_DBM,
+    HAL_RF_TXPOWER_22_DBM
+};
+static const uint8 tpcSimCurrent[] = { 40, 45, 52, 70, 85, 115, 140 };
+
+static uint32 tpcSimRandState;
+static double tpcSimPathLoss[BASIC_RF_TPC_SIM_MAX_NODES][BASIC_RF_TPC_SIM_MAX_NODES];
+#endif
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+#ifdef BASIC_RF_TPC_SIM
+/**************************************************************************//**
+* @brief    Returns a uniformly distributed random number
+*
+* @return   double - In [0, 1)
+******************************************************************************/
+static double basicRfTpcSimUniform(void)
+{
+  tpcSimRandState = tpcSimRandState * 1664525UL + 1013904223UL;
+  return (double)((tpcSimRandState >> 8) & 0xFFFFFF) / 16777216.0;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns a normally distributed random number
+*
+* @param    sigma       Standard deviation
+*
+* @return   double - Zero mean random number
+******************************************************************************/
+static double basicRfTpcSimNormal(double sigma)
+{
+  double u = basicRfTpcSimUniform();
+
+  if (u < 1e-9) {
+    u = 1e-9;
+  }
+  return sigma * sqrt(-2.0 * log(u)) * cos(6.283185307 * basicRfTpcSimUniform());
+}
+
+
+/**************************************************************************//**
+* @brief    Checks if a frame is received. The chance rises from none to
+*           certain over 4 dB around the sensitivity.
+*
+* @param    rssi        RSSI of the frame, dBm
+*
+* @return   uint8 - TRUE if the frame is received
+******************************************************************************/
+static uint8 basicRfTpcSimReceived(double rssi)
+{
+  return rssi + 4.0 * basicRfTpcSimUniform() - 2.0 >= BASIC_RF_TPC_SENSITIVITY;
+}
+
+
+/**************************************************************************//**
+* @brief    Runs all nodes' frames once
+*
+* @param    pCfg        Simulation set-up
+* @param    control     TRUE for power control, FALSE for the highest level
+* @param    pRun        Results
+*
+* @return   None
+******************************************************************************/
+static void basicRfTpcSimRun(const basicRfTpcSimCfg_t* pCfg, uint8 control,
+                             basicRfTpcSimRun_t* pRun)
+{
+  basicRfTpcLink_t links[BASIC_RF_TPC_SIM_MAX_NODES];
+  int16 rssiAvg[BASIC_RF_TPC_SIM_MAX_NODES];
+  uint8 top = tpcCount - 1;
+  uint8 level;
+  uint8 attempts;
+  uint8 acked;
+  uint8 i, k;
+  uint16 frame;
+  double airtime;
+  double energy = 0;
+  double power = 0;
+  uint32 reach = 0;
+  double rssi;
+
+  memset(pRun, 0, sizeof(*pRun));
+  memset(links, 0, sizeof(links));
+  tpcSimRandState = pCfg->seed;
+  airtime = (double)(TPC_SIM_FRAME_OVERHEAD + pCfg->payloadLength) *
+            TPC_SIM_US_PER_BYTE;
+
+  // Each node first hears the sink once
+  for (i = 1; i < pCfg->nodes; i++) {
+    rssi = tpcDbm[top] - tpcSimPathLoss[0][i] + basicRfTpcSimNormal(pCfg->fading);
+    rssiAvg[i] = (int16)(rssi * TPC_RSSI_SCALE);
+  }
+
+  for (frame = 0; frame < pCfg->frames; frame++) {
+    for (i = 1; i < pCfg->nodes; i++) {
+      level = control ? (uint8)(top - MIN(links[i].drop, top)) : top;
+      acked = FALSE;
+
+      for (attempts = 1; attempts <= TPC_SIM_RETRIES + 1 && !acked; attempts++) {
+        pRun->attempts++;
+        energy += tpcSimCurrent[level] * TPC_SIM_VOLTAGE * airtime;
+        power += tpcDbm[level];
+        for (k = 1; k < pCfg->nodes; k++) {
+          if (k != i && tpcDbm[level] - tpcSimPathLoss[i][k] >= pCfg->interference) {
+            reach++;
+          }
+        }
+
+        // Frame to the sink and hardware ACK at the highest level
+        rssi = tpcDbm[level] - tpcSimPathLoss[i][0] +
+               basicRfTpcSimNormal(pCfg->fading);
+        if (basicRfTpcSimReceived(rssi)) {
+          rssi = tpcDbm[top] - tpcSimPathLoss[0][i] +
+                 basicRfTpcSimNormal(pCfg->fading);
+          acked = basicRfTpcSimReceived(rssi);
+        }
+      }
+      attempts--;
+
+      if (acked) {
+        pRun->delivered++;
+      }
+      if (control) {
+        basicRfTpcUpdate(&links[i], rssiAvg[i], attempts, acked);
+      }
+
+      // Frame from the sink, averaged as in the neighbour table
+      rssi = tpcDbm[top] - tpcSimPathLoss[0][i] + basicRfTpcSimNormal(pCfg->fading);
+      rssiAvg[i] += ((int16)(rssi * TPC_RSSI_SCALE) - rssiAvg[i]) >> 3;
+    }
+  }
+
+  if (pRun->delivered != 0) {
+    pRun->energy = (uint32)(energy / 1000.0 / pRun->delivered);
+  }
+  if (pRun->attempts != 0) {
+    pRun->reach = (uint16)((reach * 100) / pRun->attempts);
+    pRun->avgPower = (int16)((power * 10) / pRun->attempts);
+  }
+}
+#endif
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+
+/**************************************************************************//**
+* @brief    Sets the TX power levels the controller chooses from
+*
+* @param    pLevels     HAL_RF_TXPOWER_* levels, lowest first. NULL for the
+*                       levels of the module in use up to the one set with
+*                       halRfSetTxPower().
+* @param    nLevels     Number of levels, ignored if pLevels is NULL
+*
+* @return   uint8 - SUCCESS, or FAILED if there are no or too many levels
+******************************************************************************/
+uint8 basicRfTpcInit(const uint8* pLevels, uint8 nLevels)
+{
+  uint8 i;
+#ifndef BASIC_RF_TPC_SIM
+  int8 maxDbm;
+
+  if (pLevels == NULL) {
+    nLevels = halRfGetTxPowerLevels(&pLevels);
+    maxDbm = HAL_RF_TXPOWER_DBM(halRfGetTxPower());
+    while (nLevels > 1 && HAL_RF_TXPOWER_DBM(pLevels[nLevels - 1]) > maxDbm) {
+      nLevels--;
+    }
+  }
+#else
+  if (pLevels == NULL) {
+    pLevels = tpcSimLevels;
+    nLevels = sizeof(tpcSimLevels);
+  }
+#endif
+  if (nLevels == 0 || nLevels > BASIC_RF_TPC_MAX_LEVELS) {
+    return FAILED;
+  }
+
+  for (i = 0; i < nLevels; i++) {
+    tpcLevels[i] = pLevels[i];
+    tpcDbm[i] = HAL_RF_TXPOWER_DBM(pLevels[i]);
+  }
+  tpcCount = nLevels;
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Updates the level of a link after a packet with acknowledgment
+*           request has been sent
+*
+* @param    pLink       Link state
+* @param    rssiAvg     Averaged RSSI of the frames from the neighbour in
+*                       1/16 dBm, or BASIC_RF_TPC_NO_RSSI
+* @param    attempts    Transmissions of the packet, including retries
+* @param    acked       TRUE if the packet was acknowledged
+*
+* @return   None
+******************************************************************************/
+void basicRfTpcUpdate(basicRfTpcLink_t* pLink, int16 rssiAvg, uint8 attempts,
+                      uint8 acked)
+{
+  uint8 top;
+  uint8 want;
+  int16 margin;
+
+  if (tpcCount == 0) {
+    return;
+  }
+  top = tpcCount - 1;
+
+  if (!acked) {
+    if (pLink->drop > 0) {
+      pLink->drop--;
+    }
+    pLink->hold = BASIC_RF_TPC_HOLD;
+    return;
+  }
+  if (attempts > 1) {
+    pLink->hold = BASIC_RF_TPC_HOLD;
+    return;
+  }
+  if (pLink->hold > 0) {
+    pLink->hold--;
+    return;
+  }
+  if (rssiAvg == BASIC_RF_TPC_NO_RSSI) {
+    return;
+  }
+
+  // Lowest level with the target margin, assuming the neighbour sends at the
+  // highest level
+  margin = rssiAvg / TPC_RSSI_SCALE - BASIC_RF_TPC_SENSITIVITY;
+  want = 0;
+  while (want < top &&
+         margin - (tpcDbm[top] - tpcDbm[top - want - 1]) >= BASIC_RF_TPC_TARGET_MARGIN) {
+    want++;
+  }
+
+  // Step down slowly, up at once
+  if (want > pLink->drop) {
+    pLink->drop++;
+  } else {
+    pLink->drop = want;
+  }
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the TX power level of a link
+*
+* @param    pLink       Link state, NULL for the highest level
+*
+* @return   uint8 - HAL_RF_TXPOWER_* level
+******************************************************************************/
+uint8 basicRfTpcLevel(const basicRfTpcLink_t* pLink)
+{
+  uint8 top;
+
+  if (tpcCount == 0) {
+#ifndef BASIC_RF_TPC_SIM
+    return halRfGetTxPower();
+#else
+    return HAL_RF_TXPOWER_0_DBM;
+#endif
+  }
+  top = tpcCount - 1;
+  if (pLink == NULL) {
+    return tpcLevels[top];
+  }
+  return tpcLevels[top - MIN(pLink->drop, top)];
+}
+
+
+#ifdef BASIC_RF_TPC_SIM
+/**************************************************************************//**
+* @brief    Host simulation of power control in a star network, see
+*           basic_rf_tpc.h. Placement, shadowing and fading are the same for
+*           both runs.
+*
+* @param    pCfg        Simulation set-up
+* @param    pResult     Results
+*
+* @return   None
+******************************************************************************/
+void basicRfTpcSimulate(const basicRfTpcSimCfg_t* pCfg,
+                        basicRfTpcSimResult_t* pResult)
+{
+  basicRfTpcSimCfg_t cfg = *pCfg;
+  double x[BASIC_RF_TPC_SIM_MAX_NODES];
+  double y[BASIC_RF_TPC_SIM_MAX_NODES];
+  double d;
+  uint8 i, k;
+
+  memset(pResult, 0, sizeof(*pResult));
+  if (cfg.nodes < 2) {
+    return;
+  }
+  cfg.nodes = MIN(cfg.nodes, BASIC_RF_TPC_SIM_MAX_NODES);
+  basicRfTpcInit(tpcSimLevels, sizeof(tpcSimLevels));
+
+  // The sink is node 0, in the centre. Links are symmetric.
+  tpcSimRandState = cfg.seed ^ 0x5A5A5A5AUL;
+  x[0] = cfg.areaSize / 2.0;
+  y[0] = cfg.areaSize / 2.0;
+  for (i = 1; i < cfg.nodes; i++) {
+    x[i] = cfg.areaSize * basicRfTpcSimUniform();
+    y[i] = cfg.areaSize * basicRfTpcSimUniform();
+  }
+  for (i = 0; i < cfg.nodes; i++) {
+    tpcSimPathLoss[i][i] = 0;
+    for (k = i + 1; k < cfg.nodes; k++) {
+      d = sqrt((x[i] - x[k]) * (x[i] - x[k]) + (y[i] - y[k]) * (y[i] - y[k]));
+      d = MAX(d, 1.0);
+      tpcSimPathLoss[i][k] = TPC_SIM_PL0 + cfg.pathLossExp * log10(d) +
+                             basicRfTpcSimNormal(cfg.shadowing);
+      tpcSimPathLoss[k][i] = tpcSimPathLoss[i][k];
+    }
+  }
+
+  basicRfTpcSimRun(&cfg, FALSE, &pResult->fixed);
+  basicRfTpcSimRun(&cfg, TRUE, &pResult->tpc);
+
+  if (pResult->fixed.energy != 0 && pResult->tpc.energy <= pResult->fixed.energy) {
+    pResult->energySaved = (uint8)(100 - (pResult->tpc.energy * 100) /
+                                         pResult->fixed.energy);
+  }
+  if (pResult->fixed.reach != 0 && pResult->tpc.reach <= pResult->fixed.reach) {
+    pResult->reachReduced = (uint8)(100 - ((uint32)pResult->tpc.reach * 100) /
+                                          pResult->fixed.reach);
+  }
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
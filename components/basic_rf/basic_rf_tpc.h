@@ -0,0 +1,170 @@
+//*****************************************************************************
+//! @file       basic_rf_tpc.h
+//! @brief      Basic RF per-destination TX power control.
+//!
+//!             Picks for each neighbour the lowest TX power level that keeps
+//!             the link margin above BASIC_RF_TPC_TARGET_MARGIN, so that
+//!             nearby nodes are not reached at full power. Enabled with
+//!             txPowerControl in basicRfCfg_t; the level is written to the
+//!             radio just before each frame is loaded into the TX FIFO, and
+//!             the level set with halRfSetTxPower() is restored when the TX
+//!             queue is empty, so broadcasts and acknowledgments are sent at
+//!             that level. It is also the highest level used, so set it
+//!             before basicRfInit().
+//!
+//!             The controller is closed over two kinds of feedback, both
+//!             kept per neighbour in the neighbour table (basic_rf_nbr.h):
+//!
+//!             - RSSI: the averaged RSSI of the frames received from the
+//!               neighbour gives the path loss, assuming the neighbour sends
+//!               at the highest level. The margin at a lower level is that
+//!               much less. A neighbour that itself sends at a lower level
+//!               only makes the estimate pessimistic.
+//!             - ACKs: a packet that needed retries holds the level for
+//!               BASIC_RF_TPC_HOLD packets, and an unacknowledged packet
+//!               also raises it one step. Otherwise the level is lowered one
+//!               step per acknowledged packet towards the estimate, and
+//!               raised to it at once.
+//!
+//!             Neighbours that have not been heard from, and packets without
+//!             acknowledgment request, are sent at the highest level.
+//!
+//!             SIMULATION:
+//!             Built with BASIC_RF_TPC_SIM, the file contains only the
+//!             controller and basicRfTpcSimulate(), and runs on a host PC.
+//!             Nodes placed at random send to a sink over log-distance path
+//!             loss links with shadowing and fading, once at the highest
+//!             level and once with power control, using the CC2538 + CC2592
+//!             levels. The energy per delivered frame and the number of
+//!             other nodes each transmission reaches are reported for both.
+//!             The sink is assumed to send each node one frame per frame it
+//!             receives, at the highest level, which feeds the RSSI
+//!             average. tools/basic_rf/tpc_sim.c runs the simulation.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_TPC_H__
+#define __BASIC_RF_TPC_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Link margin to keep, in dB
+#ifndef BASIC_RF_TPC_TARGET_MARGIN
+#define BASIC_RF_TPC_TARGET_MARGIN          10
+#endif
+
+// Receiver sensitivity, in dBm
+#ifndef BASIC_RF_TPC_SENSITIVITY
+#define BASIC_RF_TPC_SENSITIVITY            (-97)
+#endif
+
+// Packets the level is held for after a packet needed retries
+#ifndef BASIC_RF_TPC_HOLD
+#define BASIC_RF_TPC_HOLD                   16
+#endif
+
+// Most levels of a module
+#define BASIC_RF_TPC_MAX_LEVELS             8
+
+// basicRfTpcUpdate() rssiAvg when nothing has been received from the
+// neighbour. Otherwise rssiAvg is in 1/16 dBm, as in basic_rf_nbr.h.
+#define BASIC_RF_TPC_NO_RSSI                ((int16)0x8000)
+
+// Most nodes of a simulation
+#define BASIC_RF_TPC_SIM_MAX_NODES          32
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Controller state of one link. All zero is the highest level.
+typedef struct {
+    uint8 drop;                 // Levels below the highest
+    uint8 hold;                 // Packets left before the level may drop
+} basicRfTpcLink_t;
+
+// Simulation set-up, see basicRfTpcSimulate()
+typedef struct {
+    uint8 nodes;                // Nodes, including the sink in the centre
+    uint8 areaSize;             // Side of the square area, m
+    uint16 frames;              // Frames sent by each node
+    uint8 payloadLength;        // Payload of each frame, bytes
+    uint8 pathLossExp;          // Path loss exponent, in 1/10
+    uint8 shadowing;            // Link shadowing standard deviation, dB
+    uint8 fading;               // Per-frame fading standard deviation, dB
+    int8 interference;          // RSSI at which a frame disturbs a node, dBm
+    uint32 seed;                // Random seed
+} basicRfTpcSimCfg_t;
+
+// Results of one run
+typedef struct {
+    uint32 attempts;            // Transmissions, including retries
+    uint32 delivered;           // Frames acknowledged
+    uint32 energy;              // TX energy per delivered frame, uJ
+    uint16 reach;               // Other nodes disturbed per transmission,
+                                // in 1/100
+    int16 avgPower;             // Average TX power, in 1/10 dBm
+} basicRfTpcSimRun_t;
+
+// Simulation results
+typedef struct {
+    basicRfTpcSimRun_t fixed;   // All frames at the highest level
+    basicRfTpcSimRun_t tpc;     // With power control
+    uint8 energySaved;          // Energy per delivered frame saved, %
+    uint8 reachReduced;         // Disturbed nodes per transmission, % less
+} basicRfTpcSimResult_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 basicRfTpcInit(const uint8* pLevels, uint8 nLevels);
+void basicRfTpcUpdate(basicRfTpcLink_t* pLink, int16 rssiAvg, uint8 attempts,
+                      uint8 acked);
+uint8 basicRfTpcLevel(const basicRfTpcLink_t* pLink);
+#ifdef BASIC_RF_TPC_SIM
+void basicRfTpcSimulate(const basicRfTpcSimCfg_t* pCfg,
+                        basicRfTpcSimResult_t* pResult);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_TPC_H__
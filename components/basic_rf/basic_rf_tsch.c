@@ -0,0 +1,650 @@
+//*****************************************************************************
+//! @file       basic_rf_tsch.c
+//! @brief      Basic RF time-slotted channel hopping.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup basic_rf_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#ifndef BASIC_RF_TSCH_SIM
+#include "hal_int.h"
+#include "hal_rf.h"
+#include "hal_timer_32k.h"
+#endif
+#include "basic_rf.h"
+#include "basic_rf_tsch.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// A slot is BASIC_RF_TSCH_SLOT_US * 32768 / 1000000 sleep timer periods,
+// i.e. BASIC_RF_TSCH_SLOT_US * 512 / 15625. The fraction of a period that
+// is left over is carried to the next slot, so that slot boundaries do not
+// drift.
+#define TSCH_TICKS_NUM                      (BASIC_RF_TSCH_SLOT_US * 512)
+#define TSCH_TICKS_DEN                      15625
+
+// Boundary error in ns of a carried fraction: 10^9 / 32768 / 15625 = 125 / 64
+#define TSCH_FRACTION_TO_NS(f)              (((uint32)(f) * 125) >> 6)
+
+// The sleep timer compare value must be this far ahead to be reached
+#define TSCH_MIN_LEAD_TICKS                 3
+
+#define TSCH_QUEUE_NONE                     0xFF
+
+#if (BASIC_RF_TSCH_MAX_CELLS < 1) || (BASIC_RF_TSCH_MAX_CELLS > 255)
+#error "BASIC_RF_TSCH_MAX_CELLS must be in the range 1-255"
+#endif
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// Slot engine state
+typedef struct
+{
+  uint32 asn;                   // ASN of the current slot
+  uint32 slotStart;             // Sleep timer at the start of the current slot
+  uint32 nextStart;             // Sleep timer at the start of the next slot
+  uint16 tickFraction;          // Carried fraction, in 1/TSCH_TICKS_DEN
+  uint16 slotframeLength;
+  uint8 nCells;
+  uint8 hopSeqLength;
+  volatile uint8 running;
+  uint8 txEntry;                // Queue entry in flight, TSCH_QUEUE_NONE
+} basicRfTsch_t;
+
+// A packet waiting for a cell
+typedef struct
+{
+  uint16 destAddr;
+  uint8 length;
+  uint8 retries;
+  uint8 payload[BASIC_RF_MAX_PAYLOAD_SIZE];
+} basicRfTschTxEntry_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+// Default hopping sequence of the 16 channels
+static const uint8 tschDefaultHopSeq[BASIC_RF_TSCH_MAX_HOP_SEQ] = {
+  16, 17, 23, 18, 26, 15, 25, 22, 19, 11, 12, 13, 24, 14, 20, 21
+};
+
+static basicRfTsch_t tsch;
+static uint8 tschHopSeq[BASIC_RF_TSCH_MAX_HOP_SEQ];
+
+// Cells sorted by slot offset
+static basicRfTschCell_t tschCells[BASIC_RF_TSCH_MAX_CELLS];
+
+#ifndef BASIC_RF_TSCH_SIM
+// The first tschQueued entries of tschOrder are the queued packets, oldest
+// first. The rest are the free entries.
+static basicRfTschTxEntry_t tschQueue[BASIC_RF_TSCH_QUEUE_SIZE];
+static uint8 tschOrder[BASIC_RF_TSCH_QUEUE_SIZE];
+static uint8 tschQueued;
+static basicRfTschStats_t tschStats;
+#endif
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Returns the length of the next slot in sleep timer periods. Slots
+*           are one period shorter or longer than the average as needed to
+*           keep every boundary within one period of its ideal time.
+*
+* @return   uint16 - Slot length
+******************************************************************************/
+static uint16 basicRfTschSlotTicks(void)
+{
+  uint32 n = TSCH_TICKS_NUM + tsch.tickFraction;
+
+  tsch.tickFraction = (uint16)(n % TSCH_TICKS_DEN);
+  return (uint16)(n / TSCH_TICKS_DEN);
+}
+
+
+/**************************************************************************//**
+* @brief    Moves the slot engine to the next slot
+*
+* @return   uint16 - Length of the slot after the new current slot
+******************************************************************************/
+static uint16 basicRfTschAdvance(void)
+{
+  uint16 ticks = basicRfTschSlotTicks();
+
+  tsch.asn++;
+  tsch.slotStart = tsch.nextStart;
+  tsch.nextStart += ticks;
+  return ticks;
+}
+
+
+/**************************************************************************//**
+* @brief    Finds the cell of a slot in the sorted cell table by binary
+*           search
+*
+* @param    slotOffset      Slot in the slotframe
+* @param    pSteps          Set to the number of cells compared
+*
+* @return   Cell, or NULL if the slot has no cell
+******************************************************************************/
+static const basicRfTschCell_t* basicRfTschLookup(uint16 slotOffset,
+                                                  uint8* pSteps)
+{
+  uint8 lo = 0;
+  uint8 hi = tsch.nCells;
+  uint8 mid;
+
+  *pSteps = 0;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    (*pSteps)++;
+    if (tschCells[mid].slotOffset == slotOffset) {
+      return &tschCells[mid];
+    }
+    if (tschCells[mid].slotOffset < slotOffset) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return NULL;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the channel of a cell in the current slot
+*
+* @param    pCell           Cell
+*
+* @return   uint8 - Channel, 11-26
+******************************************************************************/
+static uint8 basicRfTschChannel(const basicRfTschCell_t* pCell)
+{
+  return tschHopSeq[(tsch.asn + pCell->channelOffset) % tsch.hopSeqLength];
+}
+
+
+#ifndef BASIC_RF_TSCH_SIM
+/**************************************************************************//**
+* @brief    Removes a packet from the queue. Must be called with interrupts
+*           disabled.
+*
+* @param    pos             Position in tschOrder
+*
+* @return   None
+******************************************************************************/
+static void basicRfTschDequeue(uint8 pos)
+{
+  uint8 index = tschOrder[pos];
+
+  tschQueued--;
+  memmove(&tschOrder[pos], &tschOrder[pos + 1], tschQueued - pos);
+  tschOrder[tschQueued] = index;
+}
+
+
+/**************************************************************************//**
+* @brief    TX done callback for packets sent in a cell. Called from
+*           interrupt context.
+*
+* @param    seqNumber       Sequence number of the packet
+* @param    result          BASIC_RF_TX_* result
+* @param    retries         Number of retransmissions
+*
+* @return   None
+******************************************************************************/
+static void basicRfTschTxDone(uint8 seqNumber, uint8 result, uint8 retries)
+{
+  uint8 pos;
+
+  (void)seqNumber;
+  (void)retries;
+
+  for (pos = 0; pos < tschQueued; pos++) {
+    if (tschOrder[pos] == tsch.txEntry) {
+      break;
+    }
+  }
+  if (pos == tschQueued) {
+    tsch.txEntry = TSCH_QUEUE_NONE;
+    return;
+  }
+
+  if (result == BASIC_RF_TX_SENT || result == BASIC_RF_TX_ACKED) {
+    tschStats.txPackets++;
+    basicRfTschDequeue(pos);
+  } else if (++tschQueue[tsch.txEntry].retries > BASIC_RF_TSCH_MAX_RETRIES) {
+    tschStats.txFailed++;
+    basicRfTschDequeue(pos);
+  }
+  tsch.txEntry = TSCH_QUEUE_NONE;
+}
+
+
+/**************************************************************************//**
+* @brief    Finds the oldest queued packet that may be sent in a TX cell
+*
+* @param    neighbour       Destination of the cell, BASIC_RF_BROADCAST_ADDR
+*                           for any
+*
+* @return   Queue entry, or TSCH_QUEUE_NONE
+******************************************************************************/
+static uint8 basicRfTschTxPick(uint16 neighbour)
+{
+  uint8 pos;
+
+  for (pos = 0; pos < tschQueued; pos++) {
+    if (neighbour == BASIC_RF_BROADCAST_ADDR ||
+        tschQueue[tschOrder[pos]].destAddr == neighbour) {
+      return tschOrder[pos];
+    }
+  }
+  return TSCH_QUEUE_NONE;
+}
+
+
+/**************************************************************************//**
+* @brief    Sleep timer ISR, run at every slot boundary. Arms the next
+*           boundary, then hops to the channel of the slot's cell and sends
+*           a packet or turns on the receiver as the cell allows.
+*
+* @return   None
+******************************************************************************/
+static void basicRfTschSlotIsr(void)
+{
+  const basicRfTschCell_t *pCell;
+  uint32 now;
+  uint8 steps;
+  uint8 index;
+
+  if (!tsch.running) {
+    return;
+  }
+
+  basicRfTschAdvance();
+  tschStats.slots++;
+
+  now = halTimer32kReadTimerValue();
+  if (now - tsch.slotStart > tschStats.maxLatency) {
+    tschStats.maxLatency = (uint16)(now - tsch.slotStart);
+  }
+
+  // Skip slots that have already passed, e.g. after a long interrupt lock
+  while ((int32)(tsch.nextStart - now) < TSCH_MIN_LEAD_TICKS) {
+    basicRfTschAdvance();
+    tschStats.missedSlots++;
+  }
+  halTimer32kSetCompare(tsch.nextStart);
+
+  // A packet from the previous slot must not spill into this one. The abort
+  // counts as a failed attempt, retried in the next cell.
+  if (basicRfTxIsBusy()) {
+    tschStats.overrunSlots++;
+    basicRfTxAbort();
+  }
+
+  basicRfReceiveOff();
+  pCell = basicRfTschLookup((uint16)(tsch.asn % tsch.slotframeLength), &steps);
+  if (pCell == NULL) {
+    return;
+  }
+  tschStats.activeSlots++;
+  halRfSetChannel(basicRfTschChannel(pCell));
+
+  index = TSCH_QUEUE_NONE;
+  if (pCell->options & BASIC_RF_TSCH_CELL_TX) {
+    index = basicRfTschTxPick(pCell->neighbour);
+  }
+  if (index != TSCH_QUEUE_NONE) {
+    tsch.txEntry = index;
+    if (basicRfSendPacketOnce(tschQueue[index].destAddr,
+                              tschQueue[index].payload,
+                              tschQueue[index].length,
+                              basicRfTschTxDone) != SUCCESS) {
+      tsch.txEntry = TSCH_QUEUE_NONE;
+    }
+  } else if (pCell->options & BASIC_RF_TSCH_CELL_RX) {
+    basicRfReceiveOn();
+  }
+}
+#endif
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Initialises the scheduler with an empty schedule
+*
+* @param    slotframeLength Number of slots in the slotframe
+* @param    pHopSeq         Hopping sequence of channels 11-26, or NULL for
+*                           the default sequence of all 16 channels. Copied.
+* @param    hopSeqLength    Length of the hopping sequence, at most
+*                           BASIC_RF_TSCH_MAX_HOP_SEQ
+*
+* @return   uint8 - SUCCESS, or FAILED if a parameter is out of range
+******************************************************************************/
+uint8 basicRfTschInit(uint16 slotframeLength, const uint8* pHopSeq,
+                      uint8 hopSeqLength)
+{
+  if (slotframeLength == 0) {
+    return FAILED;
+  }
+  if (pHopSeq == NULL) {
+    pHopSeq = tschDefaultHopSeq;
+    hopSeqLength = BASIC_RF_TSCH_MAX_HOP_SEQ;
+  } else if (hopSeqLength == 0 || hopSeqLength > BASIC_RF_TSCH_MAX_HOP_SEQ) {
+    return FAILED;
+  }
+
+  memset(&tsch, 0, sizeof(tsch));
+  tsch.slotframeLength = slotframeLength;
+  tsch.hopSeqLength = hopSeqLength;
+  memcpy(tschHopSeq, pHopSeq, hopSeqLength);
+#ifndef BASIC_RF_TSCH_SIM
+  tsch.txEntry = TSCH_QUEUE_NONE;
+  for (tschQueued = 0; tschQueued < BASIC_RF_TSCH_QUEUE_SIZE; tschQueued++) {
+    tschOrder[tschQueued] = tschQueued;
+  }
+  tschQueued = 0;
+  memset(&tschStats, 0, sizeof(tschStats));
+#endif
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Adds a cell to the schedule. May be called while the scheduler
+*           runs.
+*
+* @param    pCell           Cell, copied
+*
+* @return   uint8 - SUCCESS, or FAILED if the table is full, the slot offset
+*           is outside the slotframe or the slot already has a cell
+******************************************************************************/
+uint8 basicRfTschAddCell(const basicRfTschCell_t* pCell)
+{
+  uint8 pos;
+#ifndef BASIC_RF_TSCH_SIM
+  uint16 key;
+#endif
+
+  if (tsch.nCells == BASIC_RF_TSCH_MAX_CELLS ||
+      pCell->slotOffset >= tsch.slotframeLength) {
+    return FAILED;
+  }
+
+#ifndef BASIC_RF_TSCH_SIM
+  key = halIntLock();
+#endif
+  for (pos = 0; pos < tsch.nCells; pos++) {
+    if (tschCells[pos].slotOffset >= pCell->slotOffset) {
+      break;
+    }
+  }
+  if (pos < tsch.nCells && tschCells[pos].slotOffset == pCell->slotOffset) {
+#ifndef BASIC_RF_TSCH_SIM
+    halIntUnlock(key);
+#endif
+    return FAILED;
+  }
+  memmove(&tschCells[pos + 1], &tschCells[pos],
+          (tsch.nCells - pos) * sizeof(basicRfTschCell_t));
+  tschCells[pos] = *pCell;
+  tsch.nCells++;
+#ifndef BASIC_RF_TSCH_SIM
+  halIntUnlock(key);
+#endif
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Removes the cell of a slot from the schedule. May be called while
+*           the scheduler runs.
+*
+* @param    slotOffset      Slot in the slotframe
+*
+* @return   uint8 - SUCCESS, or FAILED if the slot has no cell
+******************************************************************************/
+uint8 basicRfTschRemoveCell(uint16 slotOffset)
+{
+  const basicRfTschCell_t *pCell;
+  uint8 pos;
+  uint8 steps;
+#ifndef BASIC_RF_TSCH_SIM
+  uint16 key;
+
+  key = halIntLock();
+#endif
+  pCell = basicRfTschLookup(slotOffset, &steps);
+  if (pCell != NULL) {
+    pos = (uint8)(pCell - tschCells);
+    tsch.nCells--;
+    memmove(&tschCells[pos], &tschCells[pos + 1],
+            (tsch.nCells - pos) * sizeof(basicRfTschCell_t));
+  }
+#ifndef BASIC_RF_TSCH_SIM
+  halIntUnlock(key);
+#endif
+
+  return (pCell != NULL) ? SUCCESS : FAILED;
+}
+
+
+#ifndef BASIC_RF_TSCH_SIM
+/**************************************************************************//**
+* @brief    Starts slotting. Nodes that exchange packets must be started with
+*           the same ASN at the same time.
+*
+* @param    asn         ASN of the first slot
+* @param    startTime   Sleep timer value at the start of the first slot,
+*                       see halTimer32kReadTimerValue(). Must be in the
+*                       future.
+*
+* @return   None
+******************************************************************************/
+void basicRfTschStart(uint32 asn, uint32 startTime)
+{
+  uint16 key;
+
+  key = halIntLock();
+  tsch.asn = asn - 1;
+  tsch.nextStart = startTime;
+  tsch.tickFraction = 0;
+  tsch.running = TRUE;
+
+  // The timer's own interval is only a fallback, each slot ISR sets the
+  // exact next boundary
+  halTimer32kIntConnect(basicRfTschSlotIsr);
+  halTimer32kInit(TSCH_TICKS_NUM / TSCH_TICKS_DEN);
+  halTimer32kSetCompare(startTime);
+  halTimer32kIntEnable();
+  halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Stops slotting, aborts a packet in flight and turns off the
+*           receiver. Queued packets are kept.
+*
+* @return   None
+******************************************************************************/
+void basicRfTschStop(void)
+{
+  halTimer32kIntDisable();
+  tsch.running = FALSE;
+  basicRfTxAbort();
+  basicRfReceiveOff();
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the absolute slot number of the current slot
+*
+* @return   uint32 - ASN
+******************************************************************************/
+uint32 basicRfTschGetAsn(void)
+{
+  return tsch.asn;
+}
+
+
+/**************************************************************************//**
+* @brief    Queues a packet for the next TX or shared cell of its
+*           destination. Packets are sent in the order they were queued.
+*
+* @param    destAddr    Destination short address, or BASIC_RF_BROADCAST_ADDR
+* @param    pPayload    Pointer to payload buffer, copied
+* @param    length      Length of payload
+*
+* @return   uint8 - SUCCESS, or FAILED if the queue is full
+******************************************************************************/
+uint8 basicRfTschSend(uint16 destAddr, uint8* pPayload, uint8 length)
+{
+  basicRfTschTxEntry_t *pEntry;
+  uint16 key;
+
+  if (tschQueued == BASIC_RF_TSCH_QUEUE_SIZE) {
+    return FAILED;
+  }
+
+  // Only this function takes free entries, so the entry can be filled in
+  // before it is published
+  pEntry = &tschQueue[tschOrder[tschQueued]];
+  pEntry->destAddr = destAddr;
+  pEntry->length = MIN(length, BASIC_RF_MAX_PAYLOAD_SIZE);
+  pEntry->retries = 0;
+  memcpy(pEntry->payload, pPayload, pEntry->length);
+
+  key = halIntLock();
+  tschQueued++;
+  halIntUnlock(key);
+
+  return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Copies the statistics counters
+*
+* @param    pStats      Pointer to struct to fill
+*
+* @return   None
+******************************************************************************/
+void basicRfTschGetStats(basicRfTschStats_t* pStats)
+{
+  uint16 key;
+
+  key = halIntLock();
+  *pStats = tschStats;
+  halIntUnlock(key);
+}
+
+#else
+
+/**************************************************************************//**
+* @brief    Runs the slot engine over \e nSlots slots from ASN 0 with the
+*           current schedule, without radio or timers. Measures the slot
+*           timing jitter, i.e. how far the sleep timer slot boundaries are
+*           from their ideal times, and the cost of the schedule lookup.
+*
+* @param    nSlots      Number of slots to simulate
+* @param    pResult     Pointer to struct to fill
+*
+* @return   None
+******************************************************************************/
+void basicRfTschSimulate(uint32 nSlots, basicRfTschSimResult_t* pResult)
+{
+  const basicRfTschCell_t *pCell;
+  uint32 totalSteps = 0;
+  uint16 ticks;
+  uint16 error;
+  uint8 steps;
+
+  memset(pResult, 0, sizeof(*pResult));
+  pResult->minSlotTicks = 0xFFFF;
+
+  tsch.asn = 0xFFFFFFFF;
+  tsch.nextStart = 0;
+  tsch.tickFraction = 0;
+
+  while (pResult->slots < nSlots) {
+    ticks = basicRfTschAdvance();
+    pResult->slots++;
+    pResult->minSlotTicks = MIN(pResult->minSlotTicks, ticks);
+    pResult->maxSlotTicks = MAX(pResult->maxSlotTicks, ticks);
+
+    // nextStart lags the ideal boundary by the carried fraction
+    error = (uint16)TSCH_FRACTION_TO_NS(tsch.tickFraction);
+    pResult->maxBoundaryError = MAX(pResult->maxBoundaryError, error);
+
+    pCell = basicRfTschLookup((uint16)(tsch.asn % tsch.slotframeLength), &steps);
+    totalSteps += steps;
+    pResult->maxLookupSteps = MAX(pResult->maxLookupSteps, steps);
+    if (pCell != NULL) {
+      pResult->activeSlots++;
+      pResult->channelSlots[basicRfTschChannel(pCell) - 11]++;
+    }
+  }
+
+  if (nSlots != 0) {
+    pResult->avgLookupSteps = (uint16)((totalSteps * 100) / nSlots);
+  }
+}
+#endif
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
@@ -0,0 +1,184 @@
+//*****************************************************************************
+//! @file       basic_rf_tsch.h
+//! @brief      Basic RF time-slotted channel hopping.
+//!
+//!             Divides time into slots of BASIC_RF_TSCH_SLOT_US, numbered
+//!             by the absolute slot number (ASN), and repeats a slotframe of
+//!             \e slotframeLength slots. Each slot of the slotframe may have
+//!             one cell: a TX cell, an RX cell or a shared cell (both). The
+//!             radio channel of a cell hops every slot:
+//!
+//!                 channel = hopSeq[(ASN + channelOffset) % hopSeqLength]
+//!
+//!             Slot boundaries are kept by the sleep timer, and the radio is
+//!             off in slots without a cell. Packets queued with
+//!             basicRfTschSend() are only sent in TX and shared cells
+//!             assigned to their destination, and the receiver is only on in
+//!             RX and shared cells. Received packets are read as usual with
+//!             basicRfReceive() or basicRfRxBorrow().
+//!
+//!             Packets are sent with basicRfSendPacketOnce(): one CCA, no
+//!             random backoff and no retransmission within the cell.
+//!             Packets that are not acknowledged, find the channel busy or
+//!             are still in flight at the next slot boundary, where they are
+//!             aborted, are retried in the next cell up to
+//!             BASIC_RF_TSCH_MAX_RETRIES times. Nodes must share the slot
+//!             timing, i.e. be started with basicRfTschStart() at the same
+//!             ASN and time; time synchronisation is left to the
+//!             application. The sleep timer is used for slot boundaries, so
+//!             low power listening (wakeInterval) can not be used at the
+//!             same time, and the other Basic RF send functions must not be
+//!             used while the scheduler runs.
+//!
+//!             INSTRUCTIONS:
+//!             1. Call basicRfTschInit() after basicRfInit().
+//!             2. Add cells with basicRfTschAddCell().
+//!             3. Call basicRfTschStart() to start slotting.
+//!             4. Queue packets with basicRfTschSend().
+//!
+//!             SIMULATION:
+//!             Built with BASIC_RF_TSCH_SIM, the file contains only the slot
+//!             engine (schedule, slot timing and channel hopping) and
+//!             basicRfTschSimulate(), and runs on a host PC. It reports the
+//!             slot timing jitter caused by the 32 kHz sleep timer
+//!             resolution and the cost of the schedule lookup, e.g.
+//!
+//!                 basicRfTschInit(101, NULL, 0);
+//!                 basicRfTschAddCell(&cell);      // ...
+//!                 basicRfTschSimulate(101 * 100, &result);
+//!
+//!             tools/basic_rf/tsch_sim.c runs it for a schedule given on
+//!             the command line.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef __BASIC_RF_TSCH_H__
+#define __BASIC_RF_TSCH_H__
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "basic_rf.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Slot duration in microseconds (802.15.4 default timeslot template)
+#ifndef BASIC_RF_TSCH_SLOT_US
+#define BASIC_RF_TSCH_SLOT_US               10000UL
+#endif
+
+// Number of cells in the schedule, at most 255
+#ifndef BASIC_RF_TSCH_MAX_CELLS
+#define BASIC_RF_TSCH_MAX_CELLS             32
+#endif
+
+// Number of packets that can wait for a cell
+#ifndef BASIC_RF_TSCH_QUEUE_SIZE
+#define BASIC_RF_TSCH_QUEUE_SIZE            4
+#endif
+
+// Number of times an unacknowledged packet is retried in later cells
+#ifndef BASIC_RF_TSCH_MAX_RETRIES
+#define BASIC_RF_TSCH_MAX_RETRIES           3
+#endif
+
+// Longest hopping sequence
+#define BASIC_RF_TSCH_MAX_HOP_SEQ           16
+
+// Cell options
+#define BASIC_RF_TSCH_CELL_TX               0x01
+#define BASIC_RF_TSCH_CELL_RX               0x02
+#define BASIC_RF_TSCH_CELL_SHARED           (BASIC_RF_TSCH_CELL_TX | \
+                                             BASIC_RF_TSCH_CELL_RX)
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+// A cell of the schedule
+typedef struct {
+    uint16 slotOffset;          // Slot in the slotframe
+    uint8 channelOffset;
+    uint8 options;              // BASIC_RF_TSCH_CELL_*
+    uint16 neighbour;           // TX: destination of the packets sent in the
+                                // cell, BASIC_RF_BROADCAST_ADDR for any
+} basicRfTschCell_t;
+
+// Statistics counters
+typedef struct {
+    uint32 slots;               // Slots started
+    uint32 activeSlots;         // Slots with a cell
+    uint32 missedSlots;         // Slots skipped because the ISR was too late
+    uint32 overrunSlots;        // Packets aborted at a slot boundary
+    uint32 txPackets;           // Packets sent (acknowledged if requested)
+    uint32 txFailed;            // Packets dropped after all retries
+    uint16 maxLatency;          // Largest slot ISR latency, 32 kHz periods
+} basicRfTschStats_t;
+
+// Simulation results, see basicRfTschSimulate()
+typedef struct {
+    uint32 slots;               // Slots simulated
+    uint32 activeSlots;         // Slots with a cell
+    uint16 minSlotTicks;        // Shortest slot, 32 kHz periods
+    uint16 maxSlotTicks;        // Longest slot, 32 kHz periods
+    uint16 maxBoundaryError;    // Largest slot boundary error, ns
+    uint16 avgLookupSteps;      // Cells compared per lookup, in 1/100
+    uint8 maxLookupSteps;       // Most cells compared in one lookup
+    uint32 channelSlots[16];    // Active slots per channel, 11-26
+} basicRfTschSimResult_t;
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 basicRfTschInit(uint16 slotframeLength, const uint8* pHopSeq,
+                      uint8 hopSeqLength);
+uint8 basicRfTschAddCell(const basicRfTschCell_t* pCell);
+uint8 basicRfTschRemoveCell(uint16 slotOffset);
+#ifndef BASIC_RF_TSCH_SIM
+void basicRfTschStart(uint32 asn, uint32 startTime);
+void basicRfTschStop(void);
+uint32 basicRfTschGetAsn(void);
+uint8 basicRfTschSend(uint16 destAddr, uint8* pPayload, uint8 length);
+void basicRfTschGetStats(basicRfTschStats_t* pStats);
+#else
+void basicRfTschSimulate(uint32 nSlots, basicRfTschSimResult_t* pResult);
+#endif
+
+
+#endif // #ifdef __BASIC_RF_TSCH_H__
@@ -0,0 +1,338 @@
+//*****************************************************************************
+//! @file       hal_aes.c
+//! @brief      CC2538 AES interface.
+//!
+//!             Encrypts single blocks with the AES-128 key in key store
+//!             area 0 of the CC2538 AES engine. Data is moved to and from the
+//!             engine by its internal DMA.
+//!
+//!             Define HAL_AES_SOFTWARE to use a software implementation of
+//!             the cipher instead, e.g. when the radio code is built for a
+//!             host PC for testing.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup hal_aes_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <string.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_aes.h"
+
+#ifndef HAL_AES_SOFTWARE
+#include "hw_types.h"               // Using HWREG() macro
+#include "hal_int.h"
+#include "hw_aes.h"                 // Register definitions
+#include "hw_sys_ctrl.h"            // Register definitions
+#endif
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#ifdef HAL_AES_SOFTWARE
+#define AES_ROUNDS                      10
+#else
+// Key store area holding the key
+#define AES_KEY_AREA                    0
+#endif
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+#ifdef HAL_AES_SOFTWARE
+static const uint8 aesSbox[256] = {
+  0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+  0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+  0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+  0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+  0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+  0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+  0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+  0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+  0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+  0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+  0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+  0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+  0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+  0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+  0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+  0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+// Expanded key, one round key per round plus the initial key
+static uint8 aesRoundKeys[(AES_ROUNDS + 1) * HAL_AES_BLOCK_SIZE];
+#else
+// DMA buffers. The engine reads and writes whole words.
+static uint32 aesDmaIn[HAL_AES_BLOCK_SIZE / 4];
+static uint32 aesDmaOut[HAL_AES_BLOCK_SIZE / 4];
+#endif
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+#ifdef HAL_AES_SOFTWARE
+/**************************************************************************//**
+* @brief    Multiplies by x in GF(2^8)
+*
+* @param    x       Value to multiply
+*
+* @return   x * 2 in GF(2^8)
+******************************************************************************/
+static uint8 aesXtime(uint8 x)
+{
+  return (uint8)((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+}
+#else
+/**************************************************************************//**
+* @brief    Runs one DMA operation of the AES engine to completion. The
+*           algorithm and the DMA channels must be set up by the caller.
+*
+* @return   SUCCESS, or FAILED on a DMA or key store error
+******************************************************************************/
+static uint8 aesWaitResult(void)
+{
+  unsigned long status;
+
+  while(!(HWREG(AES_CTRL_INT_STAT) & AES_CTRL_INT_STAT_RESULT_AV));
+  status = HWREG(AES_CTRL_INT_STAT);
+
+  HWREG(AES_CTRL_INT_CLR) = AES_CTRL_INT_CLR_DMA_IN_DONE |
+    AES_CTRL_INT_CLR_RESULT_AV | AES_CTRL_INT_CLR_DMA_BUS_ERR |
+    AES_CTRL_INT_CLR_KEY_ST_WR_ERR | AES_CTRL_INT_CLR_KEY_ST_RD_ERR;
+  HWREG(AES_CTRL_ALG_SEL) = 0;
+
+  if(status & (AES_CTRL_INT_STAT_DMA_BUS_ERR | AES_CTRL_INT_STAT_KEY_ST_WR_ERR |
+               AES_CTRL_INT_STAT_KEY_ST_RD_ERR))
+  {
+    return FAILED;
+  }
+  return SUCCESS;
+}
+#endif
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Loads the AES-128 key used by halAesEncrypt(). The AES engine is
+*           powered up on the first call.
+*
+* @param    pKey        Key, HAL_AES_KEY_SIZE bytes
+*
+* @return   SUCCESS, or FAILED if the key could not be loaded
+******************************************************************************/
+uint8 halAesLoadKey(const uint8* pKey)
+{
+#ifdef HAL_AES_SOFTWARE
+  uint8 *pRk;
+  uint8 rcon = 0x01;
+  uint8 t[4];
+  uint8 i;
+
+  memcpy(aesRoundKeys, pKey, HAL_AES_KEY_SIZE);
+  for(pRk = aesRoundKeys + HAL_AES_KEY_SIZE;
+      pRk < aesRoundKeys + sizeof(aesRoundKeys); pRk += 4)
+  {
+    memcpy(t, pRk - 4, 4);
+    if(((pRk - aesRoundKeys) % HAL_AES_KEY_SIZE) == 0)
+    {
+      // RotWord, SubWord and round constant
+      i = t[0];
+      t[0] = aesSbox[t[1]] ^ rcon;
+      t[1] = aesSbox[t[2]];
+      t[2] = aesSbox[t[3]];
+      t[3] = aesSbox[i];
+      rcon = aesXtime(rcon);
+    }
+    for(i = 0; i < 4; i++)
+    {
+      pRk[i] = pRk[i - HAL_AES_KEY_SIZE] ^ t[i];
+    }
+  }
+  return SUCCESS;
+#else
+  uint16 key;
+  uint8 result;
+
+  // Enable the AES engine in active and sleep mode
+  HWREG(SYS_CTRL_RCGCSEC) |= SYS_CTRL_RCGCSEC_AES;
+  HWREG(SYS_CTRL_SCGCSEC) |= SYS_CTRL_SCGCSEC_AES;
+
+  key = halIntLock();
+  memcpy(aesDmaIn, pKey, HAL_AES_KEY_SIZE);
+
+  // DMA the key into the key store
+  HWREG(AES_CTRL_ALG_SEL) = AES_CTRL_ALG_SEL_KEYSTORE;
+  HWREG(AES_CTRL_INT_CFG) = AES_CTRL_INT_CFG_LEVEL;
+  HWREG(AES_CTRL_INT_EN) = AES_CTRL_INT_EN_DMA_IN_DONE |
+    AES_CTRL_INT_EN_RESULT_AV;
+  HWREG(AES_CTRL_INT_CLR) = AES_CTRL_INT_CLR_DMA_IN_DONE |
+    AES_CTRL_INT_CLR_RESULT_AV;
+  HWREG(AES_KEY_STORE_SIZE) = (HWREG(AES_KEY_STORE_SIZE) &
+    ~AES_KEY_STORE_SIZE_KEY_SIZE_M) | AES_KEY_STORE_SIZE_KEY_SIZE_128;
+  HWREG(AES_KEY_STORE_WRITE_AREA) = BV(AES_KEY_AREA);
+  HWREG(AES_DMAC_CH0_CTRL) = AES_DMAC_CH0_CTRL_EN;
+  HWREG(AES_DMAC_CH0_EXTADDR) = (unsigned long)aesDmaIn;
+  HWREG(AES_DMAC_CH0_DMALENGTH) = HAL_AES_KEY_SIZE;
+
+  result = aesWaitResult();
+  if(!(HWREG(AES_KEY_STORE_WRITTEN_AREA) & BV(AES_KEY_AREA)))
+  {
+    result = FAILED;
+  }
+  halIntUnlock(key);
+
+  return result;
+#endif
+}
+
+
+/**************************************************************************//**
+* @brief    Encrypts one block with the key loaded by halAesLoadKey(). May be
+*           called from interrupt context.
+*
+* @param    pIn         Plaintext, HAL_AES_BLOCK_SIZE bytes
+* @param    pOut        Ciphertext, HAL_AES_BLOCK_SIZE bytes. May be the
+*                       same buffer as \e pIn.
+*
+* @return   SUCCESS, or FAILED on an AES engine error
+******************************************************************************/
+uint8 halAesEncrypt(const uint8* pIn, uint8* pOut)
+{
+#ifdef HAL_AES_SOFTWARE
+  uint8 state[HAL_AES_BLOCK_SIZE];
+  uint8 tmp[HAL_AES_BLOCK_SIZE];
+  uint8 round, c, r;
+  uint8 a0, a1, a2, a3, all;
+
+  for(r = 0; r < HAL_AES_BLOCK_SIZE; r++)
+  {
+    state[r] = pIn[r] ^ aesRoundKeys[r];
+  }
+
+  for(round = 1; round <= AES_ROUNDS; round++)
+  {
+    // SubBytes and ShiftRows. The state is stored column by column.
+    for(c = 0; c < 4; c++)
+    {
+      for(r = 0; r < 4; r++)
+      {
+        tmp[4 * c + r] = aesSbox[state[4 * ((c + r) & 0x03) + r]];
+      }
+    }
+
+    // MixColumns, skipped in the last round
+    for(c = 0; c < HAL_AES_BLOCK_SIZE; c += 4)
+    {
+      a0 = tmp[c];
+      a1 = tmp[c + 1];
+      a2 = tmp[c + 2];
+      a3 = tmp[c + 3];
+      if(round != AES_ROUNDS)
+      {
+        all = a0 ^ a1 ^ a2 ^ a3;
+        tmp[c]     = a0 ^ all ^ aesXtime(a0 ^ a1);
+        tmp[c + 1] = a1 ^ all ^ aesXtime(a1 ^ a2);
+        tmp[c + 2] = a2 ^ all ^ aesXtime(a2 ^ a3);
+        tmp[c + 3] = a3 ^ all ^ aesXtime(a3 ^ a0);
+      }
+    }
+
+    // AddRoundKey
+    for(r = 0; r < HAL_AES_BLOCK_SIZE; r++)
+    {
+      state[r] = tmp[r] ^ aesRoundKeys[round * HAL_AES_BLOCK_SIZE + r];
+    }
+  }
+
+  memcpy(pOut, state, HAL_AES_BLOCK_SIZE);
+  return SUCCESS;
+#else
+  uint16 key;
+  uint8 result;
+
+  // The engine is shared between the RX ISR and the TX path
+  key = halIntLock();
+  memcpy(aesDmaIn, pIn, HAL_AES_BLOCK_SIZE);
+
+  // Load the key from the key store into the engine
+  HWREG(AES_CTRL_ALG_SEL) = AES_CTRL_ALG_SEL_AES;
+  HWREG(AES_CTRL_INT_CLR) = AES_CTRL_INT_CLR_DMA_IN_DONE |
+    AES_CTRL_INT_CLR_RESULT_AV;
+  HWREG(AES_KEY_STORE_READ_AREA) = AES_KEY_AREA;
+  while(HWREG(AES_KEY_STORE_READ_AREA) & AES_KEY_STORE_READ_AREA_BUSY);
+  if(HWREG(AES_CTRL_INT_STAT) & AES_CTRL_INT_STAT_KEY_ST_RD_ERR)
+  {
+    aesWaitResult();
+    halIntUnlock(key);
+    return FAILED;
+  }
+
+  // ECB encryption of a single block
+  HWREG(AES_AES_CTRL) = AES_AES_CTRL_DIRECTION_ENCRYPT;
+  HWREG(AES_AES_C_LENGTH_0) = HAL_AES_BLOCK_SIZE;
+  HWREG(AES_AES_C_LENGTH_1) = 0;
+  HWREG(AES_DMAC_CH0_CTRL) = AES_DMAC_CH0_CTRL_EN;
+  HWREG(AES_DMAC_CH0_EXTADDR) = (unsigned long)aesDmaIn;
+  HWREG(AES_DMAC_CH0_DMALENGTH) = HAL_AES_BLOCK_SIZE;
+  HWREG(AES_DMAC_CH1_CTRL) = AES_DMAC_CH1_CTRL_EN;
+  HWREG(AES_DMAC_CH1_EXTADDR) = (unsigned long)aesDmaOut;
+  HWREG(AES_DMAC_CH1_DMALENGTH) = HAL_AES_BLOCK_SIZE;
+
+  result = aesWaitResult();
+  memcpy(pOut, aesDmaOut, HAL_AES_BLOCK_SIZE);
+  halIntUnlock(key);
+
+  return result;
+#endif
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
@@ -65,6 +65,7 @@
 #include "hw_gpio.h"                // Register definitions
 #include "hw_ioc.h"                 // Register definitions
 #include "hw_cctest.h"              // Register definitions
+#include "sleepmode.h"              // Sleep timer, used to correct MAC time
 
 
 /******************************************************************************
@@ -91,6 +92,15 @@
 #define IRQ_TXDONE                  0x00000002
 #define IRQ_RXPKTDONE               0x00000040
 
+// MAC timer period: 512 cycles of the 32 MHz clock, i.e. one symbol period
+#define MAC_TIMER_PERIOD            512
+#define MTMSEL_MT_PER               0x02
+#define MTMSEL_MTOVF                0x00
+#define MTMSEL_MTOVF_CMP1           0x30
+
+// One 32 kHz sleep timer tick is 15625/8192 symbol periods
+#define MAC_TIMER_SYMBOLS_PER_8K_TICKS  15625
+
 // Selected strobes
 #define RFST                        RFCORE_SFR_RFST
 #define ISRXON()                    st(HWREG(RFST) = 0x000000E3;)
@@ -106,19 +116,6 @@
 #define HAL_PA_LNA_RX_HGM()         st(HWREG(GPIO_D_BASE + (GPIO_O_DATA +     \
                                        (0x04 << 2))) = 0x04;)
 
-// TX power function arguments
-#define HAL_RF_TXPOWER_22_DBM       22
-#define HAL_RF_TXPOWER_20_DBM       20
-#define HAL_RF_TXPOWER_16_DBM       16
-#define HAL_RF_TXPOWER_13_DBM       13
-#define HAL_RF_TXPOWER_7_DBM        7
-#define HAL_RF_TXPOWER_4_DBM        4
-#define HAL_RF_TXPOWER_3_DBM        3
-#define HAL_RF_TXPOWER_0_DBM        0
-#define HAL_RF_TXPOWER_MIN_3_DBM    (0x80|3)
-#define HAL_RF_TXPOWER_MIN_9_DBM    (0x80|9)
-#define HAL_RF_TXPOWER_MIN_15_DBM   (0x80|15)
-
 // TXPOWER values
 #define CC2538_TXPOWER_7_DBM            0xFF
 #define CC2538_TXPOWER_3_DBM            0xD5
@@ -137,25 +134,66 @@
 #define CC2538_CC2592_TXPOWER_4_DBM     0x24
 #define CC2538_CC2592_TXPOWER_0_DBM     0x00
 
+// No TX power set with halRfSetTxPower()
+#define HAL_RF_TXPOWER_NONE             0xFF
+
 
 /******************************************************************************
 * LOCAL VARIABLES
 */
 static void (*pfISR)(void);
+static void (*pfTxISR)(void);
+static void (*pfMacTimerISR)(void);
+static unsigned long macTimerCompare;
+static unsigned long macTimerSleepStart;
+static unsigned long macTimerSleepFrac;
+static unsigned char txPower = HAL_RF_TXPOWER_NONE;
+static unsigned char lnaGain = HAL_RF_GAIN_HIGH;
 #ifdef INCLUDE_PA
-static uint8 rssiOffset = RSSI_OFFSET_LNA_HIGHGAIN;
+static uint8 rssiOffset = RSSI_OFFSET_LNA_CC2592_HIGHGAIN;
 static unsigned char halRfEmModule = HAL_RF_CC2538_CC2592EM;
 #else
 static uint8 rssiOffset = RSSI_OFFSET;
 static unsigned char halRfEmModule = HAL_RF_CC2538EM;
 #endif
 
+// TX power levels of each module, lowest first, and the matching TXPOWER
+// register values
+static const unsigned char halRfTxPowerLevelsCc2538[] = {
+    HAL_RF_TXPOWER_MIN_15_DBM, HAL_RF_TXPOWER_MIN_9_DBM,
+    HAL_RF_TXPOWER_MIN_3_DBM, HAL_RF_TXPOWER_0_DBM, HAL_RF_TXPOWER_3_DBM,
+    HAL_RF_TXPOWER_7_DBM
+};
+static const unsigned char halRfTxPowerCc2538[] = {
+    CC2538_TXPOWER_MIN_15_DBM, CC2538_TXPOWER_MIN_9_DBM,
+    CC2538_TXPOWER_MIN_3_DBM, CC2538_TXPOWER_0_DBM, CC2538_TXPOWER_3_DBM,
+    CC2538_TXPOWER_7_DBM
+};
+static const unsigned char halRfTxPowerLevelsCc2591[] = {
+    HAL_RF_TXPOWER_20_DBM
+};
+static const unsigned char halRfTxPowerLevelsCc2592[] = {
+    HAL_RF_TXPOWER_0_DBM, HAL_RF_TXPOWER_4_DBM, HAL_RF_TXPOWER_7_DBM,
+    HAL_RF_TXPOWER_13_DBM, HAL_RF_TXPOWER_16_DBM, HAL_RF_TXPOWER_20_DBM,
+    HAL_RF_TXPOWER_22_DBM
+};
+static const unsigned char halRfTxPowerCc2592[] = {
+    CC2538_CC2592_TXPOWER_0_DBM, CC2538_CC2592_TXPOWER_4_DBM,
+    CC2538_CC2592_TXPOWER_7_DBM, CC2538_CC2592_TXPOWER_13_DBM,
+    CC2538_CC2592_TXPOWER_16_DBM, CC2538_CC2592_TXPOWER_20_DBM,
+    CC2538_CC2592_TXPOWER_22_DBM
+};
+
 
 /******************************************************************************
 * FUNCTION PROTOTYPES
 */
 static void halRfIsr(void);
+static void halRfMacTimerIsr(void);
 static void halRfPaLnaInit(void);
+static void halRfMacTimerInit(void);
+static void halRfSrcMatchSetBit(unsigned long reg0, unsigned char index,
+                                unsigned char set);
 
 
 /******************************************************************************
@@ -168,6 +206,8 @@ static void halRfPaLnaInit(void);
 ******************************************************************************/
 unsigned char halRfInit(void)
 {
+    unsigned char i;
+
     //
     // Some of the below settings are indeed the reset value.
     //
@@ -208,9 +248,26 @@ unsigned char halRfInit(void)
     // Register halRfIsr() as RX interrupt function
     IntRegister(INT_RFCORERTX, &halRfIsr);
 
+    // Source address matching. The ACK to a data request has the frame
+    // pending bit set if the source is an enabled entry with pending data.
+    // The pending enable registers are undefined after reset.
+    HWREG(RFCORE_XREG_SRCMATCH) = RFCORE_XREG_SRCMATCH_SRC_MATCH_EN |
+                                  RFCORE_XREG_SRCMATCH_AUTOPEND |
+                                  RFCORE_XREG_SRCMATCH_PEND_DATAREQ_ONLY;
+    for(i = 0; i < 3; i++)
+    {
+        HWREG(RFCORE_XREG_SRCSHORTEN0 + (i * 4)) = 0;
+        HWREG(RFCORE_XREG_SRCEXTEN0 + (i * 4)) = 0;
+        HWREG(RFCORE_FFSM_SRCSHORTPENDEN0 + (i * 4)) = 0;
+        HWREG(RFCORE_FFSM_SRCEXTPENDEN0 + (i * 4)) = 0;
+    }
+
     // Enable RX interrupt
     halRfEnableRxInterrupt();
 
+    // Start the MAC timer used for protocol timing
+    halRfMacTimerInit();
+
     return SUCCESS;
 }
 
@@ -238,14 +295,22 @@ unsigned char halRfGetChipVer(void)
 
 
 /**************************************************************************//**
-* @brief    Function returns a random byte.
+* @brief    Function returns a random byte, built from the random bits of the
+*           I channel of the receiver. The receiver must be on.
 *
 * @return   Random byte
 ******************************************************************************/
 unsigned char halRfGetRandomByte(void)
 {
-    // Not implemented
-    return 0;
+    unsigned char i;
+    unsigned char rnd = 0;
+
+    for(i = 0; i < 8; i++)
+    {
+        rnd = (rnd << 1) | (HWREG(RFCORE_XREG_RFRND) & RFCORE_XREG_RFRND_IRND);
+    }
+
+    return rnd;
 }
 
 
@@ -289,6 +354,83 @@ void halRfSetShortAddr(unsigned short shortAddr)
 }
 
 
+/**************************************************************************//**
+* @brief    Function sets the device's extended (64-bit) address. The
+*           frame filter accepts frames sent to this address.
+*
+* @param    pExtAddr        Extended address, least significant byte first
+*
+* @return   None
+******************************************************************************/
+void halRfSetExtAddr(const unsigned char* pExtAddr)
+{
+    unsigned char i;
+
+    for(i = 0; i < 8; i++)
+    {
+        HWREG(RFCORE_FFSM_EXT_ADDR0 + (i * 4)) = pExtAddr[i];
+    }
+}
+
+
+/**************************************************************************//**
+* @brief    Function writes a short address to an entry of the source address
+*           matching table and enables the entry. The pending bit of the
+*           entry is cleared.
+*
+* @param    index           Table entry, 0 to HAL_RF_SRC_MATCH_SHORT_ENTRIES - 1
+* @param    panId           PAN ID of the source
+* @param    shortAddr       Short address of the source
+*
+* @return   None
+******************************************************************************/
+void halRfSrcMatchSetShort(unsigned char index, unsigned short panId,
+                           unsigned short shortAddr)
+{
+    unsigned long entry = FRMF_SRCM_RAM_BASE + (index * 16);
+
+    halRfSrcMatchSetBit(RFCORE_XREG_SRCSHORTEN0, index, 0);
+    halRfSrcMatchSetBit(RFCORE_FFSM_SRCSHORTPENDEN0, index, 0);
+
+    HWREG(entry)      = LO_UINT16(panId);
+    HWREG(entry + 4)  = HI_UINT16(panId);
+    HWREG(entry + 8)  = LO_UINT16(shortAddr);
+    HWREG(entry + 12) = HI_UINT16(shortAddr);
+
+    halRfSrcMatchSetBit(RFCORE_XREG_SRCSHORTEN0, index, 1);
+}
+
+
+/**************************************************************************//**
+* @brief    Function disables an entry of the source address matching table
+*
+* @param    index           Table entry
+*
+* @return   None
+******************************************************************************/
+void halRfSrcMatchClearShort(unsigned char index)
+{
+    halRfSrcMatchSetBit(RFCORE_XREG_SRCSHORTEN0, index, 0);
+    halRfSrcMatchSetBit(RFCORE_FFSM_SRCSHORTPENDEN0, index, 0);
+}
+
+
+/**************************************************************************//**
+* @brief    Function sets or clears the pending bit of an entry of the source
+*           address matching table. Acknowledgments to data requests from the
+*           entry's address get the frame pending bit set while it is set.
+*
+* @param    index           Table entry
+* @param    pending         Nonzero to set the bit
+*
+* @return   None
+******************************************************************************/
+void halRfSrcMatchSetPending(unsigned char index, unsigned char pending)
+{
+    halRfSrcMatchSetBit(RFCORE_FFSM_SRCSHORTPENDEN0, index, pending);
+}
+
+
 /**************************************************************************//**
 * @brief    Function sets the device's PAN ID.
 *
@@ -303,6 +445,31 @@ void halRfSetPanId(unsigned short panId)
 }
 
 
+/**************************************************************************//**
+* @brief    Function turns promiscuous mode on or off. In promiscuous mode
+*           frame filtering is disabled, so every frame received is put in
+*           the RX FIFO, and no frames are acknowledged. Frames with CRC
+*           errors are kept in the RX FIFO in either mode.
+*
+* @param    enable      TRUE for promiscuous mode, FALSE for normal mode
+*
+* @return   None
+******************************************************************************/
+void halRfSetPromiscuous(unsigned char enable)
+{
+    if(enable)
+    {
+        HWREG(RFCORE_XREG_FRMFILT0) = 0x0C;
+        HWREG(RFCORE_XREG_FRMCTRL0) &= ~AUTO_ACK;
+    }
+    else
+    {
+        HWREG(RFCORE_XREG_FRMFILT0) = 0x0D;
+        HWREG(RFCORE_XREG_FRMCTRL0) |= AUTO_ACK;
+    }
+}
+
+
 /**************************************************************************//**
 * @brief    Function sets the devices's TX power
 *
@@ -312,58 +479,108 @@ void halRfSetPanId(unsigned short panId)
 ******************************************************************************/
 unsigned char halRfSetTxPower(unsigned char power)
 {
-    unsigned char n;
+    if(halRfApplyTxPower(power) == FAILED)
+    {
+        return FAILED;
+    }
+    txPower = power;
 
-    if(halRfEmModule == HAL_RF_CC2538EM)
+    return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Function writes a TX power level to the radio for the next frames
+*           only. The level set with halRfSetTxPower() is kept and can be
+*           restored with halRfApplyTxPower(halRfGetTxPower()).
+*
+* @param    power       Power level, HAL_RF_TXPOWER_*
+*
+* @return   SUCCSES or FAILED if the level is not supported by the module
+******************************************************************************/
+unsigned char halRfApplyTxPower(unsigned char power)
+{
+    const unsigned char* pLevels;
+    unsigned char nLevels;
+    unsigned char i;
+
+    nLevels = halRfGetTxPowerLevels(&pLevels);
+    for(i = 0; i < nLevels; i++)
     {
-        switch(power)
+        if(pLevels[i] == power)
         {
-        case HAL_RF_TXPOWER_7_DBM:      n = CC2538_TXPOWER_7_DBM;       break;
-        case HAL_RF_TXPOWER_3_DBM:      n = CC2538_TXPOWER_3_DBM;       break;
-        case HAL_RF_TXPOWER_0_DBM:      n = CC2538_TXPOWER_0_DBM;       break;
-        case HAL_RF_TXPOWER_MIN_3_DBM:  n = CC2538_TXPOWER_MIN_3_DBM;   break;
-        case HAL_RF_TXPOWER_MIN_9_DBM:  n = CC2538_TXPOWER_MIN_9_DBM;   break;
-        case HAL_RF_TXPOWER_MIN_15_DBM: n = CC2538_TXPOWER_MIN_15_DBM;  break;
-        default:
-            return FAILED;
+            break;
         }
     }
-    else if(halRfEmModule == HAL_RF_CC2538_CC2591EM)
+    if(i == nLevels)
     {
-        if(power != HAL_RF_TXPOWER_20_DBM)
-        {
-            return FAILED;
-        }
-        n = CC2538_CC2591_TXPOWER_20_DBM;
+        return FAILED;
+    }
 
+    // Set TX power
+    if(halRfEmModule == HAL_RF_CC2538EM)
+    {
+        HWREG(RFCORE_XREG_TXPOWER) = halRfTxPowerCc2538[i];
     }
-    else if(halRfEmModule == HAL_RF_CC2538_CC2592EM)
+    else if(halRfEmModule == HAL_RF_CC2538_CC2591EM)
     {
-        switch(power)
-        {
-        case HAL_RF_TXPOWER_22_DBM: n = CC2538_CC2592_TXPOWER_22_DBM; break;
-        case HAL_RF_TXPOWER_20_DBM: n = CC2538_CC2592_TXPOWER_20_DBM; break;
-        case HAL_RF_TXPOWER_16_DBM: n = CC2538_CC2592_TXPOWER_16_DBM; break;
-        case HAL_RF_TXPOWER_13_DBM: n = CC2538_CC2592_TXPOWER_13_DBM; break;
-        case HAL_RF_TXPOWER_7_DBM:  n = CC2538_CC2592_TXPOWER_7_DBM;  break;
-        case HAL_RF_TXPOWER_4_DBM:  n = CC2538_CC2592_TXPOWER_4_DBM;  break;
-        case HAL_RF_TXPOWER_0_DBM:  n = CC2538_CC2592_TXPOWER_0_DBM;  break;
-        default:
-            return FAILED;
-        }
+        HWREG(RFCORE_XREG_TXPOWER) = CC2538_CC2591_TXPOWER_20_DBM;
     }
     else
     {
-        return FAILED;
+        HWREG(RFCORE_XREG_TXPOWER) = halRfTxPowerCc2592[i];
     }
 
-    // Set TX power
-    HWREG(RFCORE_XREG_TXPOWER) = n;
-
     return SUCCESS;
 }
 
 
+/**************************************************************************//**
+* @brief    Function returns the TX power level set with halRfSetTxPower()
+*
+* @return   Power level, HAL_RF_TXPOWER_*. The highest level of the module
+*           if none has been set.
+******************************************************************************/
+unsigned char halRfGetTxPower(void)
+{
+    const unsigned char* pLevels;
+    unsigned char nLevels;
+
+    if(txPower != HAL_RF_TXPOWER_NONE)
+    {
+        return txPower;
+    }
+    nLevels = halRfGetTxPowerLevels(&pLevels);
+
+    return pLevels[nLevels - 1];
+}
+
+
+/**************************************************************************//**
+* @brief    Function returns the TX power levels supported by the module in
+*           use, lowest first
+*
+* @param    ppLevels    Set to the levels, HAL_RF_TXPOWER_*
+*
+* @return   Number of levels
+******************************************************************************/
+unsigned char halRfGetTxPowerLevels(const unsigned char** ppLevels)
+{
+    if(halRfEmModule == HAL_RF_CC2538EM)
+    {
+        *ppLevels = halRfTxPowerLevelsCc2538;
+        return sizeof(halRfTxPowerLevelsCc2538);
+    }
+    else if(halRfEmModule == HAL_RF_CC2538_CC2591EM)
+    {
+        *ppLevels = halRfTxPowerLevelsCc2591;
+        return sizeof(halRfTxPowerLevelsCc2591);
+    }
+    *ppLevels = halRfTxPowerLevelsCc2592;
+    return sizeof(halRfTxPowerLevelsCc2592);
+}
+
+
 /**************************************************************************//**
 * @brief    Set module. Enables to change between CC2538EM / CC2520-CC2592EM
 *           support runtime. halRfInit must be called after running this
@@ -385,6 +602,9 @@ unsigned char halRfSetModule(unsigned char emModule)
     }
     halRfEmModule = emModule;
 
+    // The levels of the previous module may not exist on this one
+    txPower = HAL_RF_TXPOWER_NONE;
+
     return SUCCESS;
 }
 
@@ -393,6 +613,9 @@ unsigned char halRfSetModule(unsigned char emModule)
 * @brief    Function sets the gain mode. Only applicable for units with
 *           CC2590/91. This function assumes that CC2538 GPIO pins have been
 *           configured as GPIO output, for example, by using halRfInit();
+*           The gain pin and the RSSI offset are changed with interrupts
+*           disabled, so that RSSI values read from interrupt context are
+*           always converted with the offset of the gain in use.
 *
 * @param    gainMode    Gain mode
 *
@@ -400,6 +623,10 @@ unsigned char halRfSetModule(unsigned char emModule)
 ******************************************************************************/
 void halRfSetGain(unsigned char gainMode)
 {
+    unsigned short key;
+
+    key = halIntLock();
+    lnaGain = gainMode;
     if (gainMode == HAL_RF_GAIN_LOW)
     {
         // Setting low gain mode
@@ -426,6 +653,18 @@ void halRfSetGain(unsigned char gainMode)
             rssiOffset = RSSI_OFFSET_LNA_CC2591_HIGHGAIN;
         }
     }
+    halIntUnlock(key);
+}
+
+
+/**************************************************************************//**
+* @brief    Function returns the gain mode set with halRfSetGain()
+*
+* @return   HAL_RF_GAIN_LOW or HAL_RF_GAIN_HIGH
+******************************************************************************/
+unsigned char halRfGetGain(void)
+{
+    return lnaGain;
 }
 
 
@@ -496,6 +735,40 @@ void halRfReadRxBuf(unsigned char* pData, unsigned char length)
 }
 
 
+/**************************************************************************//**
+* @brief    Function checks if the RX FIFO holds at least one complete frame,
+*           i.e. that the length byte and all bytes it announces have been
+*           received. Several frames may be buffered in the RX FIFO.
+*
+* @return   TRUE if a complete frame can be read from the RX FIFO
+******************************************************************************/
+unsigned char halRfRxFrameReady(void)
+{
+    unsigned char count = HWREG(RFCORE_XREG_RXFIFOCNT);
+
+    if(count == 0)
+    {
+        return FALSE;
+    }
+
+    // The first byte in the RX FIFO is the length byte of the oldest frame
+    return (count > (HWREG(RFCORE_XREG_RXFIRST) & 0x7F));
+}
+
+
+/**************************************************************************//**
+* @brief    Function checks if the RX FIFO has overflowed. The RX FIFO must
+*           be flushed (e.g. by halRfReceiveOn()) to resume reception.
+*
+* @return   TRUE if the RX FIFO has overflowed
+******************************************************************************/
+unsigned char halRfRxFifoOverflow(void)
+{
+    // FIFOP active while FIFO is inactive indicates RX FIFO overflow
+    return ((HWREG(RFCORE_XREG_FSMSTAT1) & (BV(7) | BV(6))) == BV(6));
+}
+
+
 /**************************************************************************//**
 * @brief    Function reads \e length bytes from the device's memory.
 *
@@ -529,14 +802,40 @@ unsigned char halRfWriteMemory(unsigned short addr, unsigned char* pData,
 
 
 /**************************************************************************//**
-* @brief    Transmit frame. Function returns when frame is sent.
+* @brief    Transmit frame using IEEE 802.15.4 unslotted CSMA-CA. The channel
+*           is assessed after a random backoff of [0, 2^BE - 1] backoff
+*           periods. If it is busy, BE is incremented and a new backoff is
+*           started, until macMaxCSMABackoffs is exceeded. Function returns
+*           when frame is sent. The receiver must be on.
 *
-* @return   SUCCESS or FAIL
+* @return   SUCCESS or HAL_RF_CHANNEL_ACCESS_FAILURE
 ******************************************************************************/
 unsigned char halRfTransmit(void)
 {
-    // Sending
-    ISTXON();
+    unsigned char nb = 0;
+    unsigned char be = HAL_RF_MAC_MIN_BE;
+    unsigned long start;
+    unsigned long delay;
+
+    for(;;)
+    {
+        // Random backoff
+        delay = (halRfGetRandomByte() & ((1 << be) - 1)) * HAL_RF_BACKOFF_PERIOD;
+        start = halRfMacTimerGet();
+        while(((halRfMacTimerGet() - start) & HAL_RF_MAC_TIMER_MASK) < delay);
+
+        if(halRfTransmitCca() == SUCCESS)
+        {
+            break;
+        }
+
+        // Channel busy
+        if(++nb > HAL_RF_MAC_MAX_CSMA_BACKOFFS)
+        {
+            return HAL_RF_CHANNEL_ACCESS_FAILURE;
+        }
+        be = MIN(be + 1, HAL_RF_MAC_MAX_BE);
+    }
 
     // Waiting for transmission to finish
     while(!(HWREG(RFCORE_SFR_RFIRQF1) & IRQ_TXDONE) );
@@ -548,6 +847,77 @@ unsigned char halRfTransmit(void)
 }
 
 
+/**************************************************************************//**
+* @brief    Start transmission of the frame in the TX FIFO. The function
+*           returns immediately. Completion is signalled by the TX interrupt,
+*           see halRfTxInterruptConfig().
+*
+* @return   None
+******************************************************************************/
+void halRfTransmitStart(void)
+{
+    ISTXON();
+}
+
+
+/**************************************************************************//**
+* @brief    Perform clear channel assessment and start transmission of the
+*           frame in the TX FIFO if the channel is clear (STXONCCA). The
+*           function returns immediately.
+*
+* @return   SUCCESS if transmission started, FAILED if the channel is busy
+******************************************************************************/
+unsigned char halRfTransmitCca(void)
+{
+    // CCA is not valid until the RSSI is valid (8 symbol periods after RX on)
+    while(!(HWREG(RFCORE_XREG_RSSISTAT) & RFCORE_XREG_RSSISTAT_RSSI_VALID));
+
+    ISTXONCCA();
+
+    // SAMPLED_CCA holds the CCA result used by the STXONCCA strobe
+    if(HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_SAMPLED_CCA)
+    {
+        return SUCCESS;
+    }
+    return FAILED;
+}
+
+
+/**************************************************************************//**
+* @brief    Read the current RSSI, i.e. the energy on the channel averaged
+*           over the last 8 symbol periods. The receiver must be on.
+*
+* @return   RSSI in dBm
+******************************************************************************/
+signed char halRfGetRssi(void)
+{
+    // The RSSI is not valid until 8 symbol periods after RX on
+    while(!(HWREG(RFCORE_XREG_RSSISTAT) & RFCORE_XREG_RSSISTAT_RSSI_VALID));
+
+    return (signed char)HWREG(RFCORE_XREG_RSSI) - rssiOffset;
+}
+
+
+/**************************************************************************//**
+* @brief    Perform clear channel assessment without transmitting. The
+*           receiver must be on.
+*
+* @return   TRUE if the channel is clear, FALSE if energy or a frame is
+*           detected
+******************************************************************************/
+unsigned char halRfChannelClear(void)
+{
+    // CCA is not valid until the RSSI is valid (8 symbol periods after RX on)
+    while(!(HWREG(RFCORE_XREG_RSSISTAT) & RFCORE_XREG_RSSISTAT_RSSI_VALID));
+
+    if(HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_CCA)
+    {
+        return TRUE;
+    }
+    return FALSE;
+}
+
+
 /**************************************************************************//**
 * @brief    Turn receiver on.
 *
@@ -616,6 +986,50 @@ void halRfRxInterruptConfig(void (*pf)(void))
     pfISR= pf;
     HAL_INT_UNLOCK(s);
 }
+
+
+/**************************************************************************//**
+* @brief    Clear and disable TX done interrupt.
+*
+* @return   None
+******************************************************************************/
+void halRfDisableTxInterrupt(void)
+{
+    // disable TXDONE interrupt. The general RF interrupt is shared with RX
+    // and is left enabled.
+    HWREG(RFCORE_XREG_RFIRQM1) &= (~BV(1));
+    HWREG(RFCORE_SFR_RFIRQF1) = HWREG(RFCORE_SFR_RFIRQF1) & ~IRQ_TXDONE;
+}
+
+
+/**************************************************************************//**
+* @brief    Enable TX done interrupt. halRfTransmit() polls the TX done flag
+*           and must not be used while this interrupt is enabled.
+*
+* @return   None
+******************************************************************************/
+void halRfEnableTxInterrupt(void)
+{
+    // enable TXDONE interrupt
+    HWREG(RFCORE_XREG_RFIRQM1) |= BV(1);
+
+    // enable general RF interrupts
+    IntEnable(INT_RFCORERTX);
+}
+
+
+/**************************************************************************//**
+* @brief    Configure TX done interrupt.
+*
+* @return   None
+******************************************************************************/
+void halRfTxInterruptConfig(void (*pf)(void))
+{
+    unsigned short s;
+    HAL_INT_LOCK(s);
+    pfTxISR= pf;
+    HAL_INT_UNLOCK(s);
+}
 #endif
 
 
@@ -631,9 +1045,233 @@ void halRfWaitTransceiverReady(void)
 }
 
 
+/**************************************************************************//**
+* @brief    Function returns TRUE if the transceiver is ready (SFD inactive),
+*           i.e. the non-blocking version of halRfWaitTransceiverReady().
+*
+* @return   TRUE if ready to transmit
+******************************************************************************/
+unsigned char halRfTransceiverReady(void)
+{
+    return !(HWREG(RFCORE_XREG_FSMSTAT1) & (BV(1) | BV(5)));
+}
+
+
+/**************************************************************************//**
+* @brief    Function returns the MAC timer value in symbol periods.
+*
+* @return   Symbol time, wraps at HAL_RF_MAC_TIMER_MASK
+******************************************************************************/
+unsigned long halRfMacTimerGet(void)
+{
+    unsigned long symbols;
+    unsigned short s;
+
+    HAL_INT_LOCK(s);
+
+    // Reading MTM0 latches the timer and the overflow counter (LATCH_MODE)
+    HWREG(RFCORE_SFR_MTMSEL) = MTMSEL_MTOVF;
+    (void)HWREG(RFCORE_SFR_MTM0);
+    symbols  = HWREG(RFCORE_SFR_MTMOVF0);
+    symbols |= HWREG(RFCORE_SFR_MTMOVF1) << 8;
+    symbols |= HWREG(RFCORE_SFR_MTMOVF2) << 16;
+
+    HAL_INT_UNLOCK(s);
+
+    return symbols;
+}
+
+
+/**************************************************************************//**
+* @brief    Function returns the MAC timer value in microseconds. The timer
+*           runs MAC_TIMER_PERIOD 32 MHz periods per symbol period.
+*
+* @return   Microseconds, wraps at HAL_RF_MAC_TIMER_US_MASK
+******************************************************************************/
+unsigned long halRfMacTimerGetUs(void)
+{
+    unsigned long symbols;
+    unsigned short ticks;
+    unsigned short s;
+
+    HAL_INT_LOCK(s);
+
+    // Reading MTM0 latches the timer and the overflow counter (LATCH_MODE)
+    HWREG(RFCORE_SFR_MTMSEL) = MTMSEL_MTOVF;
+    ticks  = HWREG(RFCORE_SFR_MTM0);
+    ticks |= HWREG(RFCORE_SFR_MTM1) << 8;
+    symbols  = HWREG(RFCORE_SFR_MTMOVF0);
+    symbols |= HWREG(RFCORE_SFR_MTMOVF1) << 8;
+    symbols |= HWREG(RFCORE_SFR_MTMOVF2) << 16;
+
+    HAL_INT_UNLOCK(s);
+
+    return (symbols * HAL_RF_SYMBOL_US +
+            ticks / (MAC_TIMER_PERIOD / HAL_RF_SYMBOL_US)) & HAL_RF_MAC_TIMER_US_MASK;
+}
+
+
+/**************************************************************************//**
+* @brief    Function arms the MAC timer to run the ISR connected with
+*           halRfMacTimerIntConnect() once, when the MAC timer reaches
+*           \e symbolTime. A previously armed compare is replaced.
+*
+* @param    symbolTime  Absolute symbol time, see halRfMacTimerGet()
+*
+* @return   None
+******************************************************************************/
+void halRfMacTimerSetCompare(unsigned long symbolTime)
+{
+    unsigned short s;
+
+    HAL_INT_LOCK(s);
+
+    HWREG(RFCORE_SFR_MTIRQM) &= ~RFCORE_SFR_MTIRQM_MACTIMER_OVF_COMPARE1M;
+    macTimerCompare = symbolTime & HAL_RF_MAC_TIMER_MASK;
+
+    // The compare value is committed when MTMOVF2 is written
+    HWREG(RFCORE_SFR_MTMSEL) = MTMSEL_MTOVF_CMP1;
+    HWREG(RFCORE_SFR_MTMOVF0) = symbolTime & 0xFF;
+    HWREG(RFCORE_SFR_MTMOVF1) = (symbolTime >> 8) & 0xFF;
+    HWREG(RFCORE_SFR_MTMOVF2) = (symbolTime >> 16) & 0xFF;
+
+    HWREG(RFCORE_SFR_MTIRQF) = HWREG(RFCORE_SFR_MTIRQF) &
+                               ~RFCORE_SFR_MTIRQF_MACTIMER_OVF_COMPARE1F;
+    HWREG(RFCORE_SFR_MTIRQM) |= RFCORE_SFR_MTIRQM_MACTIMER_OVF_COMPARE1M;
+    IntEnable(INT_MACTIMR);
+
+    HAL_INT_UNLOCK(s);
+}
+
+
+/**************************************************************************//**
+* @brief    Connect interrupt service routine to the MAC timer compare
+*           interrupt.
+*
+* @param    pf          Void function pointer to interrupt service routine
+*
+* @return   None
+******************************************************************************/
+void halRfMacTimerIntConnect(void (*pf)(void))
+{
+    unsigned short s;
+    HAL_INT_LOCK(s);
+    pfMacTimerISR= pf;
+    HAL_INT_UNLOCK(s);
+}
+
+
+/**************************************************************************//**
+* @brief    Disarm the MAC timer compare interrupt.
+*
+* @return   None
+******************************************************************************/
+void halRfMacTimerIntDisable(void)
+{
+    HWREG(RFCORE_SFR_MTIRQM) &= ~RFCORE_SFR_MTIRQM_MACTIMER_OVF_COMPARE1M;
+    HWREG(RFCORE_SFR_MTIRQF) = HWREG(RFCORE_SFR_MTIRQF) &
+                               ~RFCORE_SFR_MTIRQF_MACTIMER_OVF_COMPARE1F;
+}
+
+
+/**************************************************************************//**
+* @brief    Stop the MAC timer before the MCU enters PM1 or PM2, where the
+*           32 MHz clock it runs on is off. The sleep timer count at the
+*           stop is saved, so that halRfMacTimerWake() can advance the MAC
+*           timer by the time spent asleep. Call with interrupts disabled.
+*
+* @return   None
+******************************************************************************/
+void halRfMacTimerSleep(void)
+{
+    // With SYNC set the timer stops on the next 32 kHz clock edge
+    HWREG(RFCORE_SFR_MTCTRL) &= ~RFCORE_SFR_MTCTRL_RUN;
+    while(HWREG(RFCORE_SFR_MTCTRL) & RFCORE_SFR_MTCTRL_STATE);
+    macTimerSleepStart = SleepModeTimerCountGet();
+}
+
+
+/**************************************************************************//**
+* @brief    Restart the MAC timer after PM1 or PM2 and add the time spent
+*           asleep, measured on the sleep timer, to the overflow counter.
+*           A compare that fell within the sleep is fired right away.
+*           Call with interrupts disabled, after halRfMacTimerSleep().
+*
+* @return   None
+******************************************************************************/
+void halRfMacTimerWake(void)
+{
+    unsigned long before;
+    unsigned long symbols;
+    unsigned long ticks;
+
+    // With SYNC set the timer starts on the next 32 kHz clock edge, which
+    // also makes the sleep timer count valid after wake-up
+    HWREG(RFCORE_SFR_MTCTRL) |= RFCORE_SFR_MTCTRL_RUN;
+    while(!(HWREG(RFCORE_SFR_MTCTRL) & RFCORE_SFR_MTCTRL_STATE));
+    ticks = SleepModeTimerCountGet() - macTimerSleepStart;
+
+    // Convert to symbol periods, carrying the fraction to the next sleep
+    macTimerSleepFrac += (ticks & 0x1FFF) * MAC_TIMER_SYMBOLS_PER_8K_TICKS;
+    symbols = (ticks >> 13) * MAC_TIMER_SYMBOLS_PER_8K_TICKS +
+              (macTimerSleepFrac >> 13);
+    macTimerSleepFrac &= 0x1FFF;
+
+    // Reading MTM0 latches the overflow counter. Writes to the counter are
+    // committed when MTMOVF2 is written.
+    before = halRfMacTimerGet();
+    symbols = (before + symbols) & HAL_RF_MAC_TIMER_MASK;
+    HWREG(RFCORE_SFR_MTMSEL) = MTMSEL_MTOVF;
+    HWREG(RFCORE_SFR_MTMOVF0) = symbols & 0xFF;
+    HWREG(RFCORE_SFR_MTMOVF1) = (symbols >> 8) & 0xFF;
+    HWREG(RFCORE_SFR_MTMOVF2) = (symbols >> 16) & 0xFF;
+
+    // The compare only matches on equality, so one that was skipped would
+    // otherwise not fire until the counter wraps
+    if((HWREG(RFCORE_SFR_MTIRQM) & RFCORE_SFR_MTIRQM_MACTIMER_OVF_COMPARE1M) &&
+       ((macTimerCompare - before) & HAL_RF_MAC_TIMER_MASK) <=
+       ((symbols - before) & HAL_RF_MAC_TIMER_MASK))
+    {
+        halRfMacTimerSetCompare(symbols + 2);
+    }
+}
+
+
 /**************************************************************************//**
 * LOCAL FUNCTIONS
 */
+/**************************************************************************//**
+* @brief    Starts the MAC timer with a period of one symbol, so that the
+*           overflow counter counts symbol periods.
+*
+* @return   None
+******************************************************************************/
+static void halRfMacTimerInit(void)
+{
+    // Stop timer
+    HWREG(RFCORE_SFR_MTCTRL) = 0;
+
+    // Set timer period
+    HWREG(RFCORE_SFR_MTMSEL) = MTMSEL_MT_PER;
+    HWREG(RFCORE_SFR_MTM0) = LO_UINT16(MAC_TIMER_PERIOD);
+    HWREG(RFCORE_SFR_MTM1) = HI_UINT16(MAC_TIMER_PERIOD);
+
+    // No interrupts until a compare is armed
+    HWREG(RFCORE_SFR_MTIRQM) = 0;
+    HWREG(RFCORE_SFR_MTIRQF) = 0;
+    IntPrioritySet(INT_MACTIMR, 0);
+    IntRegister(INT_MACTIMR, &halRfMacTimerIsr);
+
+    // Start timer. Reading MTM0 latches the entire overflow counter. SYNC
+    // starts and stops the timer on 32 kHz clock edges, so that the time
+    // in PM1/PM2 can be taken from the sleep timer, see halRfMacTimerWake().
+    HWREG(RFCORE_SFR_MTCTRL) = RFCORE_SFR_MTCTRL_LATCH_MODE |
+                               RFCORE_SFR_MTCTRL_SYNC |
+                               RFCORE_SFR_MTCTRL_RUN;
+    while(!(HWREG(RFCORE_SFR_MTCTRL) & RFCORE_SFR_MTCTRL_STATE));
+}
+
+
 /**************************************************************************//**
 * @brief    This function initializes the CC2538 to control the CC2592 PA/LNA
 *           signals. CC2538 GPIO connected to CC2592 HGM is configured as high.
@@ -662,6 +1300,32 @@ static void halRfPaLnaInit(void)
 }
 
 
+/**************************************************************************//**
+* @brief    Sets or clears the bit of a source address matching table entry
+*           in a set of three 8-bit registers.
+*
+* @param    reg0            Address of the register for entries 0-7
+* @param    index           Table entry
+* @param    set             Nonzero to set the bit
+*
+* @return   None
+******************************************************************************/
+static void halRfSrcMatchSetBit(unsigned long reg0, unsigned char index,
+                                unsigned char set)
+{
+    unsigned long reg = reg0 + ((index / 8) * 4);
+
+    if(set)
+    {
+        HWREG(reg) |= BV(index % 8);
+    }
+    else
+    {
+        HWREG(reg) &= ~BV(index % 8);
+    }
+}
+
+
 #ifndef MRFI
 /**************************************************************************//**
 * @brief    Interrupt service routine that handles RFPKTDONE interrupt.
@@ -675,17 +1339,32 @@ static void halRfIsr(void)
 
     if(HWREG(RFCORE_SFR_RFIRQF0) & IRQ_RXPKTDONE)
     {
+        // Clear RXPKTDONE interrupt before running the custom ISR so that a
+        // frame completed while the ISR runs raises a new interrupt.
+        HWREG(RFCORE_SFR_RFIRQF0) = HWREG(RFCORE_SFR_RFIRQF0) & ~IRQ_RXPKTDONE;
+
+        // Clear general RF interrupt flag
+        IntPendClear(INT_RFCORERTX);
+
         if(pfISR)
         {
             // Execute the custom ISR
             (*pfISR)();
         }
+    }
 
-        // Clear general RF interrupt flag
+    if((HWREG(RFCORE_XREG_RFIRQM1) & BV(1)) &&
+       (HWREG(RFCORE_SFR_RFIRQF1) & IRQ_TXDONE))
+    {
+        // Clear TXDONE interrupt
+        HWREG(RFCORE_SFR_RFIRQF1) = HWREG(RFCORE_SFR_RFIRQF1) & ~IRQ_TXDONE;
         IntPendClear(INT_RFCORERTX);
 
-        // Clear RXPKTDONE interrupt
-        HWREG(RFCORE_SFR_RFIRQF0) = HWREG(RFCORE_SFR_RFIRQF0) & ~IRQ_RXPKTDONE;
+        if(pfTxISR)
+        {
+            // Execute the custom ISR
+            (*pfTxISR)();
+        }
     }
 
     HAL_INT_UNLOCK(s);
@@ -693,6 +1372,33 @@ static void halRfIsr(void)
 #endif
 
 
+/**************************************************************************//**
+* @brief    Interrupt service routine that handles the MAC timer compare
+*           interrupt. The compare is one-shot and is disarmed before the
+*           custom ISR runs, so the custom ISR may re-arm it.
+*
+* @return   None
+******************************************************************************/
+static void halRfMacTimerIsr(void)
+{
+    unsigned short s;
+    HAL_INT_LOCK(s);
+
+    if(HWREG(RFCORE_SFR_MTIRQF) & RFCORE_SFR_MTIRQF_MACTIMER_OVF_COMPARE1F)
+    {
+        halRfMacTimerIntDisable();
+        IntPendClear(INT_MACTIMR);
+
+        if(pfMacTimerISR)
+        {
+            (*pfMacTimerISR)();
+        }
+    }
+
+    HAL_INT_UNLOCK(s);
+}
+
+
 /**************************************************************************//**
 * Close the Doxygen group.
 * @}
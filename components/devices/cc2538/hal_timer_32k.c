@@ -52,13 +52,18 @@
 
 #include "hw_types.h"           // Using tBoolean
 #include "hw_ints.h"            // Access to SM timer interrupt vector offset
+#include "hw_sys_ctrl.h"        // Access to clock status register
 #include "interrupt.h"          // Access to driverlib interrupt fns
 #include "sleepmode.h"          // Access to driverlib sleepmode fns
+#include "sys_ctrl.h"           // Access to driverlib power mode fns
 
 
 /******************************************************************************
 * DEFINES
 */
+// The sleep timer compare value must be at least this far ahead to wake
+// the MCU up from PM2
+#define HAL_TIMER_32K_MIN_SLEEP_TICKS   5
 
 
 /******************************************************************************
@@ -158,6 +163,78 @@ void halTimer32kIntDisable(void)
 }
 
 
+/**************************************************************************//**
+* @brief    Returns the sleep timer value. The sleep timer runs in all power
+*           modes except PM3.
+*
+* @return   Sleep timer value, 32768 Hz, wraps at 2^32
+******************************************************************************/
+uint32 halTimer32kReadTimerValue(void)
+{
+    return SleepModeTimerCountGet();
+}
+
+
+/**************************************************************************//**
+* @brief    Set the sleep timer value of the next 32 kHz timer interrupt. Use
+*           from the connected ISR to schedule interrupts at exact times
+*           instead of every \c cycles; the ISR is run after the interval
+*           set by halTimer32kInit() has been applied.
+*
+* @param    value       Absolute sleep timer value, at least 3 periods ahead
+*
+* @return   None
+******************************************************************************/
+void halTimer32kSetCompare(uint32 value)
+{
+    SleepModeTimerCompareSet(value);
+}
+
+
+/**************************************************************************//**
+* @brief    Put the MCU in PM2 for \c ticks periods of the 32 kHz clock, or
+*           until another interrupt wakes it up. The function returns when
+*           the 32 MHz crystal oscillator, which the radio needs, is stable
+*           again. The sleep timer compare value is changed, so this can not
+*           be combined with the periodic interrupt set up by
+*           halTimer32kInit().
+*
+* @param    ticks       Number of 32 kHz periods to sleep, at least 5
+*
+* @return   None
+******************************************************************************/
+void halTimer32kMcuSleepTicks(uint16 ticks)
+{
+    tBoolean intDisabled;
+
+    if(ticks < HAL_TIMER_32K_MIN_SLEEP_TICKS)
+    {
+        ticks = HAL_TIMER_32K_MIN_SLEEP_TICKS;
+    }
+
+    // Pending interrupts end WFI even with interrupts masked
+    intDisabled = IntMasterDisable();
+    SleepModeIntRegister(&halTimer32kIsr);
+    SleepModeTimerCompareSet(SleepModeTimerCountGet() + ticks);
+    IntPendClear(INT_SMTIM);
+    IntEnable(INT_SMTIM);
+
+    SysCtrlPowerModeSet(SYS_CTRL_PM_2);
+    SysCtrlDeepSleep();
+
+    // The system runs from the 16 MHz RC oscillator until the crystal
+    // oscillator is stable
+    if(!(HWREG(SYS_CTRL_CLOCK_CTRL) & SYS_CTRL_CLOCK_CTRL_OSC))
+    {
+        while(HWREG(SYS_CTRL_CLOCK_STA) & SYS_CTRL_CLOCK_STA_OSC);
+    }
+
+    IntDisable(INT_SMTIM);
+    IntPendClear(INT_SMTIM);
+    if(!intDisabled) IntMasterEnable();
+}
+
+
 /******************************************************************************
 * LOCAL FUNCTIONS
 */
@@ -0,0 +1,263 @@
+//*****************************************************************************
+//! @file       hal_uart.c
+//! @brief      CC2538 UART HAL implementation. Transmit only, on UART0 (the
+//!             SmartRF06EB back channel, TXD on PA1) by default.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/**************************************************************************//**
+* @addtogroup hal_uart_api
+* @{
+******************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_int.h"
+#include "hal_uart.h"
+
+#include "hw_types.h"               // Using HWREG() macro
+#include "hw_memmap.h"              // Peripheral base definitions
+#include "hw_ints.h"                // Interrupt definitions
+#include "interrupt.h"              // Access to driverlib interrupt fns
+#include "gpio.h"                   // Access to driverlib GPIO fns
+#include "ioc.h"                    // Access to driverlib IO control fns
+#include "sys_ctrl.h"               // Access to driverlib clock fns
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#if (HAL_UART_TX_BUF_SIZE & (HAL_UART_TX_BUF_SIZE - 1)) || \
+    (HAL_UART_TX_BUF_SIZE > 0x8000)
+#error "HAL_UART_TX_BUF_SIZE must be a power of 2 not larger than 32768"
+#endif
+#define HAL_UART_TX_BUF_MASK        (HAL_UART_TX_BUF_SIZE - 1)
+
+// UART and TXD pin
+#ifndef HAL_UART_BASE
+#define HAL_UART_BASE               UART0_BASE
+#define HAL_UART_INT                INT_UART0
+#define HAL_UART_PERIPH             SYS_CTRL_PERIPH_UART0
+#define HAL_UART_TXD_BASE           GPIO_A_BASE
+#define HAL_UART_TXD_PIN            GPIO_PIN_1
+#define HAL_UART_TXD_SEL            IOC_MUX_OUT_SEL_UART0_TXD
+#endif
+
+// UART registers (not covered by the driverlib in this tree)
+#define UART_O_DR                   0x00000000
+#define UART_O_FR                   0x00000018
+#define UART_O_IBRD                 0x00000024
+#define UART_O_FBRD                 0x00000028
+#define UART_O_LCRH                 0x0000002C
+#define UART_O_CTL                  0x00000030
+#define UART_O_IFLS                 0x00000034
+#define UART_O_IM                   0x00000038
+#define UART_O_ICR                  0x00000044
+#define UART_O_CC                   0x00000FC8
+
+#define UART_FR_TXFF                0x00000020  // TX FIFO full
+#define UART_LCRH_FEN               0x00000010  // FIFOs enabled
+#define UART_LCRH_WLEN_8            0x00000060  // 8 data bits
+#define UART_CTL_UARTEN             0x00000001
+#define UART_CTL_TXE                0x00000100
+#define UART_IFLS_TX_1_8            0x00000000  // TX interrupt at 2 bytes left
+#define UART_INT_TX                 0x00000020
+#define UART_CC_SYSCLK              0x00000000
+
+// Lower than the radio interrupts, so that the RX FIFO is served first
+#define HAL_UART_INT_PRIORITY       0x80
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+// Transmit ring. uartTxHead is written by halUartWrite() only, uartTxTail
+// with interrupts disabled only.
+static uint8 uartTxBuf[HAL_UART_TX_BUF_SIZE];
+static volatile uint16 uartTxHead;
+static volatile uint16 uartTxTail;
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Moves bytes from the transmit buffer to the UART TX FIFO until the
+*           FIFO is full or the buffer is empty. Must be called with
+*           interrupts disabled. While bytes are left the TX FIFO drains
+*           through the interrupt level, so the UART interrupt comes back.
+*
+* @return   None
+******************************************************************************/
+static void halUartTxFill(void)
+{
+    unsigned short tail = uartTxTail;
+
+    while((tail != uartTxHead) && !(HWREG(HAL_UART_BASE + UART_O_FR) & UART_FR_TXFF))
+    {
+        HWREG(HAL_UART_BASE + UART_O_DR) = uartTxBuf[tail & HAL_UART_TX_BUF_MASK];
+        tail++;
+    }
+    uartTxTail = tail;
+}
+
+
+/**************************************************************************//**
+* @brief    UART interrupt service routine
+*
+* @return   None
+******************************************************************************/
+static void halUartIsr(void)
+{
+    unsigned short key;
+
+    HWREG(HAL_UART_BASE + UART_O_ICR) = UART_INT_TX;
+    key = halIntLock();
+    halUartTxFill();
+    halIntUnlock(key);
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Sets up the UART for 8N1 output at \e baudRate and enables the
+*           UART interrupt. The system clock is used as UART clock, so the
+*           highest rate is the system clock / 16.
+*
+* @param    baudRate    Baud rate
+*
+* @return   SUCCESS, or FAILED if the rate can not be reached
+******************************************************************************/
+unsigned char halUartInit(unsigned long baudRate)
+{
+    unsigned long clock;
+    unsigned long divisor;
+
+    // Divisor in 1/64, rounded: clock / (16 * baudRate) * 64
+    clock = SysCtrlClockGet();
+    if(baudRate == 0 || baudRate > clock / 16)
+    {
+        return FAILED;
+    }
+    divisor = (clock * 8 / baudRate + 1) / 2;
+
+    SysCtrlPeripheralEnable(HAL_UART_PERIPH);
+    HWREG(HAL_UART_BASE + UART_O_CTL) = 0;
+    HWREG(HAL_UART_BASE + UART_O_CC) = UART_CC_SYSCLK;
+
+    IOCPinConfigPeriphOutput(HAL_UART_TXD_BASE, HAL_UART_TXD_PIN, HAL_UART_TXD_SEL);
+    GPIOPinTypeUARTOutput(HAL_UART_TXD_BASE, HAL_UART_TXD_PIN);
+
+    // The divisor is latched when LCRH is written
+    HWREG(HAL_UART_BASE + UART_O_IBRD) = divisor >> 6;
+    HWREG(HAL_UART_BASE + UART_O_FBRD) = divisor & 0x3F;
+    HWREG(HAL_UART_BASE + UART_O_LCRH) = UART_LCRH_WLEN_8 | UART_LCRH_FEN;
+    HWREG(HAL_UART_BASE + UART_O_IFLS) = UART_IFLS_TX_1_8;
+
+    uartTxHead = 0;
+    uartTxTail = 0;
+
+    HWREG(HAL_UART_BASE + UART_O_ICR) = UART_INT_TX;
+    HWREG(HAL_UART_BASE + UART_O_IM) = UART_INT_TX;
+    IntPrioritySet(HAL_UART_INT, HAL_UART_INT_PRIORITY);
+    IntRegister(HAL_UART_INT, &halUartIsr);
+    IntEnable(HAL_UART_INT);
+
+    HWREG(HAL_UART_BASE + UART_O_CTL) = UART_CTL_UARTEN | UART_CTL_TXE;
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Queues bytes for output. Either all bytes are queued or none, so
+*           that records written in one call are never cut. Must not be
+*           called from more than one context at a time.
+*
+* @param    pData       Bytes to send
+* @param    length      Number of bytes
+*
+* @return   SUCCESS, or FAILED if the transmit buffer has no room
+******************************************************************************/
+unsigned char halUartWrite(const unsigned char* pData, unsigned short length)
+{
+    unsigned short head;
+    unsigned short key;
+
+    if(length > halUartTxFree())
+    {
+        return FAILED;
+    }
+
+    head = uartTxHead;
+    while(length > 0)
+    {
+        uartTxBuf[head & HAL_UART_TX_BUF_MASK] = *pData++;
+        head++;
+        length--;
+    }
+    uartTxHead = head;
+
+    // Start the output if the TX FIFO has room
+    key = halIntLock();
+    halUartTxFill();
+    halIntUnlock(key);
+
+    return SUCCESS;
+}
+
+
+/**************************************************************************//**
+* @brief    Returns the free space in the transmit buffer
+*
+* @return   Number of bytes that can be queued
+******************************************************************************/
+unsigned short halUartTxFree(void)
+{
+    return HAL_UART_TX_BUF_SIZE - (unsigned short)(uartTxHead - uartTxTail);
+}
+
+
+/**************************************************************************//**
+* Close the Doxygen group.
+* @}
+******************************************************************************/
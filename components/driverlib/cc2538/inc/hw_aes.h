@@ -0,0 +1,195 @@
+/******************************************************************************
+*  Filename:       hw_aes.h
+*  Revised:        $Date$
+*  Revision:       $Revision$
+*
+*  Copyright (C) 2013 Texas Instruments Incorporated - http://www.ti.com/
+*
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*    Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+*    Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+*    Neither the name of Texas Instruments Incorporated nor the names of
+*    its contributors may be used to endorse or promote products derived
+*    from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+*  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+*  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+*  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+*  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+*  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+*  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+*  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+******************************************************************************/
+
+#ifndef __HW_AES_H__
+#define __HW_AES_H__
+
+//*****************************************************************************
+//
+// The following are defines for the AES register offsets.
+//
+//*****************************************************************************
+#define AES_DMAC_CH0_CTRL       0x4008B000  // Channel 0 control
+
+#define AES_DMAC_CH0_EXTADDR    0x4008B004  // Channel 0 external address
+
+#define AES_DMAC_CH0_DMALENGTH  0x4008B00C  // Channel 0 DMA length
+
+#define AES_DMAC_STATUS         0x4008B018  // DMAC status
+
+#define AES_DMAC_CH1_CTRL       0x4008B020  // Channel 1 control
+
+#define AES_DMAC_CH1_EXTADDR    0x4008B024  // Channel 1 external address
+
+#define AES_DMAC_CH1_DMALENGTH  0x4008B02C  // Channel 1 DMA length
+
+#define AES_KEY_STORE_WRITE_AREA \
+                                0x4008B400  // Key store write area
+
+#define AES_KEY_STORE_WRITTEN_AREA \
+                                0x4008B404  // Key store written area
+
+#define AES_KEY_STORE_SIZE      0x4008B408  // Key store size
+
+#define AES_KEY_STORE_READ_AREA 0x4008B40C  // Key store read area
+
+#define AES_AES_CTRL            0x4008B550  // AES input/output buffer control
+
+#define AES_AES_C_LENGTH_0      0x4008B554  // Crypto data length, LSW
+
+#define AES_AES_C_LENGTH_1      0x4008B558  // Crypto data length, MSW
+
+#define AES_CTRL_ALG_SEL        0x4008B700  // Algorithm select
+
+#define AES_CTRL_SW_RESET       0x4008B740  // Software reset
+
+#define AES_CTRL_INT_CFG        0x4008B780  // Interrupt configuration
+
+#define AES_CTRL_INT_EN         0x4008B784  // Interrupt enable
+
+#define AES_CTRL_INT_CLR        0x4008B788  // Interrupt clear
+
+#define AES_CTRL_INT_STAT       0x4008B790  // Interrupt status
+
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_DMAC_CH0_CTRL register.
+//
+//*****************************************************************************
+#define AES_DMAC_CH0_CTRL_EN    0x00000001  // Channel enable
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_DMAC_CH1_CTRL register.
+//
+//*****************************************************************************
+#define AES_DMAC_CH1_CTRL_EN    0x00000001  // Channel enable
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_KEY_STORE_SIZE register.
+//
+//*****************************************************************************
+#define AES_KEY_STORE_SIZE_KEY_SIZE_M \
+                                0x00000003
+#define AES_KEY_STORE_SIZE_KEY_SIZE_128 \
+                                0x00000001  // 128-bit keys
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_KEY_STORE_READ_AREA register.
+//
+//*****************************************************************************
+#define AES_KEY_STORE_READ_AREA_BUSY \
+                                0x80000000  // Key is being loaded
+#define AES_KEY_STORE_READ_AREA_AREA_M \
+                                0x0000000F
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_AES_CTRL register.
+//
+//*****************************************************************************
+#define AES_AES_CTRL_DIRECTION_ENCRYPT \
+                                0x00000004  // 1: encrypt, 0: decrypt
+#define AES_AES_CTRL_INPUT_READY \
+                                0x00000002
+#define AES_AES_CTRL_OUTPUT_READY \
+                                0x00000001
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_CTRL_ALG_SEL register.
+//
+//*****************************************************************************
+#define AES_CTRL_ALG_SEL_KEYSTORE \
+                                0x00000001  // DMA to the key store
+#define AES_CTRL_ALG_SEL_AES    0x00000002  // DMA to the AES engine
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_CTRL_INT_CFG register.
+//
+//*****************************************************************************
+#define AES_CTRL_INT_CFG_LEVEL  0x00000001  // Level interrupt
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_CTRL_INT_EN register.
+//
+//*****************************************************************************
+#define AES_CTRL_INT_EN_DMA_IN_DONE \
+                                0x00000002
+#define AES_CTRL_INT_EN_RESULT_AV \
+                                0x00000001
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_CTRL_INT_CLR register.
+//
+//*****************************************************************************
+#define AES_CTRL_INT_CLR_DMA_BUS_ERR \
+                                0x80000000
+#define AES_CTRL_INT_CLR_KEY_ST_WR_ERR \
+                                0x40000000
+#define AES_CTRL_INT_CLR_KEY_ST_RD_ERR \
+                                0x20000000
+#define AES_CTRL_INT_CLR_DMA_IN_DONE \
+                                0x00000002
+#define AES_CTRL_INT_CLR_RESULT_AV \
+                                0x00000001
+//*****************************************************************************
+//
+// The following are defines for the bit fields in the 
+// AES_CTRL_INT_STAT register.
+//
+//*****************************************************************************
+#define AES_CTRL_INT_STAT_DMA_BUS_ERR \
+                                0x80000000
+#define AES_CTRL_INT_STAT_KEY_ST_WR_ERR \
+                                0x40000000
+#define AES_CTRL_INT_STAT_KEY_ST_RD_ERR \
+                                0x20000000
+#define AES_CTRL_INT_STAT_DMA_IN_DONE \
+                                0x00000002
+#define AES_CTRL_INT_STAT_RESULT_AV \
+                                0x00000001
+
+
+#endif // __HW_AES_H__
+
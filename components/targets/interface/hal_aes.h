@@ -0,0 +1,81 @@
+//*****************************************************************************
+//! @file       hal_aes.h
+//! @brief      AES HAL header file.
+//!
+//!             Single block AES-128 encryption, used by the Basic RF library
+//!             to build CCM* frame protection. Only the forward cipher is
+//!             needed for CCM*.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef HAL_AES_H
+#define HAL_AES_H
+
+
+/******************************************************************************
+* If building with a C++ compiler, make all of the definitions in this header
+* have a C binding.
+******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define HAL_AES_BLOCK_SIZE          16
+#define HAL_AES_KEY_SIZE            16
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 halAesLoadKey(const uint8* pKey);
+uint8 halAesEncrypt(const uint8* pIn, uint8* pOut);
+
+
+/******************************************************************************
+* Mark the end of the C bindings section for C++ compilers.
+******************************************************************************/
+#ifdef  __cplusplus
+}
+#endif
+#endif // #ifndef HAL_AES_H
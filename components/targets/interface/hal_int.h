@@ -132,6 +132,7 @@ void   halIntOn(void);
 void   halIntOff(void);
 uint16 halIntLock(void);
 void   halIntUnlock(uint16 key);
+void   halIntWait(void);
 
 
 /*******************************************************************************
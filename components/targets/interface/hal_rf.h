@@ -97,6 +97,45 @@ extern "C"
 #define MIN_CHANNEL 				        11    //!< Min. channel (2405 MHz)
 #define MAX_CHANNEL                         26    //!< Max. channel (2480 MHz)
 #define CHANNEL_SPACING                     5     //!< Channel spacing in MHz
+#define HAL_RF_SYMBOL_US                    16    //!< Symbol period in us
+#define HAL_RF_BACKOFF_PERIOD               20    //!< aUnitBackoffPeriod (symbols)
+
+// IEEE 802.15.4 unslotted CSMA-CA parameters
+#define HAL_RF_MAC_MIN_BE                   3     //!< macMinBE
+#define HAL_RF_MAC_MAX_BE                   5     //!< macMaxBE
+#define HAL_RF_MAC_MAX_CSMA_BACKOFFS        4     //!< macMaxCSMABackoffs
+
+// halRfTransmit() return value in addition to SUCCESS and FAILED
+#define HAL_RF_CHANNEL_ACCESS_FAILURE       2
+
+// MAC timer. The overflow counter of the MAC timer counts symbol periods and
+// wraps at HAL_RF_MAC_TIMER_MASK.
+#define HAL_RF_MAC_TIMER_MASK               0x00FFFFFF
+
+// halRfMacTimerGetUs() wraps at HAL_RF_MAC_TIMER_US_MASK (268 s)
+#define HAL_RF_MAC_TIMER_US_MASK            0x0FFFFFFF
+
+// Number of short address entries in the source address matching table
+#define HAL_RF_SRC_MATCH_SHORT_ENTRIES      24
+
+// TX power levels. Not all are supported by every module, see
+// halRfGetTxPowerLevels().
+#define HAL_RF_TXPOWER_22_DBM               22
+#define HAL_RF_TXPOWER_20_DBM               20
+#define HAL_RF_TXPOWER_16_DBM               16
+#define HAL_RF_TXPOWER_13_DBM               13
+#define HAL_RF_TXPOWER_7_DBM                7
+#define HAL_RF_TXPOWER_4_DBM                4
+#define HAL_RF_TXPOWER_3_DBM                3
+#define HAL_RF_TXPOWER_0_DBM                0
+#define HAL_RF_TXPOWER_MIN_3_DBM            (0x80|3)
+#define HAL_RF_TXPOWER_MIN_9_DBM            (0x80|9)
+#define HAL_RF_TXPOWER_MIN_15_DBM           (0x80|15)
+
+// Output power in dBm of a HAL_RF_TXPOWER_* level
+#define HAL_RF_TXPOWER_DBM(power)           (((power) & 0x80) ? \
+                                             -(int8)((power) & 0x7F) : \
+                                             (int8)(power))
 
 
 /******************************************************************************
@@ -105,19 +144,30 @@ extern "C"
 // Generic RF interface
 uint8 halRfInit(void);
 uint8 halRfSetTxPower(uint8 power);
+uint8 halRfApplyTxPower(uint8 power);
+uint8 halRfGetTxPower(void);
+uint8 halRfGetTxPowerLevels(const uint8** ppLevels);
 uint8 halRfTransmit(void);
+void  halRfTransmitStart(void);
+uint8 halRfTransmitCca(void);
+uint8 halRfChannelClear(void);
 void  halRfSetGain(uint8 gainMode);     // With CC2590/91 only
+uint8 halRfGetGain(void);
 uint8 halRfSetModule(uint8 emModule);   // with/without CC2590?
 
 uint16 halRfGetChipId(void);
 uint8 halRfGetChipVer(void);
 uint8 halRfGetRandomByte(void);
 uint8 halRfGetRssiOffset(void);
+int8  halRfGetRssi(void);
 
 void  halRfWriteTxBuf(uint8* pData, uint8 length);
 void  halRfAppendTxBuf(uint8* pData, uint8 length);
 void  halRfReadRxBuf(uint8* pData, uint8 length);
+uint8 halRfRxFrameReady(void);
+uint8 halRfRxFifoOverflow(void);
 void  halRfWaitTransceiverReady(void);
+uint8 halRfTransceiverReady(void);
 uint8 halRfReadMemory(uint16 addr, uint8* pData, uint8 length);
 uint8 halRfWriteMemory(uint16 addr, uint8* pData, uint8 length);
 
@@ -126,11 +176,28 @@ void  halRfReceiveOff(void);
 void  halRfDisableRxInterrupt(void);
 void  halRfEnableRxInterrupt(void);
 void  halRfRxInterruptConfig(ISR_FUNC_PTR pfISR);
+void  halRfDisableTxInterrupt(void);
+void  halRfEnableTxInterrupt(void);
+void  halRfTxInterruptConfig(ISR_FUNC_PTR pfISR);
+
+// MAC timer interface (time unit is symbol periods)
+uint32 halRfMacTimerGet(void);
+uint32 halRfMacTimerGetUs(void);
+void  halRfMacTimerSetCompare(uint32 symbolTime);
+void  halRfMacTimerIntConnect(ISR_FUNC_PTR pfISR);
+void  halRfMacTimerIntDisable(void);
+void  halRfMacTimerSleep(void);
+void  halRfMacTimerWake(void);
 
 // IEEE 802.15.4 specific interface
 void  halRfSetChannel(uint8 channel);
 void  halRfSetShortAddr(uint16 shortAddr);
+void  halRfSetExtAddr(const uint8* pExtAddr);
 void  halRfSetPanId(uint16 PanId);
+void  halRfSetPromiscuous(uint8 enable);
+void  halRfSrcMatchSetShort(uint8 index, uint16 panId, uint16 shortAddr);
+void  halRfSrcMatchClearShort(uint8 index);
+void  halRfSrcMatchSetPending(uint8 index, uint8 pending);
 
 
 /******************************************************************************
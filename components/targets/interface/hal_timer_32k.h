@@ -72,7 +72,8 @@ void halTimer32kIntDisable(void);
 void halTimer32kAbort(void);
 void halTimer32kSetIntFrequency(uint16 rate);
 void halTimer32kMcuSleepTicks(uint16 ticks);
-uint16 halTimer32kReadTimerValue(void);
+void halTimer32kSetCompare(uint32 value);
+uint32 halTimer32kReadTimerValue(void);
 
 
 /******************************************************************************
@@ -0,0 +1,86 @@
+//*****************************************************************************
+//! @file       hal_uart.h
+//! @brief      UART HAL header file.
+//!
+//!             Interrupt driven, transmit only UART output with a transmit
+//!             buffer of HAL_UART_TX_BUF_SIZE bytes. halUartWrite() only
+//!             copies data to the buffer, so it can be called from interrupt
+//!             context; the buffer is drained to the UART from the UART
+//!             interrupt.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+#ifndef HAL_UART_H
+#define HAL_UART_H
+
+
+/******************************************************************************
+* If building with a C++ compiler, make all of the definitions in this header
+* have a C binding.
+******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include "hal_types.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Transmit buffer size, a power of 2
+#ifndef HAL_UART_TX_BUF_SIZE
+#define HAL_UART_TX_BUF_SIZE        2048
+#endif
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+uint8 halUartInit(uint32 baudRate);
+uint8 halUartWrite(const uint8* pData, uint16 length);
+uint16 halUartTxFree(void);
+
+
+/******************************************************************************
+* Mark the end of the C bindings section for C++ compilers.
+******************************************************************************/
+#ifdef  __cplusplus
+}
+#endif
+#endif // #ifndef HAL_UART_H
@@ -49,6 +49,7 @@
 #include "hal_types.h"
 #include "hal_defs.h"
 #include "hal_int.h"
+#include "cpu.h"                    // Access to driverlib CPUwfi()
 
 
 /**************************************************************************//**
@@ -101,6 +102,21 @@ void halIntUnlock(uint16 key)
 }
 
 
+/**************************************************************************//**
+* @brief    Puts the CPU to sleep until an interrupt is pending. Call with
+*           global interrupts off: a pending interrupt ends the wait even
+*           though it is not served, so an interrupt that comes after a
+*           condition was checked and before the wait is not missed. The
+*           interrupt is served when interrupts are turned on again.
+*
+* @return   None
+******************************************************************************/
+void halIntWait(void)
+{
+    CPUwfi();
+}
+
+
 /**************************************************************************//**
 * Close the Doxygen group.
 * @}
@@ -0,0 +1,214 @@
+//*****************************************************************************
+//! @file       frag_loopback.c
+//! @brief      Host loopback test of the Basic RF fragmentation layer.
+//!
+//!             Sends datagrams with basicRfFragSend() from a node to itself
+//!             on a PC. basicRfSendPacketAsync() is replaced by a queue
+//!             whose frames are fed to basicRfFragInput() once per poll, and
+//!             the MAC timer advances a fixed number of symbols per poll.
+//!             All datagrams have the same length and the same sender, so
+//!             the 8-bit tag wraps and reassembly buffers are reused. Each
+//!             datagram must be reported BASIC_RF_FRAG_DONE and be read back
+//!             unchanged with basicRfFragReceive().
+//!
+//!             Build and run from the repository root, optionally with
+//!             -DBASIC_RF_FRAG_POOL_SIZE=<n>:
+//!
+//!             gcc -O2 -DDESKTOP -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/frag_loopback.c
+//!                 components/basic_rf/basic_rf_frag.c -o frag_loopback
+//!             ./frag_loopback [datagrams] [symbols per poll]
+//!
+//!             The program exits with 1 if a datagram was not delivered.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_rf.h"
+#include "basic_rf.h"
+#include "basic_rf_frag.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define LOOP_ADDR               0x1234
+#define LOOP_QUEUE_SIZE         64
+#define LOOP_DATAGRAM_SIZE      200
+#define LOOP_DEFAULT_DATAGRAMS  600
+#define LOOP_DEFAULT_STEP       100     // Symbols per poll
+
+
+/******************************************************************************
+* TYPEDEFS
+*/
+typedef struct {
+    uint8 payload[BASIC_RF_MAX_PAYLOAD_SIZE];
+    uint8 length;
+    basicRfTxDoneCb_t pfTxDone;
+} loopFrame_t;
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static uint32 nowSymbols;
+static loopFrame_t loopQueue[LOOP_QUEUE_SIZE];
+static loopFrame_t loopDeliver[LOOP_QUEUE_SIZE];
+static uint8 loopCount;
+
+
+/******************************************************************************
+* MODEL OF THE HAL AND BASIC RF
+*/
+uint32 halRfMacTimerGet(void) { return nowSymbols & HAL_RF_MAC_TIMER_MASK; }
+uint16 halIntLock(void) { return 0; }
+void halIntUnlock(uint16 key) { (void)key; }
+
+uint8 basicRfSendPacketAsync(uint16 destAddr, uint8* pPayload, uint8 length,
+                             uint8 priority, basicRfTxDoneCb_t pfTxDone)
+{
+  (void)destAddr;
+  (void)priority;
+
+  if (loopCount >= LOOP_QUEUE_SIZE || length > BASIC_RF_MAX_PAYLOAD_SIZE) {
+    return FAILED;
+  }
+  memcpy(loopQueue[loopCount].payload, pPayload, length);
+  loopQueue[loopCount].length = length;
+  loopQueue[loopCount].pfTxDone = pfTxDone;
+  loopCount++;
+
+  return SUCCESS;
+}
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Delivers the frames sent since the last call. Frames sent while
+*           delivering are left for the next call.
+*
+* @return   None
+******************************************************************************/
+static void loopDeliverFrames(void)
+{
+  basicRfRxFrame_t frame;
+  uint8 count;
+  uint8 i;
+
+  count = loopCount;
+  memcpy(loopDeliver, loopQueue, count * sizeof(loopQueue[0]));
+  loopCount = 0;
+
+  for (i = 0; i < count; i++) {
+    memset(&frame, 0, sizeof(frame));
+    frame.pPayload = loopDeliver[i].payload;
+    frame.length = loopDeliver[i].length;
+    frame.srcAddr = LOOP_ADDR;
+    frame.dstAddr = LOOP_ADDR;
+    frame.timestamp = halRfMacTimerGet();
+    basicRfFragInput(&frame);
+    if (loopDeliver[i].pfTxDone != NULL) {
+      loopDeliver[i].pfTxDone(0, BASIC_RF_TX_SENT, 0);
+    }
+  }
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Sends the datagrams and checks that each one is delivered
+*
+* @return   0 if all datagrams were delivered, otherwise 1
+******************************************************************************/
+int main(int argc, char** argv)
+{
+  static uint8 data[LOOP_DATAGRAM_SIZE];
+  static uint8 rxBuf[BASIC_RF_FRAG_MAX_DATAGRAM];
+  uint32 datagrams = LOOP_DEFAULT_DATAGRAMS;
+  uint32 step = LOOP_DEFAULT_STEP;
+  uint32 lost = 0;
+  uint32 k;
+  uint16 length;
+
+  if (argc > 1) {
+    datagrams = (uint32)atol(argv[1]);
+  }
+  if (argc > 2) {
+    step = (uint32)atol(argv[2]);
+  }
+
+  basicRfFragInit();
+
+  for (k = 1; k <= datagrams; k++) {
+    memset(data, (uint8)k, sizeof(data));
+    data[0] = HI_UINT16(k);
+    if (basicRfFragSend(LOOP_ADDR, data, sizeof(data)) != SUCCESS) {
+      printf("#%lu: basicRfFragSend() failed\n", (unsigned long)k);
+      return 1;
+    }
+    while (basicRfFragSendStatus() == BASIC_RF_FRAG_BUSY) {
+      basicRfFragPoll();
+      loopDeliverFrames();
+      nowSymbols += step;
+    }
+
+    length = basicRfFragReceive(rxBuf, sizeof(rxBuf), NULL);
+    if (basicRfFragSendStatus() != BASIC_RF_FRAG_DONE ||
+        length != sizeof(data) || memcmp(rxBuf, data, length) != 0) {
+      printf("#%lu: not delivered (status %u, length %u)\n", (unsigned long)k,
+             basicRfFragSendStatus(), length);
+      lost++;
+    }
+  }
+
+  printf("pool %u: %lu of %lu datagrams lost\n", BASIC_RF_FRAG_POOL_SIZE,
+         (unsigned long)lost, (unsigned long)datagrams);
+
+  return (lost == 0) ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+//*****************************************************************************
+//! @file       frame_check.c
+//! @brief      Host driver for the Basic RF frame codec.
+//!
+//!             Runs basicRfFrameRoundTrip() and basicRfFrameBenchmark() on a
+//!             PC and prints their results. The program exits with 1 if a
+//!             combination failed the round-trip check or a frame of the
+//!             benchmark mix did not parse, so it can be used as a test.
+//!
+//!             Build and run from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_FRAME_HOST -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/frame_check.c
+//!                 components/basic_rf/basic_rf_frame.c -o frame_check
+//!             ./frame_check
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "basic_rf_frame.h"
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Runs the round-trip check and the benchmark of the frame codec
+*
+* @return   0 if both passed, otherwise 1
+******************************************************************************/
+int main(void)
+{
+  basicRfFrameCheck_t check;
+  basicRfFrameBench_t bench;
+  uint8 status;
+
+  status = basicRfFrameRoundTrip(&check);
+  printf("Round trip: %lu combinations, %lu valid frames, %lu errors\n",
+         (unsigned long)check.frames, (unsigned long)check.validFrames,
+         (unsigned long)check.errors);
+  if (status != SUCCESS || check.errors != 0) {
+    return 1;
+  }
+
+  if (basicRfFrameBenchmark(&bench) != SUCCESS) {
+    printf("Benchmark: a frame of the mix did not parse\n");
+    return 1;
+  }
+  printf("Parse: %lu frames/s, %lu ns per frame\n",
+         (unsigned long)bench.parsedPerSec, (unsigned long)bench.parseNs);
+  printf("Write: %lu frames/s, %lu ns per frame\n",
+         (unsigned long)bench.writtenPerSec, (unsigned long)bench.writeNs);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+//*****************************************************************************
+//! @file       rxq_bench.c
+//! @brief      Host driver for basicRfRxqBenchmark().
+//!
+//!             Feeds a burst of back-to-back frames through the Basic RF
+//!             receive queue on a PC, for a range of application drain
+//!             delays, and prints how many frames are dropped. The queue
+//!             size is set at build time with BASIC_RF_RX_QUEUE_SIZE.
+//!
+//!             Build and run from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_RXQ_HOST
+//!                 -DBASIC_RF_RX_QUEUE_SIZE=4 -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/rxq_bench.c
+//!                 components/basic_rf/basic_rf_rxq.c -o rxq_bench
+//!             ./rxq_bench [payload length] [frames]
+//!
+//!             The program exits with 1 if the benchmark fails, or if a
+//!             frame is neither received nor counted as dropped.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "basic_rf_rxq.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define BENCH_DEFAULT_PAYLOAD   50
+#define BENCH_DEFAULT_FRAMES    100
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+// Application drain delays, us
+static const uint32 benchDelays[] = {
+  2000, 4000, 10000, 15000, 20000, 50000, 100000
+};
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Runs the benchmark for each drain delay
+*
+* @return   0 on success, otherwise 1
+******************************************************************************/
+int main(int argc, char** argv)
+{
+  basicRfRxqBench_t result;
+  uint8 payloadLength = BENCH_DEFAULT_PAYLOAD;
+  uint16 frames = BENCH_DEFAULT_FRAMES;
+  uint8 i;
+
+  if (argc > 1) payloadLength = (uint8)atoi(argv[1]);
+  if (argc > 2) frames = (uint16)atoi(argv[2]);
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [payload length] [frames]\n", argv[0]);
+    return 1;
+  }
+
+  printf("Queue size %u, %u frames with a %u byte payload\n",
+         BASIC_RF_RX_QUEUE_SIZE, frames, payloadLength);
+  for (i = 0; i < sizeof(benchDelays) / sizeof(benchDelays[0]); i++) {
+    if (basicRfRxqBenchmark(payloadLength, frames, benchDelays[i],
+                            &result) != SUCCESS ||
+        result.received + result.dropped != frames) {
+      printf("basicRfRxqBenchmark() failed\n");
+      return 1;
+    }
+    if (i == 0) {
+      printf("%lu us per frame\n", (unsigned long)result.frameUs);
+      printf("drain delay   received   dropped   max depth\n");
+    }
+    printf("%8lu us   %8u   %7u   %9u\n", (unsigned long)benchDelays[i],
+           result.received, result.dropped, result.maxDepth);
+  }
+
+  return 0;
+}
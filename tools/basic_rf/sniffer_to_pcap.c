@@ -0,0 +1,123 @@
+//*****************************************************************************
+//! @file       sniffer_to_pcap.c
+//! @brief      Converts a Basic RF sniffer capture to a .pcap file.
+//!
+//!             Reads a file of the UART stream sent by basicRfSnifferInit()
+//!             on the device, e.g. captured with a terminal program, and
+//!             writes a .pcap file with the IEEE 802.15.4 TAP link type for
+//!             Wireshark using basicRfSnifferToPcap().
+//!
+//!             Build from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_SNIFFER_HOST -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/sniffer_to_pcap.c
+//!                 components/basic_rf/basic_rf_sniffer.c -o sniffer_to_pcap
+//!
+//!             Usage:
+//!
+//!             sniffer_to_pcap <capture file> <pcap file> [start time]
+//!
+//!             The start time is the time of the first record in seconds
+//!             since 1970, by default the current time. The program exits
+//!             with 1 if a file can not be opened or written.
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "basic_rf_sniffer.h"
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Converts the capture file named by the first argument to the
+*           .pcap file named by the second
+*
+* @return   0 on success, otherwise 1
+******************************************************************************/
+int main(int argc, char** argv)
+{
+  basicRfSnifferDecodeStats_t stats;
+  uint32 startTime;
+  FILE* pIn;
+  FILE* pOut;
+  uint8 status;
+
+  if (argc < 3 || argc > 4) {
+    fprintf(stderr, "Usage: %s <capture file> <pcap file> [start time]\n",
+            argv[0]);
+    return 1;
+  }
+  startTime = (argc == 4) ? (uint32)strtoul(argv[3], NULL, 0) :
+                            (uint32)time(NULL);
+
+  pIn = fopen(argv[1], "rb");
+  if (pIn == NULL) {
+    fprintf(stderr, "Can not open %s\n", argv[1]);
+    return 1;
+  }
+  pOut = fopen(argv[2], "wb");
+  if (pOut == NULL) {
+    fprintf(stderr, "Can not create %s\n", argv[2]);
+    fclose(pIn);
+    return 1;
+  }
+
+  status = basicRfSnifferToPcap(pIn, pOut, startTime, &stats);
+  fclose(pIn);
+  if (fclose(pOut) != 0) {
+    status = FAILED;
+  }
+  if (status != SUCCESS) {
+    fprintf(stderr, "Error writing %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("%lu frames (%lu with CRC errors), %lu bytes skipped\n",
+         (unsigned long)stats.records, (unsigned long)stats.crcErrors,
+         (unsigned long)stats.skippedBytes);
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+//*****************************************************************************
+//! @file       tpc_sim.c
+//! @brief      Host driver for the Basic RF TX power control simulation.
+//!
+//!             Runs basicRfTpcSimulate() on a PC and prints the results of
+//!             the run at the highest level and the run with power control.
+//!             The defaults are 30 nodes in a 120 m square, path loss
+//!             exponent 3.3, 6 dB shadowing and 2 dB fading, with 500
+//!             frames of 20 bytes per node.
+//!
+//!             Build and run from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_TPC_SIM -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/tpc_sim.c
+//!                 components/basic_rf/basic_rf_tpc.c -lm -o tpc_sim
+//!             ./tpc_sim [nodes] [area m] [path loss exp x10] [shadowing dB]
+//!                       [seed]
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "basic_rf_tpc.h"
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Prints the results of one run
+*
+* @param    pName       Name of the run
+* @param    pRun        Results
+*
+* @return   None
+******************************************************************************/
+static void tpcSimPrintRun(const char* pName, const basicRfTpcSimRun_t* pRun)
+{
+  printf("%-14s %9lu %9lu %8lu uJ %6.1f dBm %8.2f\n", pName,
+         (unsigned long)pRun->attempts, (unsigned long)pRun->delivered,
+         (unsigned long)pRun->energy, pRun->avgPower / 10.0,
+         pRun->reach / 100.0);
+}
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Runs the simulation with the set-up given on the command line
+*
+* @return   0 on success, 1 on invalid arguments
+******************************************************************************/
+int main(int argc, char** argv)
+{
+  basicRfTpcSimCfg_t cfg = {
+    30,             // nodes
+    120,            // areaSize
+    500,            // frames
+    20,             // payloadLength
+    33,             // pathLossExp
+    6,              // shadowing
+    2,              // fading
+    -85,            // interference
+    7               // seed
+  };
+  basicRfTpcSimResult_t result;
+
+  if (argc > 1) cfg.nodes = (uint8)atoi(argv[1]);
+  if (argc > 2) cfg.areaSize = (uint8)atoi(argv[2]);
+  if (argc > 3) cfg.pathLossExp = (uint8)atoi(argv[3]);
+  if (argc > 4) cfg.shadowing = (uint8)atoi(argv[4]);
+  if (argc > 5) cfg.seed = (uint32)strtoul(argv[5], NULL, 0);
+  if (argc > 6 || cfg.nodes < 2 || cfg.nodes > BASIC_RF_TPC_SIM_MAX_NODES) {
+    fprintf(stderr, "Usage: %s [nodes 2-%u] [area m] [path loss exp x10] "
+            "[shadowing dB] [seed]\n", argv[0], BASIC_RF_TPC_SIM_MAX_NODES);
+    return 1;
+  }
+
+  basicRfTpcSimulate(&cfg, &result);
+
+  printf("%-14s %9s %9s %11s %10s %8s\n", "", "attempts", "delivered",
+         "energy", "avg power", "disturbed");
+  tpcSimPrintRun("Highest level", &result.fixed);
+  tpcSimPrintRun("Power control", &result.tpc);
+  printf("Energy per delivered frame %u%% lower, disturbed nodes %u%% fewer\n",
+         result.energySaved, result.reachReduced);
+
+  return 0;
+}
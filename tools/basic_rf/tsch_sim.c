@@ -0,0 +1,137 @@
+//*****************************************************************************
+//! @file       tsch_sim.c
+//! @brief      Host driver for the Basic RF TSCH slot engine simulation.
+//!
+//!             Builds a slotframe with a shared cell every few slots, each
+//!             on its own channel offset, runs basicRfTschSimulate() on a PC
+//!             and prints the slot length spread, the largest slot boundary
+//!             error, the schedule lookup cost and the active slots per
+//!             channel. The program exits with 1 if the schedule can not be
+//!             built or a slot boundary is off by a full 32 kHz period or
+//!             more, i.e. if slot timing drifts.
+//!
+//!             Build and run from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_TSCH_SIM -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/tsch_sim.c
+//!                 components/basic_rf/basic_rf_tsch.c -o tsch_sim
+//!             ./tsch_sim [slotframe length] [cell spacing] [slotframes]
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "basic_rf_tsch.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+#define SIM_DEFAULT_LENGTH      101
+#define SIM_DEFAULT_SPACING     7
+#define SIM_DEFAULT_SLOTFRAMES  100
+#define SIM_CHANNELS            16
+
+// One period of the 32 kHz sleep timer, ns
+#define SIM_TICK_NS             30518
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Runs the simulation with the schedule given on the command line
+*
+* @return   0 on success, otherwise 1
+******************************************************************************/
+int main(int argc, char** argv)
+{
+  basicRfTschSimResult_t result;
+  basicRfTschCell_t cell;
+  uint16 length = SIM_DEFAULT_LENGTH;
+  uint16 spacing = SIM_DEFAULT_SPACING;
+  uint32 slotframes = SIM_DEFAULT_SLOTFRAMES;
+  uint16 slot;
+  uint8 i;
+
+  if (argc > 1) length = (uint16)atoi(argv[1]);
+  if (argc > 2) spacing = (uint16)atoi(argv[2]);
+  if (argc > 3) slotframes = (uint32)strtoul(argv[3], NULL, 0);
+  if (argc > 4 || spacing == 0) {
+    fprintf(stderr, "Usage: %s [slotframe length] [cell spacing] "
+            "[slotframes]\n", argv[0]);
+    return 1;
+  }
+
+  if (basicRfTschInit(length, NULL, 0) != SUCCESS) {
+    printf("basicRfTschInit() failed\n");
+    return 1;
+  }
+  cell.options = BASIC_RF_TSCH_CELL_SHARED;
+  cell.neighbour = BASIC_RF_BROADCAST_ADDR;
+  for (slot = 0; slot < length; slot += spacing) {
+    cell.slotOffset = slot;
+    cell.channelOffset = (uint8)(slot % SIM_CHANNELS);
+    if (basicRfTschAddCell(&cell) != SUCCESS) {
+      printf("basicRfTschAddCell() failed for slot %u\n", slot);
+      return 1;
+    }
+  }
+
+  basicRfTschSimulate((uint32)length * slotframes, &result);
+
+  printf("Slots:           %lu, %lu active\n", (unsigned long)result.slots,
+         (unsigned long)result.activeSlots);
+  printf("Slot length:     %u-%u periods of 32 kHz\n", result.minSlotTicks,
+         result.maxSlotTicks);
+  printf("Boundary error:  %u ns at most\n", result.maxBoundaryError);
+  printf("Lookup:          %u.%02u cells compared on average, %u at most\n",
+         result.avgLookupSteps / 100, result.avgLookupSteps % 100,
+         result.maxLookupSteps);
+  printf("Active slots per channel 11-26:\n");
+  for (i = 0; i < SIM_CHANNELS; i++) {
+    printf(" %lu", (unsigned long)result.channelSlots[i]);
+  }
+  printf("\n");
+
+  return (result.maxBoundaryError < SIM_TICK_NS) ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+//*****************************************************************************
+//! @file       tx_bench.c
+//! @brief      Host driver for basicRfTxBenchmark().
+//!
+//!             Runs the Basic RF TX queue on a PC against a model of the
+//!             CC2538 radio and prints the packet rate for each combination
+//!             of payload length, application main loop period and queue
+//!             depth. The model is simple: the channel is always clear, a
+//!             packet is done 192 us (RX-to-TX turnaround) plus its airtime
+//!             after the STXONCCA strobe, and the MAC timer follows a
+//!             simulated clock that advances 1 us per timer read. The
+//!             figures show the effect of queue depth, not the absolute
+//!             rate on target.
+//!
+//!             Build and run from the repository root:
+//!
+//!             gcc -O2 -DDESKTOP -DBASIC_RF_TX_BENCHMARK
+//!                 -DBASIC_RF_TX_QUEUE_SIZE=8 -Icomponents/common
+//!                 -Icomponents/targets/interface -Icomponents/basic_rf
+//!                 -Icomponents/utils tools/basic_rf/tx_bench.c
+//!                 components/basic_rf/basic_rf.c
+//!                 components/basic_rf/basic_rf_nbr.c
+//!                 components/basic_rf/basic_rf_tpc.c
+//!                 components/basic_rf/basic_rf_scan.c
+//!                 components/basic_rf/basic_rf_frame.c
+//!                 components/basic_rf/basic_rf_rxq.c -o tx_bench
+//!             ./tx_bench
+//!
+//! Revised     $Date$
+//! Revision    $Revision$
+//
+//  Copyright (C) 2014 Texas Instruments Incorporated - http://www.ti.com/
+//
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//    Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//    Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+//    Neither the name of Texas Instruments Incorporated nor the names of
+//    its contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+//  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+//  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+//  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+//  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+//  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+//  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+//  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************/
+
+
+/******************************************************************************
+* INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal_types.h"
+#include "hal_defs.h"
+#include "hal_rf.h"
+#include "basic_rf.h"
+
+
+/******************************************************************************
+* CONSTANTS AND DEFINES
+*/
+// Radio model
+#define MODEL_TURNAROUND_US     192     // aTurnaroundTime, 12 symbols
+#define MODEL_US_PER_BYTE       32      // 250 kbps
+#define MODEL_PHY_OVERHEAD      6       // SHR and PHR
+#define MODEL_US_PER_FIFO_BYTE  0.125   // TX FIFO write
+#define MODEL_SLEEP_TICKS_PER_US 0.032768
+
+#define PAN_ID                  0x2007
+#define MY_ADDR                 0x0001
+#define RF_CHANNEL              25
+
+
+/******************************************************************************
+* LOCAL VARIABLES
+*/
+static double nowUs;
+static uint8 intLocked;
+static ISR_FUNC_PTR pfTxIsr;
+static ISR_FUNC_PTR pfMacTimerIsr;
+static uint8 txIntEnabled;
+static uint8 txPending;
+static double txDoneUs;
+static uint8 compareEnabled;
+static uint32 compareSymbols;
+static uint8 txFifoLength;
+
+static const uint8 benchLengths[] = { 20, 100 };
+static const uint16 benchPeriods[] = { 0, 63, 313, 625 };   // Symbols
+static const uint8 benchDepths[] = { 1, 2, 4, 8 };
+
+
+/******************************************************************************
+* LOCAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Runs the interrupts that have become due, unless interrupts are
+*           locked
+*
+* @return   None
+******************************************************************************/
+static void modelPoll(void)
+{
+  uint32 symbols;
+
+  if (intLocked) {
+    return;
+  }
+  if (txPending && txIntEnabled && nowUs >= txDoneUs) {
+    txPending = FALSE;
+    intLocked = TRUE;
+    pfTxIsr();
+    intLocked = FALSE;
+  }
+  symbols = ((uint32)(nowUs / HAL_RF_SYMBOL_US)) & HAL_RF_MAC_TIMER_MASK;
+  if (compareEnabled &&
+      ((symbols - compareSymbols) & HAL_RF_MAC_TIMER_MASK) < (HAL_RF_MAC_TIMER_MASK / 2)) {
+    compareEnabled = FALSE;
+    intLocked = TRUE;
+    pfMacTimerIsr();
+    intLocked = FALSE;
+  }
+}
+
+
+/******************************************************************************
+* MODEL OF THE HAL
+*/
+uint16 halIntLock(void) { uint16 key = intLocked; intLocked = TRUE; return key; }
+void halIntUnlock(uint16 key) { intLocked = (uint8)key; modelPoll(); }
+void halIntOff(void) { intLocked = TRUE; }
+void halIntOn(void) { intLocked = FALSE; modelPoll(); }
+void halIntWait(void) { nowUs += 1; modelPoll(); }
+
+uint32 halRfMacTimerGet(void)
+{
+  nowUs += 1;
+  modelPoll();
+  return ((uint32)(nowUs / HAL_RF_SYMBOL_US)) & HAL_RF_MAC_TIMER_MASK;
+}
+void halRfMacTimerSetCompare(uint32 t) { compareSymbols = t; compareEnabled = TRUE; }
+void halRfMacTimerIntDisable(void) { compareEnabled = FALSE; }
+void halRfMacTimerIntConnect(ISR_FUNC_PTR pf) { pfMacTimerIsr = pf; }
+void halRfMacTimerSleep(void) {}
+void halRfMacTimerWake(void) {}
+
+void halRfTxInterruptConfig(ISR_FUNC_PTR pf) { pfTxIsr = pf; }
+void halRfRxInterruptConfig(ISR_FUNC_PTR pf) { (void)pf; }
+void halRfEnableTxInterrupt(void) { txIntEnabled = TRUE; }
+void halRfDisableTxInterrupt(void) { txIntEnabled = FALSE; }
+void halRfEnableRxInterrupt(void) {}
+void halRfDisableRxInterrupt(void) {}
+
+void halRfWriteTxBuf(uint8* pData, uint8 length)
+{
+  txFifoLength = pData[0];
+  nowUs += length * MODEL_US_PER_FIFO_BYTE;
+}
+void halRfAppendTxBuf(uint8* pData, uint8 length)
+{
+  (void)pData;
+  nowUs += length * MODEL_US_PER_FIFO_BYTE;
+}
+uint8 halRfTransmitCca(void)
+{
+  txPending = TRUE;
+  txDoneUs = nowUs + MODEL_TURNAROUND_US +
+             (MODEL_PHY_OVERHEAD + txFifoLength) * MODEL_US_PER_BYTE;
+  return SUCCESS;
+}
+uint8 halRfChannelClear(void) { return TRUE; }
+uint8 halRfGetRandomByte(void) { return (uint8)rand(); }
+
+static const uint8 txPowerLevels[] = { HAL_RF_TXPOWER_0_DBM };
+uint8 halRfGetTxPowerLevels(const uint8** ppLevels) { *ppLevels = txPowerLevels; return 1; }
+uint8 halRfGetTxPower(void) { return HAL_RF_TXPOWER_0_DBM; }
+uint8 halRfApplyTxPower(uint8 power) { (void)power; return SUCCESS; }
+uint8 halRfGetGain(void) { return HAL_RF_GAIN_HIGH; }
+void halRfSetGain(uint8 gain) { (void)gain; }
+int8 halRfGetRssi(void) { return -90; }
+uint8 halRfGetRssiOffset(void) { return 73; }
+
+uint8 halRfInit(void) { return SUCCESS; }
+void halRfReadRxBuf(uint8* pData, uint8 length) { (void)pData; (void)length; }
+void halRfReceiveOff(void) {}
+void halRfReceiveOn(void) {}
+uint8 halRfRxFifoOverflow(void) { return FALSE; }
+uint8 halRfRxFrameReady(void) { return FALSE; }
+void halRfSetChannel(uint8 channel) { (void)channel; }
+void halRfSetExtAddr(const uint8* pExtAddr) { (void)pExtAddr; }
+void halRfSetPanId(uint16 panId) { (void)panId; }
+void halRfSetShortAddr(uint16 shortAddr) { (void)shortAddr; }
+void halRfSrcMatchClearShort(uint8 index) { (void)index; }
+void halRfSrcMatchSetPending(uint8 index, uint8 pending) { (void)index; (void)pending; }
+void halRfSrcMatchSetShort(uint8 index, uint16 panId, uint16 addr)
+{
+  (void)index; (void)panId; (void)addr;
+}
+void halRfWaitTransceiverReady(void) {}
+
+void halTimer32kMcuSleepTicks(uint16 ticks) { (void)ticks; }
+uint32 halTimer32kReadTimerValue(void) { return (uint32)(nowUs * MODEL_SLEEP_TICKS_PER_US); }
+
+
+/******************************************************************************
+* GLOBAL FUNCTIONS
+*/
+/**************************************************************************//**
+* @brief    Prints packets per second for each payload length, main loop
+*           period and queue depth
+*
+* @return   0 on success, 1 if a benchmark run failed
+******************************************************************************/
+int main(void)
+{
+  static basicRfCfg_t cfg;
+  basicRfTxBench_t result;
+  uint8 l, p, d;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.myAddr = MY_ADDR;
+  cfg.panId = PAN_ID;
+  cfg.channel = RF_CHANNEL;
+
+  srand(1);
+  intLocked = TRUE;
+  if (basicRfInit(&cfg) != SUCCESS) {
+    printf("basicRfInit() failed\n");
+    return 1;
+  }
+  intLocked = FALSE;
+
+  printf("payload  app period  ");
+  for (d = 0; d < sizeof(benchDepths); d++) {
+    printf("  depth %u", benchDepths[d]);
+  }
+  printf("   (packets/s)\n");
+
+  for (l = 0; l < sizeof(benchLengths); l++) {
+    for (p = 0; p < sizeof(benchPeriods) / sizeof(benchPeriods[0]); p++) {
+      printf("%3u B    %5u us   ", benchLengths[l],
+             benchPeriods[p] * HAL_RF_SYMBOL_US);
+      for (d = 0; d < sizeof(benchDepths); d++) {
+        if (basicRfTxBenchmark(benchDepths[d], benchLengths[l],
+                               benchPeriods[p], &result) != SUCCESS ||
+            result.failed != 0) {
+          printf("\nbasicRfTxBenchmark() failed\n");
+          return 1;
+        }
+        printf("  %7u", result.packetsPerSec);
+      }
+      printf("\n");
+    }
+  }
+
+  return 0;
+}